@@ -0,0 +1,553 @@
+#include <rlwe.h>
+#include <module_rlwe.h>
+#include <ntt.h>
+#include <params.h>
+#include <polynomial.h>
+#include <small_polynomial.h>
+#include <restore.h>
+#include <polynomial_codec.h>
+#include <text_codec.h>
+#include <token.h>
+#include <mint_api.h>
+#include <verify_pipeline.h>
+#include <logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark driver for the blind signature protocol.
+//
+// Every benchmark is run for a number of repetitions; each repetition executes
+// the operation enough times to last at least --min-time milliseconds and
+// records the mean time per operation. The raw per-repetition samples are
+// written as JSON so that tools/bench_compare.py can compute noise-aware
+// statistics (median and MAD) against a stored baseline.
+
+namespace {
+
+struct Options {
+    size_t repetitions = 5;
+    double min_time_ms = 50.0;
+    std::string filter;
+    std::string out_path;
+    std::vector<std::pair<size_t, uint64_t>> params = {{8, 7681}, {32, 7681}, {256, 7681}};
+    size_t sweep_log_min = 0;   // NTT size sweep 2^min..2^max, disabled when 0
+    size_t sweep_log_max = 0;
+    std::vector<size_t> module_ranks;   // Module-LWE ranks to benchmark at n=256
+};
+
+// Modulus for the NTT size sweep: 15 * 2^27 + 1 is prime and supports
+// negacyclic transforms up to n = 2^26
+constexpr uint64_t SWEEP_MODULUS = 2013265921;
+
+struct BenchmarkCase {
+    std::string name;
+    std::function<void()> op;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations;
+    std::vector<double> samples_ns;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [options]\n"
+              << "  --repetitions N    Number of timed repetitions per benchmark (default 5)\n"
+              << "  --min-time MS      Minimum duration of one repetition in ms (default 50)\n"
+              << "  --filter SUBSTR    Only run benchmarks whose name contains SUBSTR\n"
+              << "  --params N:Q[,..]  Ring parameters to benchmark (default 8:7681,32:7681,256:7681)\n"
+              << "  --ranks K[,..]     Also time the module scheme at n=256, q=12289 for these ranks\n"
+              << "  --ntt-sweep A:B    Also time the NTT for n = 2^A..2^B\n"
+              << "  --out FILE         Write JSON results to FILE instead of stdout\n";
+}
+
+std::vector<std::pair<size_t, uint64_t>> parseParams(const std::string& spec) {
+    std::vector<std::pair<size_t, uint64_t>> params;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Parameter set must be of the form N:Q, got '" + item + "'");
+        }
+        params.emplace_back(std::stoull(item.substr(0, colon)), std::stoull(item.substr(colon + 1)));
+    }
+    return params;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--repetitions") {
+            opts.repetitions = std::stoul(next());
+        } else if (arg == "--min-time") {
+            opts.min_time_ms = std::stod(next());
+        } else if (arg == "--filter") {
+            opts.filter = next();
+        } else if (arg == "--params") {
+            opts.params = parseParams(next());
+        } else if (arg == "--ntt-sweep") {
+            std::string spec = next();
+            size_t colon = spec.find(':');
+            if (colon == std::string::npos) {
+                throw std::invalid_argument("--ntt-sweep must be of the form A:B, got '" + spec + "'");
+            }
+            opts.sweep_log_min = std::stoul(spec.substr(0, colon));
+            opts.sweep_log_max = std::stoul(spec.substr(colon + 1));
+            if (opts.sweep_log_min < 1 || opts.sweep_log_min > opts.sweep_log_max || opts.sweep_log_max > 26) {
+                throw std::invalid_argument("--ntt-sweep needs 1 <= A <= B <= 26");
+            }
+        } else if (arg == "--ranks") {
+            std::stringstream ss(next());
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                opts.module_ranks.push_back(std::stoul(item));
+            }
+        } else if (arg == "--out") {
+            opts.out_path = next();
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (opts.repetitions == 0) {
+        throw std::invalid_argument("--repetitions must be at least 1");
+    }
+    return opts;
+}
+
+// Holds the protocol state shared by all benchmarks of one parameter set
+struct ProtocolFixture {
+    std::unique_ptr<RLWESignature> rlwe;
+    std::vector<uint8_t> secret = {0x12, 0x34, 0x56, 0x78};
+    Polynomial blindedMessage;
+    Polynomial blindingFactor;
+    Polynomial blindSignature;
+    Polynomial signature;
+
+    ProtocolFixture(size_t n, uint64_t q)
+        : rlwe(std::make_unique<RLWESignature>(n, q)),
+          blindedMessage(n, q), blindingFactor(n, q),
+          blindSignature(n, q), signature(n, q) {
+        rlwe->generateKeys();
+        std::tie(blindedMessage, blindingFactor) = rlwe->computeBlindedMessage(secret);
+        blindSignature = rlwe->blindSign(blindedMessage);
+        signature = rlwe->computeSignature(blindSignature, blindingFactor, rlwe->getPublicKey().second);
+    }
+};
+
+std::vector<BenchmarkCase> makeCases(const std::vector<std::shared_ptr<ProtocolFixture>>& fixtures) {
+    std::vector<BenchmarkCase> cases;
+    for (const auto& f : fixtures) {
+        const size_t n = f->blindedMessage.degree();
+        const std::string suffix = "/n=" + std::to_string(n) + ",q=" +
+                                   std::to_string(f->blindedMessage.getModulus());
+
+        cases.push_back({"poly_mul" + suffix, [f]() {
+            volatile uint64_t sink = (f->blindedMessage * f->blindingFactor)[0];
+            (void)sink;
+        }});
+        // The same product with the Gaussian operand in 8-bit storage
+        auto small = std::make_shared<SmallPolynomial>(SmallPolynomial::fromPolynomial(f->blindingFactor));
+        cases.push_back({"small_mul" + suffix, [f, small]() {
+            volatile uint64_t sink = (*small * f->blindedMessage)[0];
+            (void)sink;
+        }});
+        cases.push_back({"mul_monomial" + suffix, [f, n]() {
+            volatile uint64_t sink = f->blindedMessage.mulMonomial(static_cast<int64_t>(n) / 3)[0];
+            (void)sink;
+        }});
+        // Ternary operand with log2(n) nonzero terms, the largest weight
+        // operator* still multiplies by rotation
+        auto ternary = std::make_shared<Polynomial>(n, f->blindedMessage.getModulus());
+        for (size_t i = 0, step = 1; i < n; i += step, step++) {
+            if ((size_t(1) << step) > 2 * n) break;
+            (*ternary)[i] = step % 2 ? 1 : f->blindedMessage.getModulus() - 1;
+        }
+        cases.push_back({"sparse_mul" + suffix, [f, ternary]() {
+            volatile uint64_t sink = ternary->multiplySparse(f->blindedMessage)[0];
+            (void)sink;
+        }});
+        cases.push_back({"poly_signal" + suffix, [f]() {
+            volatile uint64_t sink = f->blindSignature.polySignal()[0];
+            (void)sink;
+        }});
+        cases.push_back({"hash_to_polynomial" + suffix, [f]() {
+            volatile uint64_t sink = f->rlwe->hashToPolynomial(f->secret)[0];
+            (void)sink;
+        }});
+        // Key generation runs on its own instance so the fixture keys stay
+        // consistent with the precomputed signature used by verify
+        auto keygen = std::make_shared<RLWESignature>(n, f->blindedMessage.getModulus());
+        cases.push_back({"keygen" + suffix, [keygen]() {
+            keygen->generateKeys();
+        }});
+        cases.push_back({"public_key" + suffix, [f]() {
+            const auto key = f->rlwe->getPublicKey();
+            volatile uint64_t sink = key.second[0];
+            (void)sink;
+        }});
+        cases.push_back({"blind" + suffix, [f]() {
+            volatile uint64_t sink = f->rlwe->computeBlindedMessage(f->secret).first[0];
+            (void)sink;
+        }});
+        cases.push_back({"blind_sign" + suffix, [f]() {
+            volatile uint64_t sink = f->rlwe->blindSign(f->blindedMessage)[0];
+            (void)sink;
+        }});
+        cases.push_back({"unblind" + suffix, [f]() {
+            volatile uint64_t sink = f->rlwe->computeSignature(
+                f->blindSignature, f->blindingFactor, f->rlwe->getPublicKey().second)[0];
+            (void)sink;
+        }});
+        cases.push_back({"verify" + suffix, [f]() {
+            volatile bool sink = f->rlwe->verify(f->secret, f->signature);
+            (void)sink;
+        }});
+        // 64 proofs verified in place, to compare against 64 verify calls
+        auto audit = std::make_shared<PolynomialBatch>(64, n, f->signature.getModulus());
+        for (size_t k = 0; k < 64; k++) {
+            std::copy(f->signature.getCoeffs().begin(), f->signature.getCoeffs().end(), audit->row(k));
+        }
+        cases.push_back({"verify_batch64" + suffix, [f, audit]() {
+            const uint8_t* secrets[64];
+            size_t sizes[64];
+            bool results[64];
+            std::fill(secrets, secrets + 64, f->secret.data());
+            std::fill(sizes, sizes + 64, f->secret.size());
+            f->rlwe->verifyBatch(secrets, sizes, *audit, results);
+            volatile bool sink = results[63];
+            (void)sink;
+        }});
+        // Eight messages per call, to compare against eight blind_sign calls
+        auto batch = std::make_shared<std::vector<Polynomial>>(8, f->blindedMessage);
+        cases.push_back({"blind_sign_batch8" + suffix, [f, batch]() {
+            volatile uint64_t sink = f->rlwe->blindSignBatch(*batch)[0][0];
+            (void)sink;
+        }});
+        // Client side of a 32-output payment, to compare against 32 blind
+        // and unblind calls
+        auto outputs = std::make_shared<std::vector<std::vector<uint8_t>>>(32, f->secret);
+        auto factors = std::make_shared<std::vector<SmallPolynomial>>(
+            32, SmallPolynomial::fromPolynomial(f->blindingFactor));
+        auto blind_signatures = std::make_shared<std::vector<Polynomial>>(32, f->blindSignature);
+        cases.push_back({"blind_batch32" + suffix, [f, outputs, factors]() {
+            volatile uint64_t sink = f->rlwe->computeBlindedMessageBatch(*outputs, *factors).row(0)[0];
+            (void)sink;
+        }});
+        cases.push_back({"unblind_batch32" + suffix, [f, blind_signatures, factors]() {
+            volatile uint64_t sink = f->rlwe->computeSignatureBatch(*blind_signatures, *factors).row(0)[0];
+            (void)sink;
+        }});
+        // Golomb-Rice coding of one blinding factor, as kept in wallet stores
+        auto factor_bytes = std::make_shared<std::vector<uint8_t>>(encodeSmallPolynomial(factors->front()));
+        cases.push_back({"small_encode" + suffix, [factors]() {
+            volatile size_t sink = encodeSmallPolynomial(factors->front()).size();
+            (void)sink;
+        }});
+        cases.push_back({"small_decode" + suffix, [factor_bytes]() {
+            volatile int8_t sink = decodeSmallPolynomial(factor_bytes->data(), factor_bytes->size())[0];
+            (void)sink;
+        }});
+        // Text form of one public-key polynomial, as shipped in tokens
+        auto key_text = std::make_shared<std::string>();
+        appendPolynomialBase64url(f->rlwe->getPublicKey().second, *key_text);
+        cases.push_back({"base64_encode" + suffix, [f]() {
+            std::string text;
+            appendPolynomialBase64url(f->rlwe->getPublicKey().second, text);
+            volatile size_t sink = text.size();
+            (void)sink;
+        }});
+        cases.push_back({"base64_decode" + suffix, [f, key_text]() {
+            Polynomial p(f->rlwe->getPublicKey().second.degree(), f->rlwe->getPublicKey().second.getModulus());
+            decodePolynomialBase64url(key_text->data(), key_text->size(), p);
+            volatile uint64_t sink = p[0];
+            (void)sink;
+        }});
+        // A 300-proof token written into a caller buffer and read back as views
+        const Polynomial& sig = f->blindSignature;
+        auto secret = std::make_shared<std::vector<uint8_t>>(32, 7);
+        auto proofs = std::make_shared<std::vector<TokenProof>>(
+            300, TokenProof{f->rlwe->keysetId(), 1 << 20, secret->data(), secret->size(), &sig});
+        auto token = std::make_shared<std::vector<uint8_t>>(TokenWriter::tokenSize("https://mint.test", "sat", *proofs));
+        auto writeToken = [f, token, proofs, secret]() {
+            return TokenWriter::write(token->data(), token->size(), "https://mint.test", "sat", *proofs);
+        };
+        writeToken();
+        cases.push_back({"token_write300" + suffix, [writeToken]() {
+            volatile size_t sink = writeToken();
+            (void)sink;
+        }});
+        cases.push_back({"token_read300" + suffix, [token]() {
+            TokenReader reader(token->data(), token->size());
+            ProofView proof;
+            uint64_t total = 0;
+            while (reader.next(proof)) {
+                total += proof.amount;
+            }
+            volatile uint64_t sink = total;
+            (void)sink;
+        }});
+        // The same token through the staged verifier, one worker per stage,
+        // to compare against verify_batch64 on 300 proofs
+        auto pipeline = std::make_shared<VerifyPipeline>(
+            [f](const KeysetId&) -> const RLWESignature* { return f->rlwe.get(); }, VerifyPipeline::SpentCheck());
+        cases.push_back({"verify_pipeline300" + suffix, [token, pipeline]() {
+            const uint8_t* data = token->data();
+            const size_t size = token->size();
+            uint64_t valid = 0;
+            pipeline->run(&data, &size, 1, [&valid](const VerifiedProof* proofs, size_t count) {
+                for (size_t k = 0; k < count; k++) {
+                    valid += proofs[k].status == ProofStatus::Valid;
+                }
+            });
+            volatile uint64_t sink = valid;
+            (void)sink;
+        }});
+        // A swap of 8 proofs into 32 outputs as the JSON body the mint
+        // reads, and the 32 signatures it writes back
+        auto swap = std::make_shared<MintRequest>(sig.degree(), sig.getModulus());
+        for (size_t k = 0; k < 40; k++) {
+            EntryBatch& entries = k < 8 ? swap->inputs : swap->outputs;
+            const size_t i = entries.add(uint64_t(1) << (k % 32), f->rlwe->keysetId(),
+                                         k < 8 ? std::string(64, 'a') : std::string());
+            std::copy(sig.getCoeffs().begin(), sig.getCoeffs().end(), entries.polynomials.row(i));
+        }
+        auto swap_json = std::make_shared<std::string>();
+        writeMintRequest(*swap, *swap_json);
+        cases.push_back({"json_swap_read" + suffix, [swap, swap_json]() {
+            readMintRequest(*swap_json, *swap);
+            volatile uint64_t sink = swap->outputs.polynomials.row(31)[0];
+            (void)sink;
+        }});
+        auto response = std::make_shared<std::string>();
+        cases.push_back({"json_signatures_write" + suffix, [swap, response]() {
+            response->clear();
+            writeSignatures(swap->outputs, *response);
+            volatile size_t sink = response->size();
+            (void)sink;
+        }});
+        // One restore window of 256 counters against a mint that signed none
+        auto restorer = std::make_shared<WalletRestorer>(
+            SeedDerivation(std::vector<uint8_t>(32, 1), f->rlwe->keysetId()),
+            f->rlwe->getPublicKey().first, f->rlwe->getPublicKey().second, 256, 256);
+        cases.push_back({"restore_scan256" + suffix, [restorer]() {
+            SignatureLookup none = [](const std::vector<Polynomial>& blinded) {
+                return std::vector<std::optional<Polynomial>>(blinded.size());
+            };
+            volatile uint64_t sink = restorer->restore(none).scanned;
+            (void)sink;
+        }});
+    }
+    return cases;
+}
+
+// Module scheme at a fixed n=256 ring, so the cost of raising the rank
+// can be compared against raising n in the ring scheme
+std::vector<BenchmarkCase> makeModuleCases(const Options& opts) {
+    std::vector<BenchmarkCase> cases;
+    for (size_t k : opts.module_ranks) {
+        auto mlwe = std::make_shared<ModuleRLWESignature>(k, ParameterPreset::RLWE_256_Q12289);
+        mlwe->generateKeys();
+        auto secret = std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>{0x12, 0x34, 0x56, 0x78});
+        auto blinded = std::make_shared<std::pair<ModuleRLWESignature::PolyVector, ModuleRLWESignature::PolyVector>>(
+            mlwe->computeBlindedMessage(*secret));
+        auto signature = std::make_shared<Polynomial>(mlwe->computeSignature(
+            mlwe->blindSign(blinded->first), blinded->second, mlwe->getPublicKey().second));
+        const std::string suffix = "/k=" + std::to_string(k) + ",n=256,q=12289";
+
+        cases.push_back({"module_blind" + suffix, [mlwe, secret]() {
+            volatile uint64_t sink = mlwe->computeBlindedMessage(*secret).first[0][0];
+            (void)sink;
+        }});
+        cases.push_back({"module_blind_sign" + suffix, [mlwe, blinded]() {
+            volatile uint64_t sink = mlwe->blindSign(blinded->first)[0];
+            (void)sink;
+        }});
+        cases.push_back({"module_verify" + suffix, [mlwe, secret, signature]() {
+            volatile bool sink = mlwe->verify(*secret, *signature);
+            (void)sink;
+        }});
+    }
+    return cases;
+}
+
+// Transform benchmarks across ring sizes, to locate the cache cliffs of the host
+std::vector<BenchmarkCase> makeSweepCases(const Options& opts) {
+    std::vector<BenchmarkCase> cases;
+    if (opts.sweep_log_min == 0) {
+        return cases;
+    }
+    std::mt19937_64 rng(1);
+    for (size_t log_n = opts.sweep_log_min; log_n <= opts.sweep_log_max; log_n++) {
+        const ParameterSet& params = ParameterSet::get(size_t(1) << log_n, SWEEP_MODULUS);
+        auto data = std::make_shared<std::vector<uint64_t>>(params.n);
+        for (auto& c : *data) c = rng() % params.q;
+        const std::string suffix = "/n=" + std::to_string(params.n) + ",q=" + std::to_string(params.q);
+
+        // Forward then inverse keeps the data in range without copying
+        cases.push_back({"ntt" + suffix, [data, &params]() {
+            NTT::forward(data->data(), params);
+            NTT::inverse(data->data(), params);
+        }});
+    }
+    return cases;
+}
+
+// Prints the sweep as nanoseconds per butterfly (n log n butterflies per
+// forward + inverse pair)
+void printSweepTable(const std::vector<BenchmarkResult>& results) {
+    bool header = false;
+    for (const auto& r : results) {
+        if (r.name.rfind("ntt/", 0) != 0) continue;
+        const size_t n_pos = r.name.find("n=") + 2;
+        const size_t n = std::stoull(r.name.substr(n_pos, r.name.find(',', n_pos) - n_pos));
+        size_t log_n = 0;
+        while ((size_t(1) << log_n) < n) log_n++;
+        std::vector<double> sorted = r.samples_ns;
+        std::sort(sorted.begin(), sorted.end());
+        const double median = sorted[sorted.size() / 2];
+        if (!header) {
+            std::cerr << "\n" << std::left << std::setw(40) << "transform" << std::right
+                      << std::setw(14) << "ns/op" << std::setw(16) << "ns/butterfly" << "\n";
+            header = true;
+        }
+        std::cerr << std::left << std::setw(40) << r.name << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(14) << median << std::setprecision(3)
+                  << std::setw(16) << median / static_cast<double>(n * log_n) << "\n";
+    }
+}
+
+double elapsedNs(const std::function<void()>& op, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        op();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+BenchmarkResult runCase(const BenchmarkCase& bc, const Options& opts) {
+    // Warm up and calibrate the iteration count so that one repetition
+    // lasts at least min_time_ms
+    const double min_time_ns = opts.min_time_ms * 1e6;
+    uint64_t iterations = 1;
+    double t = elapsedNs(bc.op, iterations);
+    while (t < min_time_ns && iterations < (uint64_t(1) << 40)) {
+        double scale = t > 0 ? (min_time_ns * 1.2) / t : 10.0;
+        iterations = std::max<uint64_t>(iterations + 1,
+                                        static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+        t = elapsedNs(bc.op, iterations);
+    }
+
+    BenchmarkResult result{bc.name, iterations, {}};
+    for (size_t rep = 0; rep < opts.repetitions; rep++) {
+        result.samples_ns.push_back(elapsedNs(bc.op, iterations) / static_cast<double>(iterations));
+    }
+    return result;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void writeJson(std::ostream& os, const Options& opts, const std::vector<BenchmarkResult>& results) {
+    os << "{\n  \"context\": {\n";
+    os << "    \"repetitions\": " << opts.repetitions << ",\n";
+    os << "    \"min_time_ms\": " << opts.min_time_ms << ",\n";
+#ifdef NDEBUG
+    os << "    \"build_type\": \"release\"\n";
+#else
+    os << "    \"build_type\": \"debug\"\n";
+#endif
+    os << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        os << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"unit\": \"ns\", "
+           << "\"iterations\": " << r.iterations << ", \"samples\": [";
+        for (size_t j = 0; j < r.samples_ns.size(); j++) {
+            if (j > 0) os << ", ";
+            os << std::fixed << std::setprecision(3) << r.samples_ns[j];
+        }
+        os << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        opts = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    Logger::enable_logging = false;
+
+    std::vector<std::shared_ptr<ProtocolFixture>> fixtures;
+    for (const auto& [n, q] : opts.params) {
+        fixtures.push_back(std::make_shared<ProtocolFixture>(n, q));
+    }
+
+    std::vector<BenchmarkCase> cases = makeCases(fixtures);
+    for (auto& bc : makeModuleCases(opts)) {
+        cases.push_back(std::move(bc));
+    }
+    for (auto& bc : makeSweepCases(opts)) {
+        cases.push_back(std::move(bc));
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& bc : cases) {
+        if (!opts.filter.empty() && bc.name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+        std::cerr << "Running " << bc.name << "..." << std::endl;
+        results.push_back(runCase(bc, opts));
+    }
+    printSweepTable(results);
+
+    if (opts.out_path.empty()) {
+        writeJson(std::cout, opts, results);
+    } else {
+        std::ofstream out(opts.out_path);
+        if (!out) {
+            std::cerr << "Error: cannot open " << opts.out_path << " for writing\n";
+            return 1;
+        }
+        writeJson(out, opts, results);
+    }
+    return 0;
+}
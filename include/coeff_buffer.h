@@ -0,0 +1,190 @@
+#ifndef COEFF_BUFFER_H
+#define COEFF_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Read-only view of a contiguous run of coefficients. It stays valid only
+// as long as the storage it was taken from.
+class CoeffView {
+public:
+    using value_type = uint64_t;
+    using iterator = const uint64_t*;
+    using const_iterator = const uint64_t*;
+
+    CoeffView(const uint64_t* data, size_t size) : ptr(data), count(size) {}
+
+    const uint64_t* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const uint64_t& operator[](size_t idx) const { return ptr[idx]; }
+    const uint64_t* begin() const { return ptr; }
+    const uint64_t* end() const { return ptr + count; }
+
+    // Copy out, for interfaces that still take vectors
+    operator std::vector<uint64_t>() const {
+        return std::vector<uint64_t>(begin(), end());
+    }
+
+    friend bool operator==(const CoeffView& a, const CoeffView& b) {
+        return a.count == b.count && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator==(const CoeffView& a, const std::vector<uint64_t>& b) {
+        return a == CoeffView(b.data(), b.size());
+    }
+    friend bool operator==(const std::vector<uint64_t>& a, const CoeffView& b) {
+        return b == a;
+    }
+    friend bool operator!=(const CoeffView& a, const CoeffView& b) { return !(a == b); }
+    friend bool operator!=(const CoeffView& a, const std::vector<uint64_t>& b) { return !(a == b); }
+    friend bool operator!=(const std::vector<uint64_t>& a, const CoeffView& b) { return !(a == b); }
+
+private:
+    const uint64_t* ptr;
+    size_t count;
+};
+
+// Fixed-size coefficient storage with a small-buffer optimization: up to
+// INLINE_CAPACITY coefficients are stored inside the object itself, so
+// polynomials over tiny rings are created, copied and destroyed without
+// touching the heap.
+//
+// Larger rings live in one reference-counted heap block that copies share,
+// so copying is O(1). The block is copied on the first mutable access
+// (non-const data() or operator[]) while it is shared. As with any
+// implicitly shared container, a pointer or reference obtained through a
+// mutable accessor must not be held across a copy of the buffer.
+class CoeffBuffer {
+public:
+    static constexpr size_t INLINE_CAPACITY = 64;
+
+    // n zero coefficients
+    explicit CoeffBuffer(size_t n = 0) : count(n) {
+        if (isInline()) {
+            std::fill(local, local + n, uint64_t(0));
+        } else {
+            block = SharedBlock::create(n);
+            std::fill(block->coeffs(), block->coeffs() + n, uint64_t(0));
+        }
+    }
+
+    // Copy of n coefficients from src
+    CoeffBuffer(const uint64_t* src, size_t n) : count(n) {
+        if (!isInline()) {
+            block = SharedBlock::create(n);
+        }
+        std::memcpy(rawData(), src, n * sizeof(uint64_t));
+    }
+
+    CoeffBuffer(const CoeffBuffer& other) : count(other.count) {
+        if (isInline()) {
+            std::memcpy(local, other.local, count * sizeof(uint64_t));
+        } else {
+            block = other.block;
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CoeffBuffer(CoeffBuffer&& other) noexcept : count(other.count) {
+        if (isInline()) {
+            std::memcpy(local, other.local, count * sizeof(uint64_t));
+        } else {
+            block = other.block;
+            other.count = 0;
+        }
+    }
+
+    CoeffBuffer& operator=(const CoeffBuffer& other) {
+        if (this != &other) {
+            CoeffBuffer copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    CoeffBuffer& operator=(CoeffBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            count = other.count;
+            if (isInline()) {
+                std::memcpy(local, other.local, count * sizeof(uint64_t));
+            } else {
+                block = other.block;
+                other.count = 0;
+            }
+        }
+        return *this;
+    }
+
+    ~CoeffBuffer() { release(); }
+
+    // Mutable access detaches a shared block first
+    uint64_t* data() {
+        detach();
+        return rawData();
+    }
+    const uint64_t* data() const { return isInline() ? local : block->coeffs(); }
+    size_t size() const { return count; }
+    bool isInline() const { return count <= INLINE_CAPACITY; }
+
+    // Whether another buffer currently shares this one's heap block
+    bool isShared() const {
+        return !isInline() && block->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    uint64_t& operator[](size_t idx) { return data()[idx]; }
+    const uint64_t& operator[](size_t idx) const { return data()[idx]; }
+    uint64_t* begin() { return data(); }
+    uint64_t* end() { return data() + count; }
+    const uint64_t* begin() const { return data(); }
+    const uint64_t* end() const { return data() + count; }
+
+    CoeffView view() const { return CoeffView(data(), count); }
+
+private:
+    // Reference count followed by the coefficients in one allocation
+    struct SharedBlock {
+        std::atomic<size_t> refs;
+        size_t reserved;  // Keeps the coefficients 16-byte aligned
+
+        uint64_t* coeffs() { return reinterpret_cast<uint64_t*>(this + 1); }
+
+        static SharedBlock* create(size_t n) {
+            void* memory = ::operator new(sizeof(SharedBlock) + n * sizeof(uint64_t));
+            SharedBlock* b = new (memory) SharedBlock;
+            b->refs.store(1, std::memory_order_relaxed);
+            b->reserved = 0;
+            return b;
+        }
+    };
+
+    size_t count;
+    union {
+        uint64_t local[INLINE_CAPACITY];
+        SharedBlock* block;
+    };
+
+    uint64_t* rawData() { return isInline() ? local : block->coeffs(); }
+
+    void detach() {
+        if (isShared()) {
+            SharedBlock* copy = SharedBlock::create(count);
+            std::memcpy(copy->coeffs(), block->coeffs(), count * sizeof(uint64_t));
+            release();
+            block = copy;
+        }
+    }
+
+    void release() {
+        if (!isInline() && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ::operator delete(block);
+        }
+    }
+};
+
+#endif // COEFF_BUFFER_H
@@ -0,0 +1,52 @@
+#ifndef DERIVATION_H
+#define DERIVATION_H
+
+#include <small_polynomial.h>
+#include <params.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Short identifier of a mint public key, the first eight bytes of a
+// SHA-256 over a canonical little-endian encoding of (n, q, a, b)
+using KeysetId = std::array<uint8_t, 8>;
+
+std::string keysetIdToHex(const KeysetId& id);
+
+// Deterministic wallet state. Every secret and blinding factor is derived
+// from a wallet seed, the keyset it is used with and a counter through
+// SHAKE256, so a wallet only needs to remember its seed and the next
+// counter per keyset, and can regenerate r for unblinding (or rebuild all
+// of its proofs from the seed) at any time.
+//
+//   secret(i) = SHAKE256(0x01 || keyset || LE64(i) || seed)[0..32)
+//   r(i)      = Gaussian over SHAKE256(0x02 || keyset || LE64(i) || seed),
+//               one little-endian 64-bit word per coefficient
+//
+// Blinding factors use the parameter set's table-driven sampler, so they
+// follow the same distribution as RLWESignature's default sampling.
+class SeedDerivation {
+public:
+    static constexpr size_t MIN_SEED_SIZE = 16;
+    static constexpr size_t SECRET_SIZE = 32;
+
+    // Throws std::invalid_argument for seeds shorter than MIN_SEED_SIZE
+    SeedDerivation(const std::vector<uint8_t>& seed, const KeysetId& keyset);
+
+    std::vector<uint8_t> secret(uint64_t counter) const;
+    SmallPolynomial blindingFactor(uint64_t counter, const ParameterSet& params) const;
+
+    const KeysetId& keyset() const {
+        return keyset_id;
+    }
+
+private:
+    std::vector<uint8_t> seed;
+    KeysetId keyset_id;
+
+    // Domain byte, keyset and counter followed by the seed
+    std::vector<uint8_t> xofInput(uint8_t domain, uint64_t counter) const;
+};
+
+#endif // DERIVATION_H
@@ -0,0 +1,95 @@
+#ifndef KEYSET_H
+#define KEYSET_H
+
+#include <derivation.h>
+#include <polynomial.h>
+#include <polynomial_batch.h>
+#include <small_polynomial.h>
+#include <params.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Identifier of the public key (a, b); see KeysetId
+KeysetId computeKeysetId(const Polynomial& a, const Polynomial& b);
+
+// A mint public key (a, b) prepared for client-side batch operations.
+// NTT(a) and NTT(b) are computed once at construction, so blinding and
+// unblinding a whole payment costs one forward transform per blinding
+// factor, batched eight at a time, and one inverse per output.
+class PreparedKeyset {
+public:
+    // Throws std::invalid_argument if a and b are not in the same ring
+    PreparedKeyset(const Polynomial& a, const Polynomial& b);
+
+    const Polynomial& getA() const {
+        return a;
+    }
+
+    const Polynomial& getB() const {
+        return b;
+    }
+
+    const KeysetId& id() const {
+        return keyset_id;
+    }
+
+    const ParameterSet& getParams() const {
+        return *params;
+    }
+
+    // Evaluations of a and b, or null if the ring does not support the NTT
+    const uint64_t* aHat() const {
+        return a_hat.empty() ? nullptr : a_hat.data();
+    }
+
+    const uint64_t* bHat() const {
+        return b_hat.empty() ? nullptr : b_hat.data();
+    }
+
+    // Row k is H(secrets[k]) + a*factors[k], as computeBlindedMessage
+    // produces it. Throws std::invalid_argument on a count or ring mismatch.
+    PolynomialBatch blind(const std::vector<std::vector<uint8_t>>& secrets,
+                          const std::vector<SmallPolynomial>& factors) const;
+
+    // Row k is blindSignatures[k] - factors[k]*b, as computeSignature
+    // produces it. Throws std::invalid_argument on a count or ring mismatch.
+    PolynomialBatch unblind(const std::vector<Polynomial>& blindSignatures,
+                            const std::vector<SmallPolynomial>& factors) const;
+
+private:
+    Polynomial a;
+    Polynomial b;
+    KeysetId keyset_id;
+    const ParameterSet* params;
+    std::vector<uint64_t> a_hat;
+    std::vector<uint64_t> b_hat;
+
+    void checkFactors(const std::vector<SmallPolynomial>& factors, size_t count) const;
+
+    // out[k] = factors[k] * (a or b), given that operand's evaluations
+    void multiplyFactors(PolynomialBatch& out, const std::vector<SmallPolynomial>& factors,
+                         const Polynomial& operand, const std::vector<uint64_t>& operand_hat) const;
+};
+
+// Prepared keysets of the mints a wallet talks to, by keyset ID. Safe to
+// share between threads.
+class KeysetCache {
+public:
+    // The keyset with this ID, or null if it has not been added
+    std::shared_ptr<const PreparedKeyset> find(const KeysetId& id) const;
+
+    // Prepares (a, b) unless a keyset with the same ID is already cached,
+    // and returns the cached entry
+    std::shared_ptr<const PreparedKeyset> add(const Polynomial& a, const Polynomial& b);
+
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex;
+    std::map<KeysetId, std::shared_ptr<const PreparedKeyset>> keysets;
+};
+
+#endif // KEYSET_H
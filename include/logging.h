@@ -17,8 +17,16 @@ public:
         }
     }
 
-    template<typename T>
-    static std::string vectorToString(const std::vector<T>& vec, const std::string& prefix = "") {
+    // Literal messages are not copied into a std::string unless printed
+    static void log(const char* message) {
+        if (enable_logging && out) {
+            *out << message << std::endl;
+        }
+    }
+
+    // Any container with size() and operator[]
+    template<typename Container>
+    static std::string vectorToString(const Container& vec, const std::string& prefix = "") {
         std::stringstream ss;
         ss << prefix << "[";
         for (size_t i = 0; i < vec.size(); ++i) {
@@ -0,0 +1,102 @@
+#ifndef MINT_API_H
+#define MINT_API_H
+
+#include <derivation.h>
+#include <polynomial_batch.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// JSON bodies of the mint's HTTP endpoints, in the shapes of the Cashu NUTs
+// with polynomials as base64url of their packed coefficients (see
+// appendPolynomialBase64url()):
+//
+//   swap     {"inputs": [proof, ...], "outputs": [output, ...]}
+//   mint     {"quote": "...", "outputs": [output, ...]}
+//   melt     {"quote": "...", "inputs": [proof, ...], "outputs": [output, ...]}
+//   response {"signatures": [signature, ...]}
+//
+//   proof     {"amount": 8, "id": "<keyset hex>", "secret": "...", "C": "<polynomial>"}
+//   output    {"amount": 8, "id": "<keyset hex>", "B_": "<polynomial>"}
+//   signature {"amount": 8, "id": "<keyset hex>", "C_": "<polynomial>"}
+//
+// There is no document tree: readers scan the text once and decode each
+// polynomial straight into a row of a batch, and writers append to a
+// caller string. Every polynomial of a body is in the ring its batch was
+// built for. Unknown keys are skipped, but keys are compared as written,
+// without resolving escapes.
+
+// The entries of one proof, output or signature array. Buffers are kept
+// by clear(), so once a batch has held the largest body it is used for,
+// reading into it again does not allocate.
+struct EntryBatch {
+    EntryBatch(size_t n, uint64_t q) : polynomials(0, n, q) {}
+
+    std::vector<uint64_t> amounts;
+    std::vector<KeysetId> keysets;
+    // Secrets of proofs back to back, entry k's ending at secret_ends[k];
+    // outputs and signatures have empty ones
+    std::string secrets;
+    std::vector<size_t> secret_ends;
+    // "C", "B_" or "C_" of entry k in row k
+    PolynomialBatch polynomials;
+
+    size_t size() const {
+        return amounts.size();
+    }
+
+    std::string_view secret(size_t k) const {
+        const size_t start = k == 0 ? 0 : secret_ends[k - 1];
+        return std::string_view(secrets).substr(start, secret_ends[k] - start);
+    }
+
+    // Appends an entry with a zero polynomial and returns its index
+    size_t add(uint64_t amount, const KeysetId& keyset, std::string_view secret = {}) {
+        amounts.push_back(amount);
+        keysets.push_back(keyset);
+        secrets.append(secret.data(), secret.size());
+        secret_ends.push_back(secrets.size());
+        polynomials.resize(amounts.size());
+        return amounts.size() - 1;
+    }
+
+    void clear() {
+        amounts.clear();
+        keysets.clear();
+        secrets.clear();
+        secret_ends.clear();
+        polynomials.resize(0);
+    }
+};
+
+// A swap, mint or melt request. Swaps have no quote, mints no inputs.
+struct MintRequest {
+    MintRequest(size_t n, uint64_t q) : inputs(n, q), outputs(n, q) {}
+
+    std::string quote;
+    EntryBatch inputs;   // Proofs being spent
+    EntryBatch outputs;  // Blinded messages to sign
+
+    void clear() {
+        quote.clear();
+        inputs.clear();
+        outputs.clear();
+    }
+};
+
+// Replaces the contents of request with the body in json. Throws
+// std::invalid_argument on malformed JSON, an entry lacking a field, or a
+// polynomial that is not in the request's ring.
+void readMintRequest(std::string_view json, MintRequest& request);
+
+// Appends the body of request to out; an empty quote or inputs array is
+// left out
+void writeMintRequest(const MintRequest& request, std::string& out);
+
+// The same for the {"signatures": [...]} response of swaps and mints
+void readSignatures(std::string_view json, EntryBatch& signatures);
+void writeSignatures(const EntryBatch& signatures, std::string& out);
+
+#endif // MINT_API_H
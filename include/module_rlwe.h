@@ -0,0 +1,70 @@
+#ifndef MODULE_RLWE_H
+#define MODULE_RLWE_H
+
+#include <polynomial.h>
+#include <params.h>
+#include <validator.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Module-LWE variant of RLWESignature. Keys are a k x k matrix A and
+// length-k vectors over one fixed ring R_q = Z_q[x]/(x^n + 1), so the
+// security level is raised by increasing the rank k while every product
+// stays an n-coefficient ring multiplication.
+//
+//   Keys:      A uniform, s and e Gaussian, b = A^T s + e
+//   Blind:     Y = H(secret) in R^k, r Gaussian, B = Y + A r
+//   Sign:      C' = <s, B> + e1
+//   Unblind:   C = C' - <r, b> = <s, Y> + e1 - <r, e>
+//   Verify:    polySignal(C) == polySignal(<s, Y>)
+//
+// With k = 1 this is the ring scheme, apart from the domain-separated hash.
+class ModuleRLWESignature {
+public:
+    using PolyVector = std::vector<Polynomial>;
+    using PolyMatrix = std::vector<PolyVector>;  // Row-major, k rows of k entries
+
+    ModuleRLWESignature(size_t k, size_t n, uint64_t q);
+    ModuleRLWESignature(size_t k, ParameterPreset preset);
+
+    void generateKeys();
+    Polynomial blindSign(const PolyVector& blindedMessage);
+    bool verify(const std::vector<uint8_t>& secret, const Polynomial& signature);
+
+    // Public key (A, b); the polynomials share storage with the key
+    std::pair<PolyMatrix, PolyVector> getPublicKey() const {
+        return std::make_pair(A, b);
+    }
+
+    // Hash a message to k polynomials; component i hashes i || message
+    PolyVector hashToPolynomials(const std::vector<uint8_t>& message) const;
+
+    // Returns the blinded message B and the blinding factor r
+    std::pair<PolyVector, PolyVector> computeBlindedMessage(const std::vector<uint8_t>& secret);
+    Polynomial computeSignature(const Polynomial& blindSignature, const PolyVector& blindingFactor,
+                                const PolyVector& publicKey) const;
+
+    // Prefilter applied to every blinded message component before signing
+    const PolynomialValidator& getValidator() const { return validator; }
+
+    size_t rank() const { return rank_k; }
+    size_t ringDimension() const { return params->n; }
+    uint64_t getModulus() const { return params->q; }
+
+private:
+    size_t rank_k;
+    const ParameterSet* params;
+    PolynomialValidator validator;
+
+    PolyMatrix A;   // Public matrix
+    PolyVector b;   // A^T s + e
+    PolyVector s;   // Secret vector
+
+    Polynomial sampleUniform() const;
+    Polynomial sampleGaussian() const;
+    PolyVector sampleGaussianVector() const;
+    void checkVector(const PolyVector& v) const;
+};
+
+#endif // MODULE_RLWE_H
@@ -0,0 +1,60 @@
+#ifndef NTT_H
+#define NTT_H
+
+#include <params.h>
+#include <cstdint>
+#include <vector>
+
+// Negacyclic number theoretic transform over Z_q[x]/(x^n + 1).
+//
+// forward() maps coefficients in natural order to evaluations in
+// bit-reversed order and inverse() maps them back, so no explicit
+// bit-reversal permutation is ever performed. All inputs and outputs
+// are fully reduced to [0, q).
+class NTT {
+public:
+    // Whether the transform can be used for the given parameters
+    static bool isSupported(const ParameterSet& params) {
+        return params.ntt_friendly;
+    }
+
+    // In-place forward transform of params.n coefficients
+    static void forward(uint64_t* a, const ParameterSet& params);
+
+    // In-place inverse transform of params.n evaluations
+    static void inverse(uint64_t* a, const ParameterSet& params);
+
+    // In-place transforms of `count` polynomials of params.n coefficients
+    // each. Polynomials are processed eight at a time in an interleaved
+    // layout, one per SIMD lane; results equal forward()/inverse() on each.
+    static void forwardBatch(uint64_t* const* polys, size_t count, const ParameterSet& params);
+    static void inverseBatch(uint64_t* const* polys, size_t count, const ParameterSet& params);
+
+    // out[i] = a[i] * b[i] mod q
+    static void pointwise(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                          const ParameterSet& params);
+
+    // out[j] = sum_i a[i][j] * b[i][j] mod q over `count` pairs of
+    // evaluation-domain operands. Products are accumulated unreduced and
+    // reduced only when the next one could overflow 64 bits.
+    static void pointwiseDot(uint64_t* out, const uint64_t* const* a, const uint64_t* const* b, size_t count,
+                             const ParameterSet& params);
+
+    // Inner product sum_i a[i] * b[i] of two equal-length vectors of
+    // coefficient vectors: all operands are transformed in one batch, the
+    // products are summed in the evaluation domain and a single inverse
+    // transform produces the result
+    static std::vector<uint64_t> dot(const std::vector<std::vector<uint64_t>>& a,
+                                     const std::vector<std::vector<uint64_t>>& b,
+                                     const ParameterSet& params);
+
+    // Negacyclic product of two coefficient vectors (need not be reduced)
+    static std::vector<uint64_t> multiply(const std::vector<uint64_t>& a,
+                                          const std::vector<uint64_t>& b,
+                                          const ParameterSet& params);
+
+    // Barrett reduction of x < 2^64 modulo params.q
+    static uint64_t reduce(uint64_t x, const ParameterSet& params);
+};
+
+#endif // NTT_H
@@ -0,0 +1,75 @@
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Named parameter presets. Their NTT, reduction and sampler tables are
+// generated at compile time, so using them involves no table computation.
+enum class ParameterPreset {
+    RLWE_256_Q7681,
+    RLWE_256_Q12289,
+    RLWE_512_Q12289,
+    RLWE_1024_Q12289,
+};
+
+// Ring parameters together with the precomputed tables used by the
+// arithmetic and sampling routines. Instances are either compile-time
+// presets or built once at runtime for other (n, q) pairs and cached; at
+// most MAX_RUNTIME_SETS of the latter exist per process.
+struct ParameterSet {
+    const char* name;
+    size_t n;                          // Ring dimension
+    uint64_t q;                        // Modulus
+    double sigma;                      // Standard deviation of the Gaussian sampler
+    bool is_preset;                    // Tables were generated at compile time
+
+    // Negacyclic NTT tables, only present when ntt_friendly is set
+    // (q prime, q < 2^31 and q = 1 mod 2n)
+    bool ntt_friendly;
+    uint64_t barrett;                  // floor(2^64 / q) for Barrett reduction
+    uint64_t n_inv;                    // n^-1 mod q
+    uint64_t n_inv_shoup;              // Shoup companion of n_inv
+    const uint64_t* psi_rev;           // Powers of psi in bit-reversed order
+    const uint64_t* psi_rev_shoup;     // Shoup companions of psi_rev
+    const uint64_t* psi_inv_rev;       // Powers of psi^-1 in bit-reversed order
+    const uint64_t* psi_inv_rev_shoup; // Shoup companions of psi_inv_rev
+
+    // Cumulative distribution table for |x| of the rounded Gaussian,
+    // scaled to 2^63
+    const uint64_t* cdt;
+    size_t cdt_size;
+
+    // Standard deviation used by all presets and runtime parameter sets
+    static constexpr double GAUSSIAN_STDDEV = 3.0;
+    static constexpr size_t CDT_SIZE = 32;
+
+    // Get the tables for a preset
+    static const ParameterSet& fromPreset(ParameterPreset preset);
+
+    // Get the tables for (n, q): the matching preset if there is one,
+    // otherwise tables built at runtime on first use and cached for the
+    // life of the process. Lookups of cached sets take no lock. Throws
+    // std::invalid_argument if n is 0 or above MAX_DEGREE or q is below 2,
+    // and std::runtime_error once MAX_RUNTIME_SETS rings are cached.
+    static const ParameterSet& get(size_t n, uint64_t q);
+
+    // NTT tables for (n, q) as used by polynomial multiplication, or null
+    // if the ring has no negacyclic NTT. Never throws, and only rings with
+    // an NTT are cached. Once MAX_RUNTIME_SETS rings are cached, the tables
+    // of a further ring are kept per thread and stay valid only until that
+    // thread asks for another uncached ring.
+    static const ParameterSet* nttTables(size_t n, uint64_t q);
+
+    static constexpr size_t MAX_DEGREE = size_t(1) << 24;
+    static constexpr size_t MAX_RUNTIME_SETS = 256;
+
+    // All compile-time presets
+    static const std::vector<const ParameterSet*>& presets();
+
+    // Number of parameter sets whose tables had to be built at runtime
+    static size_t runtimeBuildCount();
+};
+
+#endif // PARAMS_H
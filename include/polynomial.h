@@ -6,25 +6,33 @@
 #include <stdexcept>
 #include <string>
 #include <logging.h>
+#include <coeff_buffer.h>
 
 class Polynomial {
 public:
-    // Constructor for polynomial in Z[x]/(x^n + 1)
-    Polynomial(size_t n, uint64_t q) : ring_dim(n), modulus(q) {
-        coeffs.resize(ring_dim, 0);
-        Logger::log("Created zero polynomial of degree " + std::to_string(n-1) + 
-                   " with modulus " + std::to_string(q));
+    // Constructor for polynomial in Z[x]/(x^n + 1). Rings of up to
+    // CoeffBuffer::INLINE_CAPACITY coefficients are stored inline and never
+    // allocate.
+    Polynomial(size_t n, uint64_t q) : coeffs(n), ring_dim(n), modulus(q) {
+        if (Logger::enable_logging) {
+            Logger::log("Created zero polynomial of degree " + std::to_string(n-1) + 
+                       " with modulus " + std::to_string(q));
+        }
     }
 
     // Constructor from coefficient vector
     Polynomial(const std::vector<uint64_t>& coefficients, uint64_t q) 
-        : coeffs(coefficients), ring_dim(coefficients.size()), modulus(q) {
-        Logger::log("Created polynomial from coefficients: " + 
-                   Logger::vectorToString(coefficients) +
-                   " with modulus " + std::to_string(q));
+        : coeffs(coefficients.data(), coefficients.size()), ring_dim(coefficients.size()), modulus(q) {
+        if (Logger::enable_logging) {
+            Logger::log("Created polynomial from coefficients: " + 
+                       Logger::vectorToString(coefficients) +
+                       " with modulus " + std::to_string(q));
+        }
     }
 
-    // Get coefficient at index
+    // Get coefficient at index. Large rings share their coefficients between
+    // copies, and the mutable overload first takes a private copy if the
+    // storage is shared; the reference must not be held across a copy.
     uint64_t& operator[](size_t idx) {
         return coeffs[idx];
     }
@@ -58,25 +66,64 @@ public:
     // Scalar multiplication modulo q
     Polynomial operator*(uint64_t scalar) const;
 
-    // Get raw coefficients
-    const std::vector<uint64_t>& getCoeffs() const {
-        return coeffs;
+    // Multiplication by x^k for any integer k. Since x^n = -1 this is a
+    // rotation by k mod n with the wrapped coefficients negated.
+    Polynomial mulMonomial(int64_t k) const;
+
+    // Product with a dense operand in O(weight * n), where weight is the
+    // number of nonzero coefficients of *this. Coefficients above q/2 count
+    // as negative, so ternary operands need no multiplications at all.
+    Polynomial multiplySparse(const Polynomial& dense) const;
+
+    // Inner product sum_i u[i] * v[i] of two equal-length, non-empty
+    // vectors in one ring. Uses NTT::dot when the ring supports the NTT.
+    static Polynomial dot(const std::vector<Polynomial>& u, const std::vector<Polynomial>& v);
+
+    // Number of nonzero coefficients modulo q
+    size_t weight() const;
+
+    // out = x^k * in mod q for n coefficients; in and out must not overlap.
+    // The unwrapped part is copied, the wrapped part negated.
+    static void rotateNegacyclic(uint64_t* out, const uint64_t* in, size_t n, int64_t k, uint64_t q);
+
+    // Get raw coefficients; the view is valid while *this is alive
+    CoeffView getCoeffs() const {
+        return coeffs.view();
+    }
+
+    // Mutable access to all ring_dim coefficients, for kernels that fill
+    // a polynomial in place. Detaches shared storage like operator[].
+    uint64_t* data() {
+        return coeffs.data();
+    }
+
+    // Whether this polynomial's coefficients are currently shared with a
+    // copy. Copies of rings above CoeffBuffer::INLINE_CAPACITY share one
+    // reference-counted buffer until either side is modified.
+    bool sharesStorage() const {
+        return coeffs.isShared();
     }
 
     // Round coefficients to either 0 or q/2 (whichever is closer)
     Polynomial polySignal() const;
 
+    // Whether n coefficients mod q at x and at y round to the same signal,
+    // without building either one
+    static bool sameSignal(const uint64_t* x, const uint64_t* y, size_t n, uint64_t q);
+
     // Set polynomial coefficients
     void setCoefficients(const std::vector<uint64_t>& new_coeffs) {
         if (new_coeffs.size() != ring_dim) {
             throw std::invalid_argument("New coefficient vector size must match polynomial ring dimension");
         }
-        coeffs = new_coeffs;
         // Reduce each coefficient modulo q
-        for (auto& c : coeffs) {
-            c = mod(c, modulus);
+        uint64_t* out = coeffs.data();
+        for (size_t i = 0; i < ring_dim; i++) {
+            out[i] = mod(new_coeffs[i], modulus);
+        }
+        if (Logger::enable_logging) {
+            Logger::log("Updated polynomial coefficients to: " + Logger::vectorToString(coeffs));
         }
-        Logger::log("Updated polynomial coefficients to: " + Logger::vectorToString(coeffs));
     }
 
     // Convert to string for logging
@@ -112,10 +159,13 @@ public:
     }
 
 private:
-    std::vector<uint64_t> coeffs;  // Coefficients
+    CoeffBuffer coeffs;            // Coefficients
     size_t ring_dim;               // Polynomial ring dimension
     uint64_t modulus;              // Modulus q
 
+    // Quadratic-time negacyclic multiplication, used when the NTT is not available
+    Polynomial multiplySchoolbook(const Polynomial& other) const;
+
     // Helper function for modular reduction
     static uint64_t mod(int64_t x, uint64_t m) {
         int64_t r = x % static_cast<int64_t>(m);
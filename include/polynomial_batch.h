@@ -0,0 +1,85 @@
+#ifndef POLYNOMIAL_BATCH_H
+#define POLYNOMIAL_BATCH_H
+
+#include <polynomial.h>
+#include <coeff_buffer.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A fixed number of polynomials of one ring stored back to back in a single
+// buffer: row k holds the n coefficients of polynomial k. Batch operations
+// write their results here instead of allocating one Polynomial per output,
+// and the rows can be handed to NTT::forwardBatch directly.
+class PolynomialBatch {
+public:
+    // count zero polynomials in Z_q[x]/(x^n + 1)
+    PolynomialBatch(size_t count, size_t n, uint64_t q)
+        : rows(count), ring_dim(n), modulus(q), buffer(count * n, 0) {}
+
+    size_t size() const {
+        return rows;
+    }
+
+    size_t degree() const {
+        return ring_dim;
+    }
+
+    uint64_t getModulus() const {
+        return modulus;
+    }
+
+    // Changes the number of rows; kept rows keep their coefficients and
+    // added ones are zero. The buffer's capacity is not released, so a
+    // batch reused across requests stops allocating once it has held the
+    // largest.
+    void resize(size_t count) {
+        buffer.resize(count * ring_dim, 0);
+        rows = count;
+    }
+
+    uint64_t* row(size_t k) {
+        return buffer.data() + k * ring_dim;
+    }
+
+    const uint64_t* row(size_t k) const {
+        return buffer.data() + k * ring_dim;
+    }
+
+    CoeffView coeffs(size_t k) const {
+        return CoeffView(row(k), ring_dim);
+    }
+
+    // All rows, row 0 first
+    uint64_t* data() {
+        return buffer.data();
+    }
+
+    const uint64_t* data() const {
+        return buffer.data();
+    }
+
+    // Copy of row k as a Polynomial
+    Polynomial operator[](size_t k) const {
+        Polynomial p(ring_dim, modulus);
+        std::memcpy(p.data(), row(k), ring_dim * sizeof(uint64_t));
+        return p;
+    }
+
+    std::vector<Polynomial> toPolynomials() const {
+        std::vector<Polynomial> result;
+        result.reserve(rows);
+        for (size_t k = 0; k < rows; k++) {
+            result.push_back((*this)[k]);
+        }
+        return result;
+    }
+
+private:
+    size_t rows;
+    size_t ring_dim;
+    uint64_t modulus;
+    std::vector<uint64_t> buffer;
+};
+
+#endif // POLYNOMIAL_BATCH_H
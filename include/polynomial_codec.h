@@ -0,0 +1,50 @@
+#ifndef POLYNOMIAL_CODEC_H
+#define POLYNOMIAL_CODEC_H
+
+#include <polynomial.h>
+#include <small_polynomial.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact binary encoding of polynomials. Coefficients are reduced mod q
+// and packed little-endian into ceil(log2 q) bits each, so a polynomial
+// over q = 7681 takes 13 bits per coefficient instead of 64.
+
+// Bytes taken by n packed coefficients for modulus q
+size_t packedSize(size_t n, uint64_t q);
+
+// Appends the packed coefficients of p to out, or writes exactly
+// packedSize(p.degree(), p.getModulus()) bytes at out
+void packCoefficients(const Polynomial& p, std::vector<uint8_t>& out);
+void packCoefficients(const Polynomial& p, uint8_t* out);
+
+// The same for n coefficients of modulus q held outside a Polynomial, such
+// as a row of a PolynomialBatch
+void packCoefficients(const uint64_t* coeffs, size_t n, uint64_t q, uint8_t* out);
+
+// Reads packedSize(p.degree(), p.getModulus()) bytes from in into p's
+// coefficients; throws std::invalid_argument if a value is not below q
+void unpackCoefficients(const uint8_t* in, Polynomial& p);
+void unpackCoefficients(const uint8_t* in, size_t n, uint64_t q, uint64_t* coeffs);
+
+// A list of polynomials, each as u32 n | u64 q | packed coefficients,
+// preceded by a u32 count. Decoding throws std::invalid_argument on
+// malformed input.
+std::vector<uint8_t> encodePolynomials(const std::vector<Polynomial>& polys);
+std::vector<Polynomial> decodePolynomials(const uint8_t* data, size_t size);
+
+// Golomb-Rice coding of a small polynomial, for secrets and blinding
+// factors kept in key files and wallet stores. Each coefficient is its
+// magnitude m as (m >> k) zero bits, a one bit and the low k bits of m,
+// followed by a sign bit if m is nonzero. k is chosen per polynomial to
+// minimize the size; Gaussians with deviation 3 take about 4 bits per
+// coefficient. Layout: u32 n | u64 q | u8 k | u32 payload bytes | payload.
+std::vector<uint8_t> encodeSmallPolynomial(const SmallPolynomial& p);
+
+// Throws std::invalid_argument on malformed input. If consumed is not
+// null, trailing bytes are allowed and the size of the encoding is stored
+// there.
+SmallPolynomial decodeSmallPolynomial(const uint8_t* data, size_t size, size_t* consumed = nullptr);
+
+#endif // POLYNOMIAL_CODEC_H
@@ -0,0 +1,142 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SHA-256 of a request body, as the caller canonically encodes it
+using RequestDigest = std::array<uint8_t, 32>;
+
+enum class CacheStatus {
+    Miss,      // Not cached; the caller now holds the claim on the request ID
+    Hit,       // Cached response for the same request body
+    Conflict   // The ID was used for a different request body, or its first
+               // attempt is still running after the cache's ttl
+};
+
+class ResponseCache;
+struct ClaimState;
+
+// A caller's hold on a request ID that missed. It ends with store() or
+// release(); a claim destroyed while still held releases the ID, so an
+// exception on the request path never leaves retries waiting. Move-only.
+class CacheClaim {
+public:
+    CacheClaim() = default;
+    CacheClaim(CacheClaim&& other) noexcept;
+    CacheClaim& operator=(CacheClaim&& other) noexcept;
+    CacheClaim(const CacheClaim&) = delete;
+    CacheClaim& operator=(const CacheClaim&) = delete;
+    ~CacheClaim();
+
+    // True until the claim is stored or released
+    explicit operator bool() const { return cache != nullptr; }
+
+    // Stores the response and ends the claim. Returns false if the response
+    // is larger than the cache's whole budget: it is then handed to the
+    // retries already waiting on the claim, but not cached for later ones.
+    bool store(std::vector<uint8_t> response);
+
+    // Ends the claim without a response, e.g. after the request failed; a
+    // waiting retry then runs the request itself
+    void release();
+
+private:
+    friend class ResponseCache;
+    CacheClaim(ResponseCache* cache, std::string request_id, std::shared_ptr<ClaimState> state);
+
+    ResponseCache* cache = nullptr;
+    std::string request_id;
+    std::shared_ptr<ClaimState> state;
+};
+
+struct CacheLookup {
+    CacheStatus status;
+    std::vector<uint8_t> response;  // Set on Hit
+    CacheClaim claim;               // Held on Miss
+};
+
+// Serialized responses of completed requests, keyed by the client's request
+// ID, so a retried request is answered from memory before any signature is
+// verified or issued (and without tripping the double-spend check on its
+// own inputs). Each response is stored with the digest of its request body,
+// and a reused ID with a different body is refused rather than answered.
+//
+// A request ID that misses is claimed by the caller through the returned
+// CacheClaim. A retry arriving meanwhile waits for the first attempt, at
+// most `ttl`, instead of running the request a second time.
+//
+// Entries expire `ttl` after they are stored. Memory is bounded by
+// `max_bytes`, charged as the request ID and response sizes plus
+// ENTRY_OVERHEAD per entry; storing past the budget evicts the least
+// recently used entries. All operations take one mutex and are O(1).
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimeSource = std::function<Clock::time_point()>;
+
+    // Approximate bookkeeping cost of one entry: list node, hash node and
+    // the strings' and vector's own headers
+    static constexpr size_t ENTRY_OVERHEAD = 128;
+
+    // Throws std::invalid_argument if max_bytes or ttl is zero. `now` is
+    // the clock used for expiry.
+    ResponseCache(size_t max_bytes, std::chrono::milliseconds ttl, TimeSource now = Clock::now);
+
+    // Looks up request_id for a request whose body hashes to `request`.
+    // Blocks while another caller holds a claim on the same ID and body,
+    // and reports Conflict if that claim is still held after ttl. On Miss
+    // the returned lookup holds the claim.
+    CacheLookup begin(const std::string& request_id, const RequestDigest& request);
+
+    size_t size() const;
+    size_t bytes() const;  // Charged bytes, at most max_bytes
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+    uint64_t evictions() const;  // Entries dropped for space, not expiry
+    uint64_t conflicts() const;
+
+private:
+    friend class CacheClaim;
+
+    struct Entry {
+        std::string request_id;
+        RequestDigest request;
+        std::vector<uint8_t> response;
+        Clock::time_point expires;
+        size_t cost;
+    };
+
+    size_t max_bytes;
+    std::chrono::milliseconds ttl;
+    TimeSource now;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> by_id;
+    std::unordered_map<std::string, std::shared_ptr<ClaimState>> in_flight;  // Claimed IDs
+    std::condition_variable settled;  // Signalled when a claim ends
+    size_t used_bytes = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+    uint64_t eviction_count = 0;
+    uint64_t conflict_count = 0;
+
+    // Ends a claim, storing `response` unless it is null
+    bool finish(const std::string& request_id, const std::shared_ptr<ClaimState>& state,
+                std::vector<uint8_t>* response);
+    void erase(std::list<Entry>::iterator it);
+};
+
+#endif // RESPONSE_CACHE_H
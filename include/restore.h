@@ -0,0 +1,84 @@
+#ifndef RESTORE_H
+#define RESTORE_H
+
+#include <derivation.h>
+#include <keyset.h>
+#include <polynomial.h>
+#include <small_polynomial.h>
+#include <params.h>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+// Asks the mint which of a batch of blinded messages it has signed.
+// Element k of the result is the blind signature of blinded[k], or empty
+// if the mint never signed it; the result must have blinded.size() entries.
+using SignatureLookup =
+    std::function<std::vector<std::optional<Polynomial>>(const std::vector<Polynomial>& blinded)>;
+
+struct RestoredToken {
+    uint64_t counter;
+    std::vector<uint8_t> secret;
+    Polynomial signature;  // Unblinded
+};
+
+struct RestoreResult {
+    std::vector<RestoredToken> tokens;  // In counter order
+    uint64_t next_counter;              // First counter after the last signed one
+    uint64_t scanned;                   // Counters derived and submitted
+    size_t lookups;                     // Calls to the lookup
+};
+
+// Rebuilds the tokens of a seed-derived wallet for one keyset.
+//
+// Counters are scanned in batches: every candidate Y + a*r of a batch is
+// derived in parallel, the batch is submitted to the mint in one lookup and
+// the signatures it returns are unblinded in parallel. Scanning stops once
+// gap_limit consecutive counters after the last signed one came back
+// unsigned, so batches shrink to the remaining window near the end.
+//
+// The public key is held as a PreparedKeyset, so NTT(a) and NTT(b) are
+// computed once. Each blinding factor is transformed once, eight at a time
+// with NTT::forwardBatch, and its transform is reused for the unblinding
+// product r*b.
+class WalletRestorer {
+public:
+    static constexpr size_t DEFAULT_BATCH_SIZE = 256;
+    static constexpr size_t DEFAULT_GAP_LIMIT = 100;
+
+    // a and b are the keyset's public key; throws std::invalid_argument if
+    // they are not in the same ring or batch_size or gap_limit is zero
+    WalletRestorer(const SeedDerivation& derivation, const Polynomial& a, const Polynomial& b,
+                   size_t batch_size = DEFAULT_BATCH_SIZE, size_t gap_limit = DEFAULT_GAP_LIMIT);
+
+    // Scans from counter `start`; throws std::runtime_error if the lookup
+    // returns the wrong number of entries
+    RestoreResult restore(const SignatureLookup& lookup, uint64_t start = 0) const;
+
+    // Candidate blinded messages for counters [first, first + count), as
+    // RLWESignature::computeBlindedMessage would produce them
+    std::vector<Polynomial> blindedMessages(uint64_t first, size_t count) const;
+
+private:
+    // Derived state for one batch of counters
+    struct Batch {
+        std::vector<std::vector<uint8_t>> secrets;
+        std::vector<SmallPolynomial> factors;
+        std::vector<uint64_t> factors_hat;  // NTT(r) rows, when the ring supports it
+        std::vector<Polynomial> blinded;
+    };
+
+    SeedDerivation derivation;
+    PreparedKeyset keyset;
+    const ParameterSet* params;
+    size_t batch_size;
+    size_t gap_limit;
+    bool use_ntt;
+
+    Batch derive(uint64_t first, size_t count) const;
+    std::vector<Polynomial> unblind(const Batch& batch, const std::vector<size_t>& indices,
+                                    const std::vector<Polynomial>& blind_signatures) const;
+};
+
+#endif // RESTORE_H
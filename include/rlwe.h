@@ -3,48 +3,152 @@
 
 #include <cmath>
 #include <polynomial.h>
+#include <small_polynomial.h>
+#include <derivation.h>
+#include <keyset.h>
+#include <polynomial_batch.h>
+#include <params.h>
+#include <validator.h>
+#include <memory>
+#include <string>
 #include <vector>
 #include <cstdint>
 #include <iomanip>
 #include <sstream>
 #include <logging.h>
 
+class SignatureIndex;
+
 class RLWESignature {
 public:
-    RLWESignature(size_t n, uint64_t q);
+    RLWESignature(size_t n, uint64_t q, double stddev = GAUSSIAN_STDDEV);
+    explicit RLWESignature(ParameterPreset preset);
     void generateKeys();
+
+    // Key file: an 8-byte magic, the public key bit-packed as by
+    // encodePolynomials() behind a u32 length, and the secret key
+    // Golomb-Rice coded by encodeSmallPolynomial(). At n = 256, q = 7681 the
+    // file is about a tenth of the in-memory size of the 64-bit key.
+    // saveKeys() creates the file with mode 0600 and renames it into place
+    // once it is fully written. loadKeys() replaces generateKeys(); both throw std::runtime_error if
+    // the file cannot be read or written, is not a key file or holds keys of
+    // another ring.
+    void saveKeys(const std::string& path) const;
+    void loadKeys(const std::string& path);
+
+    // An instance for the ring recorded in a key file, with its keys loaded
+    static std::unique_ptr<RLWESignature> fromKeyFile(const std::string& path);
     Polynomial blindSign(const Polynomial& blindedMessage);
     bool verify(const std::vector<uint8_t>& secret, 
                const Polynomial& signature);
 
+    // Batched signing and verification. The secret key is transformed once
+    // per call and the other operands are transformed eight at a time with
+    // NTT::forwardBatch; results match blindSign()/verify() on each element.
+    std::vector<Polynomial> blindSignBatch(const std::vector<Polynomial>& blindedMessages);
+    std::vector<bool> verifyBatch(const std::vector<std::vector<uint8_t>>& secrets,
+                                  const std::vector<Polynomial>& signatures);
+
+    // The same for proofs read in place, such as the views a TokenReader
+    // yields: secret k is secret_sizes[k] bytes at secrets[k] and its
+    // signature is row k of signatures. results[k] is what verify() would
+    // return. The hashes and products share one batch buffer, and the key
+    // is only read, so threads may verify separate batches at once.
+    void verifyBatch(const uint8_t* const* secrets, const size_t* secret_sizes,
+                     const PolynomialBatch& signatures, bool* results) const;
+
+    // The product step of verifyBatch() on its own, for callers that hash
+    // and compare separately: multiplies every row of batch, which must be
+    // in this ring, by the secret key in place
+    void multiplyBySecret(PolynomialBatch& batch) const;
+
+    size_t degree() const {
+        return ring_dim_n;
+    }
+
+    uint64_t getModulus() const {
+        return modulus;
+    }
+
+    // Public key (a, b). The returned polynomials share their coefficient
+    // storage with the key, so fetching the key is O(1) for any ring size.
     std::pair<Polynomial, Polynomial> getPublicKey() const {
         return std::make_pair(a, b);
     }
 
+    // Prefilter applied to blinded messages before signing; its counter
+    // reports how many requests were rejected
+    const PolynomialValidator& getValidator() const {
+        return validator;
+    }
+
+    // Records every blind signature issued from now on in index, for
+    // restore queries; null stops recording. The index must outlive its use.
+    void setSignatureIndex(SignatureIndex* index) {
+        signature_index = index;
+    }
+
+    // Identifier of the current public key, set by generateKeys()
+    const KeysetId& keysetId() const {
+        return keyset_id;
+    }
+
     Polynomial hashToPolynomial(const std::vector<uint8_t>& message);
     std::pair<Polynomial, Polynomial> computeBlindedMessage(const std::vector<uint8_t>& secret);
     Polynomial computeSignature(const Polynomial& blindSignature, const Polynomial& blindingFactor, const Polynomial& publicKey);
 
+    // Blinding and unblinding with a caller-supplied blinding factor, e.g.
+    // one regenerated by SeedDerivation instead of stored by the wallet
+    Polynomial computeBlindedMessage(const std::vector<uint8_t>& secret, const SmallPolynomial& blindingFactor);
+    Polynomial computeSignature(const Polynomial& blindSignature, const SmallPolynomial& blindingFactor,
+                                const Polynomial& publicKey) const;
+
+    // Blinding and unblinding of every output of a payment in one pass
+    // against this instance's public key, whose transforms generateKeys()
+    // prepares once. Row k of the result matches computeBlindedMessage()
+    // and computeSignature() for output k. Throw std::runtime_error before
+    // keys are generated.
+    PolynomialBatch computeBlindedMessageBatch(const std::vector<std::vector<uint8_t>>& secrets,
+                                               const std::vector<SmallPolynomial>& blindingFactors) const;
+    PolynomialBatch computeSignatureBatch(const std::vector<Polynomial>& blindSignatures,
+                                          const std::vector<SmallPolynomial>& blindingFactors) const;
+
 private:
     size_t ring_dim_n;
     uint64_t modulus;
+    double gaussian_stddev;      // Standard deviation for secrets, blinding factors and noise
+    const ParameterSet* params;  // Precomputed tables for (n, q)
+    // The same with a Gaussian CDT for gaussian_stddev, if that is not
+    // params->sigma
+    std::shared_ptr<const ParameterSet> sampler;
+    PolynomialValidator validator;
     
     // Public key components
     Polynomial a;  // Random polynomial
     Polynomial b;  // a*s + e
     
-    // Private key
-    Polynomial s;  // Secret key
+    // Private key, stored as centered bytes
+    SmallPolynomial s;  // Secret key
+
+    KeysetId keyset_id{};  // Identifier of (a, b)
+    std::shared_ptr<const PreparedKeyset> prepared;  // (a, b) with their transforms
+    SignatureIndex* signature_index = nullptr;       // Issued signatures, if recorded
     
     // Helper functions
     uint64_t getRandomUint64();
-    double getRandomDouble();
     Polynomial sampleUniform();
-    Polynomial sampleGaussian(double stddev);
+    SmallPolynomial sampleGaussian();  // With gaussian_stddev
     Polynomial messageToPolynomial(const std::vector<uint8_t>& message);
+    const PreparedKeyset& preparedKeyset() const;
+    std::vector<Polynomial> multiplyBySecret(const std::vector<Polynomial>& polys) const;
+    bool signalsMatch(const Polynomial& signature, const Polynomial& expected) const;
     
     // Reduced standard deviation for better sensitivity
-    static constexpr double GAUSSIAN_STDDEV = 3.0;     // Small standard deviation for cleaner signals
+    static constexpr double GAUSSIAN_STDDEV = ParameterSet::GAUSSIAN_STDDEV;  // Small standard deviation for cleaner signals
+
+    // Sampler tables reach 10 standard deviations, so up to this deviation
+    // every sample fits the 8-bit secret and noise storage
+    static constexpr double MAX_SMALL_STDDEV = 12.0;
     
     // Verification parameters
     static constexpr double LARGE_THRESHOLD_DIVISOR = 4.0;   // For values near q/2
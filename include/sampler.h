@@ -0,0 +1,44 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <params.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Table-driven sampler for the rounded Gaussian distribution used for
+// secrets, blinding factors and noise. Randomness is supplied by the
+// caller as uniform 64-bit words, one per coefficient, so the same code
+// serves the system random source and deterministic streams.
+class GaussianSampler {
+public:
+    // Map one uniform word to a centered sample. The top bit selects the
+    // sign; the whole table is scanned so the running time does not depend
+    // on the sampled value.
+    static int64_t fromWord(uint64_t word, const ParameterSet& params) {
+        const uint64_t u = word & ((uint64_t(1) << 63) - 1);
+        int64_t magnitude = 0;
+        for (size_t i = 0; i < params.cdt_size; i++) {
+            magnitude += static_cast<int64_t>(u >= params.cdt[i]);
+        }
+        return (word >> 63) ? -magnitude : magnitude;
+    }
+
+    // Fill coeffs[0..count) with samples reduced to [0, q)
+    static void sample(uint64_t* coeffs, const uint64_t* words, size_t count,
+                       const ParameterSet& params);
+
+    // Fill coeffs[0..count) with centered samples. Magnitudes never exceed
+    // params.cdt_size, which is checked to fit a signed byte.
+    static void sampleCentered(int8_t* coeffs, const uint64_t* words, size_t count,
+                               const ParameterSet& params);
+
+    // A copy of params whose table samples deviation sigma instead. The
+    // table reaches about 10 sigma, beyond which the mass is below the
+    // 2^-63 resolution of its entries, and is capped at 127 entries so
+    // samples still fit a signed byte. Throws std::invalid_argument unless
+    // 0 < sigma <= 12.
+    static std::shared_ptr<const ParameterSet> withDeviation(const ParameterSet& params, double sigma);
+};
+
+#endif // SAMPLER_H
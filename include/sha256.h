@@ -16,6 +16,9 @@ public:
     // Hash a string
     static std::vector<uint8_t> hash(const std::string& data);
     
+    // Hash a raw buffer into a caller-provided digest of hashSize() bytes
+    static void hash(const uint8_t* data, size_t length, uint8_t* digest);
+    
     // Hash a polynomial
     static std::vector<uint8_t> polyToHash(const Polynomial& poly);
     
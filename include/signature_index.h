@@ -0,0 +1,115 @@
+#ifndef SIGNATURE_INDEX_H
+#define SIGNATURE_INDEX_H
+
+#include <derivation.h>
+#include <polynomial.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SHA-256 of a blinded message's canonical encoding: little-endian 64-bit
+// n and q followed by the coefficients reduced mod q and bit-packed as in
+// the index records
+using MessageDigest = std::array<uint8_t, 32>;
+
+MessageDigest digestBlindedMessage(const Polynomial& blinded);
+
+struct IssuedSignature {
+    KeysetId keyset;
+    Polynomial blind_signature;
+};
+
+// Persistent mint-side record of every blind signature issued, keyed by the
+// digest of the blinded message, so wallets restoring from a seed can ask
+// which of their candidate messages were signed.
+//
+// The file is an append-only log: an 8-byte magic followed by one record
+// per signature,
+//
+//   u32 length | digest | keyset | u32 n | u64 q | packed coefficients | u32 FNV-1a
+//
+// with each coefficient packed into ceil(log2 q) bits (13 bits instead of
+// 64 for q = 7681). Opening replays the log and drops a torn record at the
+// tail; a bad record followed by intact ones makes the open fail instead.
+// Only the digest, offset and size of each record stay in memory, split
+// over shards that each have their own lock, so a growing index never
+// moves record data and rehashes one small shard at a time. Lookups find
+// the offsets under the shard locks and read the records from the file
+// after releasing them.
+//
+// Durability is group commit: recording hands the records to the
+// operating system, which keeps them if the process dies, and flush()
+// syncs everything recorded so far to the disk. Callers flush once per
+// request or batch, before returning the signatures, so a power loss
+// cannot lose a signature a client has already received.
+class SignatureIndex {
+public:
+    // Opens the index at path, creating it if it does not exist. Throws
+    // std::runtime_error if the file cannot be opened, is not an index, or
+    // has a corrupt record before its last one.
+    explicit SignatureIndex(const std::string& path);
+    ~SignatureIndex();
+
+    SignatureIndex(const SignatureIndex&) = delete;
+    SignatureIndex& operator=(const SignatureIndex&) = delete;
+
+    // Appends one signature, or all of a batch with a single write.
+    // Recording a message again replaces the earlier signature.
+    void record(const Polynomial& blinded, const Polynomial& blind_signature, const KeysetId& keyset);
+    void recordBatch(const std::vector<Polynomial>& blinded, const std::vector<Polynomial>& blind_signatures,
+                     const KeysetId& keyset);
+
+    // Element k is the signature issued for digests[k], if any. Throws
+    // std::runtime_error if a matching record cannot be read back intact.
+    std::vector<std::optional<IssuedSignature>> lookup(const std::vector<MessageDigest>& digests) const;
+
+    // Blind signatures for the given blinded messages, in the form a
+    // SignatureLookup returns
+    std::vector<std::optional<Polynomial>> lookup(const std::vector<Polynomial>& blinded) const;
+
+    // Syncs every record appended so far to the disk. Throws
+    // std::runtime_error if the sync fails.
+    void flush();
+
+    size_t size() const;
+
+    // Bytes of encoded records, excluding the file header
+    size_t storedBytes() const;
+
+private:
+    struct DigestHash {
+        size_t operator()(const MessageDigest& d) const;
+    };
+
+    // Where a record body lives in the file
+    struct Location {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    static constexpr size_t SHARDS = 64;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<MessageDigest, Location, DigestHash> locations;
+    };
+
+    std::string path;
+    int fd = -1;
+    std::mutex log_mutex;           // Serializes appends to the file
+    std::atomic<uint64_t> end{0};   // File size; written under log_mutex
+    std::array<Shard, SHARDS> shards;
+
+    static size_t shardOf(const MessageDigest& digest);
+    void replay();
+    void append(const std::vector<MessageDigest>& digests, const std::vector<uint8_t>& framed,
+                const std::vector<size_t>& body_offsets);
+};
+
+#endif // SIGNATURE_INDEX_H
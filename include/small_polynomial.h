@@ -0,0 +1,97 @@
+#ifndef SMALL_POLYNOMIAL_H
+#define SMALL_POLYNOMIAL_H
+
+#include <polynomial.h>
+#include <params.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Polynomial in Z_q[x]/(x^n + 1) whose coefficients are all small, stored
+// as centered signed bytes instead of 64-bit residues q - k. Secrets,
+// blinding factors and noise are drawn from a Gaussian of standard
+// deviation about 3, so they take an eighth of the memory of a Polynomial
+// and the small operand of a product streams through SIMD registers eight
+// coefficients per 64-bit lane of the full operand.
+class SmallPolynomial {
+public:
+    // Largest coefficient magnitude that can be stored
+    static constexpr int64_t MAX_COEFF = 127;
+
+    // Zero polynomial
+    SmallPolynomial(size_t n, uint64_t q);
+
+    // From centered values; throws std::invalid_argument if any value has
+    // magnitude above MAX_COEFF or the modulus is too small to hold them,
+    // i.e. 2|v| >= q, so that v and -v would not be distinct mod q
+    SmallPolynomial(const std::vector<int64_t>& values, uint64_t q);
+
+    // Centered representatives of the coefficients of p; throws
+    // std::invalid_argument if any of them is not small
+    static SmallPolynomial fromPolynomial(const Polynomial& p);
+
+    // One Gaussian sample per coefficient from the table-driven sampler,
+    // using words[0..params.n) as randomness
+    static SmallPolynomial sampleGaussian(const uint64_t* words, const ParameterSet& params);
+
+    int8_t operator[](size_t idx) const {
+        return coeffs[idx];
+    }
+
+    const int8_t* data() const {
+        return coeffs.data();
+    }
+
+    size_t degree() const {
+        return ring_dim;
+    }
+
+    uint64_t getModulus() const {
+        return modulus;
+    }
+
+    // Coefficients as residues in [0, q)
+    void widen(uint64_t* out) const;
+    Polynomial toPolynomial() const;
+
+    // Negacyclic product with a full polynomial of the same ring. Small
+    // rings use a direct kernel that sign-extends the bytes on the fly,
+    // accumulates in 32 bits and reduces each output once; larger rings
+    // widen this operand into the transform buffer and use the NTT.
+    Polynomial multiply(const Polynomial& full) const;
+
+    // full + *this, coefficient-wise mod q
+    Polynomial addTo(const Polynomial& full) const;
+
+    std::string toString() const;
+
+    // Rings up to this size use the direct kernel in multiply(); with
+    // 256-bit integer vectors it beats the NTT up to n = 256
+#if defined(__AVX2__)
+    static constexpr size_t DIRECT_MAX_N = 256;
+#else
+    static constexpr size_t DIRECT_MAX_N = 128;
+#endif
+
+private:
+    std::vector<int8_t> coeffs;  // Centered coefficients
+    size_t ring_dim;             // Polynomial ring dimension
+    uint64_t modulus;            // Modulus q
+
+    Polynomial multiplyDirect(const Polynomial& full) const;
+};
+
+// Mixed products and sums of small and full polynomials
+inline Polynomial operator*(const SmallPolynomial& small, const Polynomial& full) {
+    return small.multiply(full);
+}
+
+inline Polynomial operator*(const Polynomial& full, const SmallPolynomial& small) {
+    return small.multiply(full);
+}
+
+inline Polynomial operator+(const Polynomial& full, const SmallPolynomial& small) {
+    return small.addTo(full);
+}
+
+#endif // SMALL_POLYNOMIAL_H
@@ -0,0 +1,73 @@
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <polynomial.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Text encodings of byte buffers for tokens and JSON APIs: unpadded
+// base64url (RFC 4648 section 5) and lowercase hex. Encoders write into a
+// caller buffer of the exact encoded size; decoders write into a buffer of
+// the exact decoded size and throw std::invalid_argument on characters
+// outside the alphabet or non-canonical input. Characters are classified a
+// block at a time in branch-free loops that vectorize, so only the bit
+// regrouping between 6-bit and 8-bit units is scalar.
+
+size_t base64urlEncodedSize(size_t bytes);
+
+// Throws std::invalid_argument for a length no encoding has
+size_t base64urlDecodedSize(size_t chars);
+
+void base64urlEncode(const uint8_t* in, size_t size, char* out);
+void base64urlDecode(const char* in, size_t size, uint8_t* out);
+
+inline size_t hexEncodedSize(size_t bytes) {
+    return 2 * bytes;
+}
+
+// Decoding accepts either case
+void hexEncode(const uint8_t* in, size_t size, char* out);
+void hexDecode(const char* in, size_t size, uint8_t* out);
+
+// Incremental base64url for tokens too large to hold whole. Each call
+// consumes all its input and returns the number of units written; up to
+// two input bytes (encoder) or three characters (decoder) are carried to
+// the next call. update() writes at most base64urlEncodedSize(size + 2)
+// chars or 3 * ((size + 3) / 4) bytes; finish() at most 3 of either.
+class Base64urlEncoder {
+public:
+    size_t update(const uint8_t* in, size_t size, char* out);
+    size_t finish(char* out);
+
+private:
+    uint8_t pending[3];
+    size_t pending_size = 0;
+};
+
+class Base64urlDecoder {
+public:
+    size_t update(const char* in, size_t size, uint8_t* out);
+    size_t finish(uint8_t* out);
+
+private:
+    char pending[4];
+    size_t pending_size = 0;
+};
+
+// p's coefficients bit-packed as by packCoefficients() and appended to out
+// as text, with no intermediate buffers beyond a per-thread scratch area
+void appendPolynomialBase64url(const Polynomial& p, std::string& out);
+void appendPolynomialHex(const Polynomial& p, std::string& out);
+
+// Fill p's coefficients from text produced by the functions above for a
+// polynomial of p's degree and modulus
+void decodePolynomialBase64url(const char* in, size_t size, Polynomial& p);
+void decodePolynomialHex(const char* in, size_t size, Polynomial& p);
+
+// Base64url of n coefficients of modulus q held outside a Polynomial, such
+// as a row of a PolynomialBatch
+void appendCoefficientsBase64url(const uint64_t* coeffs, size_t n, uint64_t q, std::string& out);
+void decodeCoefficientsBase64url(const char* in, size_t size, size_t n, uint64_t q, uint64_t* coeffs);
+
+#endif // TEXT_CODEC_H
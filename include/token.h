@@ -0,0 +1,156 @@
+#ifndef TOKEN_H
+#define TOKEN_H
+
+#include <derivation.h>
+#include <polynomial.h>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Tokens in the layout of Cashu V4, a CBOR map conventionally sent as
+// "cashuB" followed by its base64url encoding, adapted to polynomial
+// signatures:
+//
+//   { "m": mint URL, "u": unit, ["d": memo,]
+//     "t": [ { "i": keyset ID, "n": ring dimension, "q": modulus,
+//              "p": [ { "a": amount, "s": secret, "c": signature }, ... ] },
+//            ... ] }
+//
+// "c" holds the signature coefficients bit-packed as by packCoefficients(),
+// so the ring of each keyset group must precede its proofs. Unknown keys
+// are skipped when reading.
+
+// Packed coefficients of a polynomial inside a token buffer
+struct PolynomialView {
+    const uint8_t* data = nullptr;
+    size_t n = 0;
+    uint64_t q = 0;
+
+    // Fills p, which must have degree n and modulus q; throws
+    // std::invalid_argument otherwise or if a coefficient is not below q
+    void unpack(Polynomial& p) const;
+    Polynomial toPolynomial() const;
+};
+
+// One proof of a token. The pointers refer into the token buffer.
+struct ProofView {
+    KeysetId keyset{};
+    uint64_t amount = 0;
+    const uint8_t* secret = nullptr;
+    size_t secret_size = 0;
+    PolynomialView signature;
+
+    std::vector<uint8_t> secretBytes() const {
+        return std::vector<uint8_t>(secret, secret + secret_size);
+    }
+};
+
+// A proof to write with TokenWriter::write(); the secret and signature are
+// borrowed for the call
+struct TokenProof {
+    KeysetId keyset{};
+    uint64_t amount = 0;
+    const uint8_t* secret = nullptr;
+    size_t secret_size = 0;
+    const Polynomial* signature = nullptr;
+};
+
+// Writes a token straight into a caller buffer. Keysets and proofs are
+// added in order, and the arrays holding them are indefinite-length, so
+// nothing needs to be counted in advance. Every call throws
+// std::runtime_error once the buffer is full; the sizes below add up to
+// the exact size of a token.
+class TokenWriter {
+public:
+    TokenWriter(uint8_t* out, size_t capacity, std::string_view mint, std::string_view unit);
+
+    // Starts the group of proofs signed under keyset, closing the last one
+    void beginKeyset(const KeysetId& keyset, size_t n, uint64_t q);
+
+    // Throws std::invalid_argument if no keyset has been begun or the
+    // signature is not in its ring
+    void addProof(uint64_t amount, const uint8_t* secret, size_t secret_size, const Polynomial& signature);
+
+    // Closes the token and returns its size
+    size_t finish();
+
+    static size_t headerSize(std::string_view mint, std::string_view unit);
+    static size_t keysetSize(size_t n, uint64_t q);
+    static size_t proofSize(uint64_t amount, size_t secret_size, size_t n, uint64_t q);
+
+    // Whole tokens: a keyset group starts at the first proof and wherever
+    // the keyset or the signature's ring differs from the proof before.
+    // tokenSize() is the exact size write() produces.
+    static size_t tokenSize(std::string_view mint, std::string_view unit, const std::vector<TokenProof>& proofs);
+    static size_t write(uint8_t* out, size_t capacity, std::string_view mint, std::string_view unit,
+                        const std::vector<TokenProof>& proofs);
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used = 0;
+    bool keyset_open = false;
+    size_t ring_dim = 0;
+    uint64_t modulus = 0;
+};
+
+// The token holding proofs, in a buffer of exactly its size
+std::vector<uint8_t> writeToken(std::string_view mint, std::string_view unit, const std::vector<TokenProof>& proofs);
+
+// Reads a token in place. The constructor checks that the whole buffer is
+// one well-formed token and reads its header; next() then yields the
+// proofs in order without copying or allocating. The buffer must outlive
+// the reader and every view it returns.
+class TokenReader {
+public:
+    // Throws std::invalid_argument if the buffer is not a token
+    TokenReader(const uint8_t* data, size_t size);
+
+    std::string_view mint() const {
+        return mint_url;
+    }
+
+    std::string_view unit() const {
+        return token_unit;
+    }
+
+    std::string_view memo() const {
+        return token_memo;
+    }
+
+    // Reads the next proof into proof; returns false after the last one.
+    // Throws std::invalid_argument on a malformed keyset group or proof.
+    bool next(ProofView& proof);
+
+    // Starts again from the first proof
+    void rewind();
+
+    // Largest ring dimension accepted in a token
+    static constexpr size_t MAX_DEGREE = size_t(1) << 16;
+
+private:
+    // Entries left in an array or map being read
+    struct Remaining {
+        uint64_t count = 0;
+        bool indefinite = false;
+    };
+
+    const uint8_t* data;
+    size_t size;
+    const uint8_t* proofs_start = nullptr;  // First byte of the "t" array
+    const uint8_t* cursor = nullptr;
+    std::string_view mint_url;
+    std::string_view token_unit;
+    std::string_view token_memo;
+
+    Remaining groups;
+    Remaining group_entries;
+    Remaining proofs;
+    bool in_proofs = false;
+    KeysetId keyset{};
+    size_t ring_dim = 0;
+    uint64_t modulus = 0;
+};
+
+#endif // TOKEN_H
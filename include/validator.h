@@ -0,0 +1,62 @@
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include <params.h>
+#include <polynomial.h>
+#include <atomic>
+#include <cstdint>
+
+// Outcome of validating one untrusted polynomial
+enum class ValidationResult {
+    OK,
+    WrongDimension,         // Ring dimension differs from the parameters
+    WrongModulus,           // Modulus differs from the parameters
+    CoefficientOutOfRange,  // Some coefficient is not reduced below q
+    ImplausibleDistribution // Too far from uniform to be an honest blinded message
+};
+
+// Cheap prefilter for polynomials received from clients, run before any
+// sampling or multiplication is spent on them. All checks are made in a
+// single branch-free pass over the coefficients.
+//
+// The optional distribution check targets inputs that should look uniform
+// mod q, such as blinded messages Y + a*r. It rejects when the number of
+// zero coefficients or the coefficient sum is more than eight standard
+// deviations from what a uniform polynomial gives, so honest inputs are
+// essentially never rejected while constant or all-zero junk always is.
+// Those bounds are loose in small rings, so a polynomial with all
+// coefficients equal is also rejected outright, as long as a uniform one
+// is all-equal with probability q^(1-n) <= 2^-CONSTANT_FLOOR_BITS. Below
+// that (e.g. n = 8 with q < 53, or n = 1) constant inputs can pass.
+class PolynomialValidator {
+public:
+    static constexpr double CONSTANT_FLOOR_BITS = 40;
+
+    explicit PolynomialValidator(const ParameterSet& params, bool check_distribution = true)
+        : params(&params), check_distribution(check_distribution), rejected(0) {}
+
+    PolynomialValidator(const PolynomialValidator& other)
+        : params(other.params), check_distribution(other.check_distribution),
+          rejected(other.rejected.load(std::memory_order_relaxed)) {}
+
+    // Run the checks without side effects
+    ValidationResult check(const Polynomial& p) const;
+
+    // Run the checks; on failure count the rejection and throw
+    // std::invalid_argument describing the reason
+    void validate(const Polynomial& p) const;
+
+    // Number of polynomials rejected by validate() so far
+    uint64_t rejections() const {
+        return rejected.load(std::memory_order_relaxed);
+    }
+
+    static const char* describe(ValidationResult result);
+
+private:
+    const ParameterSet* params;
+    bool check_distribution;
+    mutable std::atomic<uint64_t> rejected;
+};
+
+#endif // VALIDATOR_H
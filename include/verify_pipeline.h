@@ -0,0 +1,110 @@
+#ifndef VERIFY_PIPELINE_H
+#define VERIFY_PIPELINE_H
+
+#include <derivation.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+class RLWESignature;
+
+// Stages of a VerifyPipeline, in the order proofs pass through them
+enum class VerifyStage : uint8_t {
+    Parse,     // Read proofs from tokens and unpack their signatures
+    Hash,      // Hash each secret to a polynomial
+    Multiply,  // Multiply the hashes by the secret key with batched NTTs
+    Compare,   // Round the products and compare them with the signatures
+    SpentCheck // Look the valid proofs up in the spent set
+};
+
+constexpr size_t VERIFY_STAGE_COUNT = 5;
+
+const char* verifyStageName(VerifyStage stage);
+
+enum class ProofStatus : uint8_t { Valid, Invalid, Spent, UnknownKeyset };
+
+// Outcome for one proof. secret points into the token it was read from.
+struct VerifiedProof {
+    size_t token = 0;   // Position of the token in the run
+    uint64_t index = 0; // Position of the proof in its token
+    KeysetId keyset{};
+    uint64_t amount = 0;
+    const uint8_t* secret = nullptr;
+    size_t secret_size = 0;
+    ProofStatus status = ProofStatus::Valid;
+};
+
+struct PipelineOptions {
+    size_t batch = 64;       // Proofs of one keyset per batch, at most
+    size_t queue_depth = 8;  // Batches each queue between two stages holds
+    // Worker threads per stage, indexed by VerifyStage. Parse workers take
+    // whole tokens, so more than one only helps runs of several tokens.
+    std::array<size_t, VERIFY_STAGE_COUNT> workers{1, 1, 1, 1, 1};
+};
+
+// Time one stage's workers spent, summed over the workers: working on
+// batches, waiting for input, and waiting for room in the next queue
+struct StageStats {
+    size_t workers = 0;
+    uint64_t batches = 0;
+    uint64_t proofs = 0;
+    std::chrono::nanoseconds busy{0};
+    std::chrono::nanoseconds starved{0};
+    std::chrono::nanoseconds blocked{0};
+};
+
+struct PipelineStats {
+    std::array<StageStats, VERIFY_STAGE_COUNT> stages;
+    std::chrono::nanoseconds elapsed{0};
+    uint64_t proofs = 0;
+
+    // The stage with the most busy time per worker, which bounds throughput
+    VerifyStage bottleneck() const;
+};
+
+// Verifies the proofs of tokens in five stages that run concurrently, so
+// hashing, arithmetic and spent-set lookups of different batches overlap
+// instead of following each other per proof. Proofs travel in batches of
+// one keyset through bounded lock-free queues; a fixed pool of batches is
+// recycled after the last stage, so memory stays bounded however many
+// proofs a run holds, and a slow stage holds back the ones before it.
+// Worker counts are set per stage, and the stats of a run show which stage
+// limits it.
+//
+// Proofs of keysets that keys() does not know are UnknownKeyset, proofs
+// whose signature is not in the key's ring or does not verify are Invalid,
+// and valid proofs whose secret spent() reports are Spent. sink is called
+// for every batch, from one thread at a time, in no particular order;
+// VerifiedProof::token and ::index identify each proof.
+class VerifyPipeline {
+public:
+    // Must be safe to call from several threads at once. keys() returns
+    // null for an unknown keyset; spent may be empty to skip the check.
+    using KeyLookup = std::function<const RLWESignature*(const KeysetId& keyset)>;
+    using SpentCheck = std::function<bool(const uint8_t* secret, size_t secret_size)>;
+    using Sink = std::function<void(const VerifiedProof* proofs, size_t count)>;
+
+    // Throws std::invalid_argument if the batch size, queue depth or a
+    // worker count is zero
+    VerifyPipeline(KeyLookup keys, SpentCheck spent, PipelineOptions options = {});
+
+    // Verifies every proof of count tokens, token t being sizes[t] bytes
+    // at tokens[t]. Returns once every proof has reached sink. Throws
+    // std::invalid_argument if a token is malformed, and rethrows the
+    // first exception of a stage or of sink, after the stages have
+    // stopped; proofs already passed to sink stay passed.
+    PipelineStats run(const uint8_t* const* tokens, const size_t* sizes, size_t count, const Sink& sink) const;
+
+    const PipelineOptions& options() const {
+        return opts;
+    }
+
+private:
+    KeyLookup keys;
+    SpentCheck spent;
+    PipelineOptions opts;
+};
+
+#endif // VERIFY_PIPELINE_H
@@ -0,0 +1,122 @@
+#ifndef BIT_PACKING_H
+#define BIT_PACKING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// Little-endian bit streams for the compact on-disk encodings. Values are
+// written least significant bit first and bytes fill from bit 0 upwards.
+// This header is private to the library.
+
+// Unaligned 64-bit loads and stores in a fixed byte order, each one move
+// plus at most a byte swap
+inline uint64_t loadLE64(const uint8_t* in) {
+    uint64_t value;
+    std::memcpy(&value, in, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+inline void storeLE64(uint8_t* out, uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    std::memcpy(out, &value, 8);
+}
+
+inline uint64_t loadBE64(const uint8_t* in) {
+    uint64_t value;
+    std::memcpy(&value, in, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+inline void storeBE64(uint8_t* out, uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    std::memcpy(out, &value, 8);
+}
+
+// Number of bits needed to store every value in [0, q)
+inline unsigned bitsFor(uint64_t q) {
+    unsigned bits = 0;
+    while (bits < 64 && (q - 1) >> bits) {
+        bits++;
+    }
+    return bits == 0 ? 1 : bits;
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& output) : out(output) {}
+
+    // Low `bits` bits of value, 0 < bits <= 64
+    void write(uint64_t value, unsigned bits) {
+        if (bits > 32) {
+            write(value, 32);
+            write(value >> 32, bits - 32);
+            return;
+        }
+        acc |= (value & ((uint64_t(1) << bits) - 1)) << used;
+        used += bits;
+        while (used >= 8) {
+            out.push_back(static_cast<uint8_t>(acc));
+            acc >>= 8;
+            used -= 8;
+        }
+    }
+
+    // Pads the last byte with zero bits
+    void finish() {
+        if (used > 0) {
+            out.push_back(static_cast<uint8_t>(acc));
+            acc = 0;
+            used = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t acc = 0;
+    unsigned used = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : ptr(data), end(data + size) {}
+
+    // Next `bits` bits, 0 < bits <= 64; throws std::runtime_error past the end
+    uint64_t read(unsigned bits) {
+        if (bits > 32) {
+            const uint64_t low = read(32);
+            return low | (read(bits - 32) << 32);
+        }
+        while (avail < bits) {
+            if (ptr == end) {
+                throw std::runtime_error("Truncated bit stream");
+            }
+            acc |= uint64_t(*ptr++) << avail;
+            avail += 8;
+        }
+        const uint64_t value = acc & ((uint64_t(1) << bits) - 1);
+        acc >>= bits;
+        avail -= bits;
+        return value;
+    }
+
+private:
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t acc = 0;
+    unsigned avail = 0;
+};
+
+#endif // BIT_PACKING_H
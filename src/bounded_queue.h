@@ -0,0 +1,213 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Fixed-capacity multi-producer multi-consumer queue without locks (after
+// Vyukov's bounded MPMC queue). Each cell carries a sequence number that
+// tells producers and consumers whose turn it is, so a push or pop is one
+// compare-and-swap on the tail or head plus one store. tryPush() and
+// tryPop() never block. push() and pop() retry them for a short spin and
+// then park on a condition variable; the lock is only touched when a
+// thread is parked, which a successful tryPush() or tryPop() sees from a
+// counter of parked threads.
+//
+// close() marks the end of input: once every producer has finished and
+// one of them has closed the queue, a consumer that finds it empty and
+// closed() true after a further failed tryPop() can stop.
+template <typename T>
+class BoundedQueue {
+public:
+    // Capacity is rounded up to a power of two, at least 2
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells = std::make_unique<Cell[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    // Waits for room; false without pushing once stop is set and wake()
+    // has been called
+    bool push(const T& value, const std::atomic<bool>& stop) {
+        if (!wait(producers, room, [&]() { return enqueue(value); }, [&]() { return stop.load(); })) {
+            return false;
+        }
+        notify(consumers, items);
+        return true;
+    }
+
+    // Waits for a value; false once the queue is closed and drained, or
+    // once stop is set and wake() has been called
+    bool pop(T& value, const std::atomic<bool>* stop = nullptr) {
+        bool done = false;
+        auto attempt = [&]() {
+            if (dequeue(value)) {
+                return true;
+            }
+            // Pushes finished before the close, so one more look suffices
+            done = closed() || (stop != nullptr && stop->load());
+            return done && dequeue(value);
+        };
+        if (!wait(consumers, items, attempt, [&]() { return done; })) {
+            return false;
+        }
+        notify(producers, room);
+        return true;
+    }
+
+    // Wakes every parked thread to look at its stop flag again
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex);
+        room.notify_all();
+        items.notify_all();
+    }
+
+    // False if the queue is full
+    bool tryPush(const T& value) {
+        if (!enqueue(value)) {
+            return false;
+        }
+        notify(consumers, items);
+        return true;
+    }
+
+    // False if the queue is empty
+    bool tryPop(T& value) {
+        if (!dequeue(value)) {
+            return false;
+        }
+        notify(producers, room);
+        return true;
+    }
+
+    void close() {
+        is_closed.store(true, std::memory_order_release);
+        wake();
+    }
+
+    bool closed() const {
+        return is_closed.load(std::memory_order_acquire);
+    }
+
+private:
+    // tryPush() and tryPop() without waking parked threads
+    bool enqueue(const T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool dequeue(T& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Failed attempts before a waiting thread parks
+    static constexpr int SPIN_LIMIT = 64;
+
+    // Retries attempt until it succeeds or stopped() holds, spinning first
+    // and then parked on cv with parked counting the sleepers. The caller
+    // notifies the other side after a success, outside the lock.
+    template <typename Attempt, typename Stopped>
+    bool wait(std::atomic<size_t>& parked, std::condition_variable& cv, Attempt attempt, Stopped stopped) {
+        for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+            if (attempt()) {
+                return true;
+            }
+            if (stopped()) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        // Both sides read-modify-write parked, so either notify() reads it
+        // before this increment and its push or pop is visible to the
+        // attempt below, or it reads the increment and takes the lock
+        parked.fetch_add(1, std::memory_order_acq_rel);
+        bool success;
+        while (!(success = attempt()) && !stopped()) {
+            cv.wait(lock);
+        }
+        parked.fetch_sub(1, std::memory_order_relaxed);
+        return success;
+    }
+
+    void notify(std::atomic<size_t>& parked, std::condition_variable& cv) {
+        if (parked.fetch_add(0, std::memory_order_acq_rel) != 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    // Producers and consumers on separate cache lines
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> head{0};
+    std::atomic<bool> is_closed{false};
+
+    // Parking for push() and pop()
+    alignas(64) std::atomic<size_t> producers{0};  // Parked in push()
+    std::atomic<size_t> consumers{0};              // Parked in pop()
+    std::mutex mutex;
+    std::condition_variable room;
+    std::condition_variable items;
+};
+
+#endif // BOUNDED_QUEUE_H
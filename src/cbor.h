@@ -0,0 +1,241 @@
+#ifndef CBOR_H
+#define CBOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Minimal CBOR (RFC 8949) for the token format: unsigned integers, byte
+// and text strings, arrays and maps of definite or indefinite length.
+// Tags, negative integers and floating-point values are rejected. This
+// header is private to the library.
+namespace cbor {
+
+enum Major : uint8_t {
+    UNSIGNED = 0,
+    BYTES = 2,
+    TEXT = 3,
+    ARRAY = 4,
+    MAP = 5,
+    SIMPLE = 7,
+};
+
+// Terminates an indefinite-length array or map
+constexpr uint8_t BREAK = 0xff;
+
+// Nesting deeper than this is rejected while skipping unknown values
+constexpr unsigned MAX_DEPTH = 16;
+
+// Writes into a caller buffer; throws std::runtime_error if it is too small
+class Writer {
+public:
+    Writer(uint8_t* buffer, size_t capacity) : out(buffer), end(buffer + capacity), start(buffer) {}
+
+    // Size of the head of an item with this argument
+    static size_t headSize(uint64_t value) {
+        return value < 24 ? 1 : value <= 0xff ? 2 : value <= 0xffff ? 3 : value <= 0xffffffff ? 5 : 9;
+    }
+
+    void head(Major major, uint64_t value) {
+        const size_t size = headSize(value);
+        uint8_t* dst = reserve(size);
+        const uint8_t type = static_cast<uint8_t>(major << 5);
+        if (size == 1) {
+            dst[0] = static_cast<uint8_t>(type | value);
+            return;
+        }
+        dst[0] = static_cast<uint8_t>(type | (size == 2 ? 24 : size == 3 ? 25 : size == 5 ? 26 : 27));
+        for (size_t i = 1; i < size; i++) {
+            dst[i] = static_cast<uint8_t>(value >> (8 * (size - 1 - i)));
+        }
+    }
+
+    void indefinite(Major major) {
+        *reserve(1) = static_cast<uint8_t>(major << 5 | 31);
+    }
+
+    void endIndefinite() {
+        *reserve(1) = BREAK;
+    }
+
+    void bytes(const uint8_t* data, size_t size) {
+        head(BYTES, size);
+        std::memcpy(reserve(size), data, size);
+    }
+
+    void text(const char* data, size_t size) {
+        head(TEXT, size);
+        std::memcpy(reserve(size), data, size);
+    }
+
+    // One-character text string, the form of every key in the token
+    void key(char k) {
+        uint8_t* dst = reserve(2);
+        dst[0] = static_cast<uint8_t>(TEXT << 5 | 1);
+        dst[1] = static_cast<uint8_t>(k);
+    }
+
+    // Room for size bytes at the current position, which the caller fills
+    uint8_t* reserve(size_t size) {
+        if (static_cast<size_t>(end - out) < size) {
+            throw std::runtime_error("Token buffer too small");
+        }
+        uint8_t* dst = out;
+        out += size;
+        return dst;
+    }
+
+    size_t written() const {
+        return static_cast<size_t>(out - start);
+    }
+
+private:
+    uint8_t* out;
+    uint8_t* end;
+    uint8_t* start;
+};
+
+// Reads in place from a buffer; throws std::invalid_argument on truncated
+// or unsupported input
+class Reader {
+public:
+    struct Head {
+        Major major;
+        uint64_t value;   // Integer, string length or item count
+        bool indefinite;  // Array or map terminated by BREAK
+    };
+
+    Reader(const uint8_t* data, size_t size) : ptr(data), end(data + size) {}
+
+    bool atEnd() const {
+        return ptr == end;
+    }
+
+    // Consumes a BREAK if one is next
+    bool consumeBreak() {
+        if (ptr != end && *ptr == BREAK) {
+            ptr++;
+            return true;
+        }
+        return false;
+    }
+
+    Head head() {
+        const uint8_t initial = take(1)[0];
+        const Major major = static_cast<Major>(initial >> 5);
+        const uint8_t info = initial & 0x1f;
+        if (major != UNSIGNED && major != BYTES && major != TEXT && major != ARRAY && major != MAP) {
+            throw std::invalid_argument("Unsupported CBOR item");
+        }
+        if (info == 31) {
+            if (major != ARRAY && major != MAP) {
+                throw std::invalid_argument("Unsupported CBOR item");
+            }
+            return {major, 0, true};
+        }
+        if (info < 24) {
+            return {major, info, false};
+        }
+        if (info > 27) {
+            throw std::invalid_argument("Malformed CBOR item");
+        }
+        const size_t size = size_t(1) << (info - 24);
+        const uint8_t* src = take(size);
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++) {
+            value = (value << 8) | src[i];
+        }
+        return {major, value, false};
+    }
+
+    Head expect(Major major) {
+        const Head h = head();
+        if (h.major != major) {
+            throw std::invalid_argument("Unexpected CBOR item");
+        }
+        return h;
+    }
+
+    uint64_t unsignedInt() {
+        return expect(UNSIGNED).value;
+    }
+
+    // Contents of a byte or text string, pointing into the input
+    const uint8_t* string(Major major, size_t& size) {
+        const Head h = expect(major);
+        if (h.value > static_cast<uint64_t>(end - ptr)) {
+            throw std::invalid_argument("Truncated CBOR item");
+        }
+        size = static_cast<size_t>(h.value);
+        return take(size);
+    }
+
+    // One-character text key; longer keys come back as 0
+    char key() {
+        size_t size = 0;
+        const uint8_t* k = string(TEXT, size);
+        return size == 1 ? static_cast<char>(k[0]) : 0;
+    }
+
+    void skip(unsigned depth = 0) {
+        if (depth > MAX_DEPTH) {
+            throw std::invalid_argument("CBOR nesting too deep");
+        }
+        const Head h = head();
+        switch (h.major) {
+        case BYTES:
+        case TEXT:
+            if (h.value > static_cast<uint64_t>(end - ptr)) {
+                throw std::invalid_argument("Truncated CBOR item");
+            }
+            ptr += h.value;
+            break;
+        case ARRAY:
+        case MAP: {
+            const uint64_t per_entry = h.major == MAP ? 2 : 1;
+            if (h.indefinite) {
+                while (!consumeBreak()) {
+                    for (uint64_t k = 0; k < per_entry; k++) {
+                        skip(depth + 1);
+                    }
+                }
+            } else {
+                for (uint64_t i = 0; i < h.value; i++) {
+                    for (uint64_t k = 0; k < per_entry; k++) {
+                        skip(depth + 1);
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    const uint8_t* position() const {
+        return ptr;
+    }
+
+    void seek(const uint8_t* position) {
+        ptr = position;
+    }
+
+private:
+    const uint8_t* ptr;
+    const uint8_t* end;
+
+    const uint8_t* take(size_t size) {
+        if (static_cast<size_t>(end - ptr) < size) {
+            throw std::invalid_argument("Truncated CBOR item");
+        }
+        const uint8_t* src = ptr;
+        ptr += size;
+        return src;
+    }
+};
+
+} // namespace cbor
+
+#endif // CBOR_H
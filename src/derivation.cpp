@@ -0,0 +1,61 @@
+#include <derivation.h>
+#include "primitives.h"
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr uint8_t DOMAIN_SECRET = 0x01;
+static constexpr uint8_t DOMAIN_BLINDING = 0x02;
+
+std::string keysetIdToHex(const KeysetId& id) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * id.size());
+    for (uint8_t byte : id) {
+        hex.push_back(digits[byte >> 4]);
+        hex.push_back(digits[byte & 0x0f]);
+    }
+    return hex;
+}
+
+SeedDerivation::SeedDerivation(const std::vector<uint8_t>& wallet_seed, const KeysetId& keyset)
+    : seed(wallet_seed), keyset_id(keyset)
+{
+    if (wallet_seed.size() < MIN_SEED_SIZE) {
+        throw std::invalid_argument("Wallet seed must be at least " + std::to_string(MIN_SEED_SIZE) + " bytes");
+    }
+}
+
+std::vector<uint8_t> SeedDerivation::xofInput(uint8_t domain, uint64_t counter) const {
+    std::vector<uint8_t> input(1 + keyset_id.size() + 8 + seed.size());
+    uint8_t* p = input.data();
+    *p++ = domain;
+    p = std::copy(keyset_id.begin(), keyset_id.end(), p);
+    for (int i = 0; i < 8; i++) {
+        *p++ = static_cast<uint8_t>(counter >> (8 * i));
+    }
+    std::copy(seed.begin(), seed.end(), p);
+    return input;
+}
+
+std::vector<uint8_t> SeedDerivation::secret(uint64_t counter) const {
+    std::vector<uint8_t> out(SECRET_SIZE);
+    shake256(xofInput(DOMAIN_SECRET, counter), out.data(), out.size());
+    return out;
+}
+
+SmallPolynomial SeedDerivation::blindingFactor(uint64_t counter, const ParameterSet& params) const {
+    std::vector<uint8_t> stream(params.n * sizeof(uint64_t));
+    shake256(xofInput(DOMAIN_BLINDING, counter), stream.data(), stream.size());
+
+    // Assemble the words explicitly so the result does not depend on the
+    // host byte order
+    std::vector<uint64_t> words(params.n);
+    for (size_t i = 0; i < params.n; i++) {
+        uint64_t w = 0;
+        for (int b = 7; b >= 0; b--) {
+            w = (w << 8) | stream[8 * i + b];
+        }
+        words[i] = w;
+    }
+    return SmallPolynomial::sampleGaussian(words.data(), params);
+}
@@ -0,0 +1,153 @@
+#include <keyset.h>
+#include <ntt.h>
+#include <sha256.h>
+#include "primitives.h"
+#include <algorithm>
+#include <stdexcept>
+
+KeysetId computeKeysetId(const Polynomial& a, const Polynomial& b) {
+    // n, q and every coefficient of a and b as little-endian 64-bit words
+    std::vector<uint8_t> encoding((2 + a.degree() + b.degree()) * sizeof(uint64_t));
+    uint8_t* p = encoding.data();
+    auto put = [&p](uint64_t v) {
+        for (int i = 0; i < 8; i++) {
+            *p++ = static_cast<uint8_t>(v >> (8 * i));
+        }
+    };
+    put(a.degree());
+    put(a.getModulus());
+    for (uint64_t c : a.getCoeffs()) put(c);
+    for (uint64_t c : b.getCoeffs()) put(c);
+
+    std::vector<uint8_t> digest = SHA256::hash(encoding);
+    KeysetId id;
+    std::copy(digest.begin(), digest.begin() + id.size(), id.begin());
+    return id;
+}
+
+PreparedKeyset::PreparedKeyset(const Polynomial& public_a, const Polynomial& public_b)
+    : a(public_a), b(public_b), keyset_id{}, params(nullptr)
+{
+    if (a.degree() != b.degree() || a.getModulus() != b.getModulus()) {
+        throw std::invalid_argument("Public key polynomials must be in the same ring");
+    }
+    keyset_id = computeKeysetId(a, b);
+    params = &ParameterSet::get(a.degree(), a.getModulus());
+
+    if (NTT::isSupported(*params)) {
+        const size_t n = params->n;
+        const uint64_t q = params->q;
+        a_hat.resize(n);
+        b_hat.resize(n);
+        const CoeffView ca = a.getCoeffs();
+        const CoeffView cb = b.getCoeffs();
+        for (size_t i = 0; i < n; i++) {
+            a_hat[i] = ca[i] % q;
+            b_hat[i] = cb[i] % q;
+        }
+        NTT::forward(a_hat.data(), *params);
+        NTT::forward(b_hat.data(), *params);
+    }
+}
+
+void PreparedKeyset::checkFactors(const std::vector<SmallPolynomial>& factors, size_t count) const {
+    if (factors.size() != count) {
+        throw std::invalid_argument("Number of blinding factors must match the number of outputs");
+    }
+    for (const auto& r : factors) {
+        if (r.degree() != params->n || r.getModulus() != params->q) {
+            throw std::invalid_argument("Blinding factor must be in the keyset's ring");
+        }
+    }
+}
+
+void PreparedKeyset::multiplyFactors(PolynomialBatch& out, const std::vector<SmallPolynomial>& factors,
+                                     const Polynomial& operand, const std::vector<uint64_t>& operand_hat) const {
+    if (operand_hat.empty()) {
+        for (size_t k = 0; k < factors.size(); k++) {
+            Polynomial product = factors[k].multiply(operand);
+            std::copy(product.getCoeffs().begin(), product.getCoeffs().end(), out.row(k));
+        }
+        return;
+    }
+
+    std::vector<uint64_t*> rows(factors.size());
+    for (size_t k = 0; k < factors.size(); k++) {
+        rows[k] = out.row(k);
+        factors[k].widen(rows[k]);
+    }
+    NTT::forwardBatch(rows.data(), rows.size(), *params);
+    for (uint64_t* row : rows) {
+        NTT::pointwise(row, row, operand_hat.data(), *params);
+    }
+    NTT::inverseBatch(rows.data(), rows.size(), *params);
+}
+
+PolynomialBatch PreparedKeyset::blind(const std::vector<std::vector<uint8_t>>& secrets,
+                                      const std::vector<SmallPolynomial>& factors) const {
+    checkFactors(factors, secrets.size());
+    const size_t n = params->n;
+    const uint64_t q = params->q;
+
+    PolynomialBatch result(secrets.size(), n, q);
+    multiplyFactors(result, factors, a, a_hat);
+
+    std::vector<uint64_t> Y(n);
+    for (size_t k = 0; k < secrets.size(); k++) {
+        hashToCoefficients(Y.data(), n, q, secrets[k]);
+        uint64_t* out = result.row(k);
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t sum = out[i] + Y[i];
+            out[i] = sum >= q ? sum - q : sum;
+        }
+    }
+    return result;
+}
+
+PolynomialBatch PreparedKeyset::unblind(const std::vector<Polynomial>& blindSignatures,
+                                        const std::vector<SmallPolynomial>& factors) const {
+    checkFactors(factors, blindSignatures.size());
+    const size_t n = params->n;
+    const uint64_t q = params->q;
+    for (const auto& c : blindSignatures) {
+        if (c.degree() != n || c.getModulus() != q) {
+            throw std::invalid_argument("Blind signature must be in the keyset's ring");
+        }
+    }
+
+    PolynomialBatch result(blindSignatures.size(), n, q);
+    multiplyFactors(result, factors, b, b_hat);
+
+    for (size_t k = 0; k < blindSignatures.size(); k++) {
+        const CoeffView c = blindSignatures[k].getCoeffs();
+        uint64_t* out = result.row(k);
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t ci = c[i] < q ? c[i] : c[i] % q;
+            out[i] = ci >= out[i] ? ci - out[i] : ci + q - out[i];
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<const PreparedKeyset> KeysetCache::find(const KeysetId& id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = keysets.find(id);
+    return it == keysets.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<const PreparedKeyset> KeysetCache::add(const Polynomial& a, const Polynomial& b) {
+    const KeysetId id = computeKeysetId(a, b);
+    if (auto cached = find(id)) {
+        return cached;
+    }
+
+    // Prepare outside the lock; if another thread won the race keep its entry
+    auto prepared = std::make_shared<const PreparedKeyset>(a, b);
+    std::lock_guard<std::mutex> lock(mutex);
+    return keysets.emplace(id, std::move(prepared)).first->second;
+}
+
+size_t KeysetCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keysets.size();
+}
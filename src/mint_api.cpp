@@ -0,0 +1,500 @@
+#include <mint_api.h>
+#include <polynomial_codec.h>
+#include <text_codec.h>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Nesting deeper than this is rejected while skipping unknown values
+constexpr unsigned MAX_DEPTH = 16;
+
+// Pull scanner over JSON text (RFC 8259). Strings come back as views of
+// the text unless their escapes are resolved into a caller string.
+// Throws std::invalid_argument on malformed input.
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text) : ptr(text.data()), end(text.data() + text.size()) {}
+
+    bool atEnd() {
+        skipSpace();
+        return ptr == end;
+    }
+
+    // Consumes c if it is the next character after whitespace
+    bool consume(char c) {
+        skipSpace();
+        if (ptr != end && *ptr == c) {
+            ptr++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            throw std::invalid_argument(std::string("Expected '") + c + "' in JSON");
+        }
+    }
+
+    // After the opening bracket of an object or array: whether it has a
+    // first member, consuming the closing bracket if not
+    bool first(char close) {
+        return !consume(close);
+    }
+
+    // After a member: whether another follows, consuming the comma or the
+    // closing bracket
+    bool more(char close) {
+        if (consume(',')) {
+            return true;
+        }
+        expect(close);
+        return false;
+    }
+
+    // Contents of the next string as written, escapes unresolved and
+    // characters unchecked
+    std::string_view rawString() {
+        expect('"');
+        const char* start = ptr;
+        while (true) {
+            const char* quote = static_cast<const char*>(std::memchr(ptr, '"', static_cast<size_t>(end - ptr)));
+            if (quote == nullptr) {
+                throw std::invalid_argument("Unterminated JSON string");
+            }
+            // The quote is escaped if an odd number of backslashes precede it
+            size_t slashes = 0;
+            while (quote - slashes > start && quote[-1 - static_cast<ptrdiff_t>(slashes)] == '\\') {
+                slashes++;
+            }
+            ptr = quote + 1;
+            if (slashes % 2 == 0) {
+                return std::string_view(start, static_cast<size_t>(quote - start));
+            }
+        }
+    }
+
+    // Appends the next string to out with its escapes resolved
+    void string(std::string& out) {
+        const std::string_view raw = rawString();
+        size_t run = 0;
+        for (size_t i = 0; i < raw.size(); i++) {
+            const unsigned char c = static_cast<unsigned char>(raw[i]);
+            if (c < 0x20) {
+                throw std::invalid_argument("Control character in JSON string");
+            }
+            if (c != '\\') {
+                continue;
+            }
+            out.append(raw.data() + run, i - run);
+            i = unescape(raw, i + 1, out);
+            run = i + 1;
+        }
+        out.append(raw.data() + run, raw.size() - run);
+    }
+
+    // Member name, followed by its colon
+    std::string_view key() {
+        const std::string_view k = rawString();
+        expect(':');
+        return k;
+    }
+
+    uint64_t unsignedInt() {
+        skipSpace();
+        uint64_t value = 0;
+        const std::from_chars_result result = std::from_chars(ptr, end, value);
+        // from_chars takes leading zeros, which JSON does not, and stops
+        // before a fraction or exponent
+        if (result.ec != std::errc() || (*ptr == '0' && result.ptr - ptr > 1) ||
+            (result.ptr != end && (*result.ptr == '.' || *result.ptr == 'e' || *result.ptr == 'E'))) {
+            throw std::invalid_argument("Expected a non-negative integer in JSON");
+        }
+        ptr = result.ptr;
+        return value;
+    }
+
+    void skip(unsigned depth = 0) {
+        if (depth > MAX_DEPTH) {
+            throw std::invalid_argument("JSON nesting too deep");
+        }
+        skipSpace();
+        if (ptr == end) {
+            throw std::invalid_argument("Truncated JSON");
+        }
+        switch (*ptr) {
+        case '"':
+            rawString();
+            break;
+        case '{':
+            ptr++;
+            for (bool member = first('}'); member; member = more('}')) {
+                key();
+                skip(depth + 1);
+            }
+            break;
+        case '[':
+            ptr++;
+            for (bool item = first(']'); item; item = more(']')) {
+                skip(depth + 1);
+            }
+            break;
+        case 't':
+            literal("true");
+            break;
+        case 'f':
+            literal("false");
+            break;
+        case 'n':
+            literal("null");
+            break;
+        default:
+            number();
+            break;
+        }
+    }
+
+private:
+    const char* ptr;
+    const char* end;
+
+    void skipSpace() {
+        while (ptr != end && (*ptr == ' ' || *ptr == '\n' || *ptr == '\r' || *ptr == '\t')) {
+            ptr++;
+        }
+    }
+
+    void literal(const char* word) {
+        const size_t size = std::strlen(word);
+        if (static_cast<size_t>(end - ptr) < size || std::memcmp(ptr, word, size) != 0) {
+            throw std::invalid_argument("Invalid JSON literal");
+        }
+        ptr += size;
+    }
+
+    // Consumes one or more digits
+    void digits() {
+        if (ptr == end || *ptr < '0' || *ptr > '9') {
+            throw std::invalid_argument("Invalid JSON number");
+        }
+        while (ptr != end && *ptr >= '0' && *ptr <= '9') {
+            ptr++;
+        }
+    }
+
+    void number() {
+        if (*ptr == '-') {
+            ptr++;
+        }
+        if (ptr != end && *ptr == '0') {
+            ptr++;
+        } else {
+            digits();
+        }
+        if (ptr != end && *ptr == '.') {
+            ptr++;
+            digits();
+        }
+        if (ptr != end && (*ptr == 'e' || *ptr == 'E')) {
+            ptr++;
+            if (ptr != end && (*ptr == '+' || *ptr == '-')) {
+                ptr++;
+            }
+            digits();
+        }
+    }
+
+    static unsigned hex4(std::string_view raw, size_t pos) {
+        if (raw.size() - pos < 4) {
+            throw std::invalid_argument("Truncated JSON escape");
+        }
+        uint8_t bytes[2];
+        hexDecode(raw.data() + pos, 4, bytes);
+        return unsigned(bytes[0]) << 8 | bytes[1];
+    }
+
+    // Resolves the escape whose letter is at raw[pos] and returns the
+    // position of its last character
+    static size_t unescape(std::string_view raw, size_t pos, std::string& out) {
+        if (pos == raw.size()) {
+            throw std::invalid_argument("Truncated JSON escape");
+        }
+        switch (raw[pos]) {
+        case '"':
+        case '\\':
+        case '/':
+            out.push_back(raw[pos]);
+            return pos;
+        case 'b':
+            out.push_back('\b');
+            return pos;
+        case 'f':
+            out.push_back('\f');
+            return pos;
+        case 'n':
+            out.push_back('\n');
+            return pos;
+        case 'r':
+            out.push_back('\r');
+            return pos;
+        case 't':
+            out.push_back('\t');
+            return pos;
+        case 'u':
+            break;
+        default:
+            throw std::invalid_argument("Invalid JSON escape");
+        }
+
+        // \uXXXX, with characters outside the basic plane as a pair of
+        // surrogates, written out as UTF-8
+        uint32_t code = hex4(raw, pos + 1);
+        pos += 4;
+        if (code >= 0xdc00 && code <= 0xdfff) {
+            throw std::invalid_argument("Unpaired surrogate in JSON string");
+        }
+        if (code >= 0xd800 && code <= 0xdbff) {
+            if (raw.size() - pos < 3 || raw[pos + 1] != '\\' || raw[pos + 2] != 'u') {
+                throw std::invalid_argument("Unpaired surrogate in JSON string");
+            }
+            const uint32_t low = hex4(raw, pos + 3);
+            if (low < 0xdc00 || low > 0xdfff) {
+                throw std::invalid_argument("Unpaired surrogate in JSON string");
+            }
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            pos += 6;
+        }
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | code >> 6));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | code >> 12));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | code >> 18));
+            out.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        return pos;
+    }
+};
+
+// Fields of an entry, and of a body, as bits of a set
+enum Field : unsigned {
+    AMOUNT = 1,
+    KEYSET = 2,
+    SECRET = 4,
+    POLYNOMIAL = 8,
+    QUOTE = 16,
+    INPUTS = 32,
+    OUTPUTS = 64,
+};
+
+// Adds field to the set of those read, rejecting repeats
+void markRead(unsigned& fields, unsigned field) {
+    if (fields & field) {
+        throw std::invalid_argument("Duplicate key in JSON object");
+    }
+    fields |= field;
+}
+
+// Reads an array of entries whose polynomial is under polynomial_key
+void readEntries(JsonReader& r, EntryBatch& entries, std::string_view polynomial_key, bool with_secret) {
+    PolynomialBatch& polys = entries.polynomials;
+    const unsigned required = AMOUNT | KEYSET | POLYNOMIAL | (with_secret ? unsigned(SECRET) : 0u);
+    r.expect('[');
+    for (bool item = r.first(']'); item; item = r.more(']')) {
+        const size_t k = entries.add(0, KeysetId{});
+        unsigned fields = 0;
+        r.expect('{');
+        for (bool member = r.first('}'); member; member = r.more('}')) {
+            const std::string_view key = r.key();
+            if (key == "amount") {
+                markRead(fields, AMOUNT);
+                entries.amounts[k] = r.unsignedInt();
+            } else if (key == "id") {
+                markRead(fields, KEYSET);
+                const std::string_view hex = r.rawString();
+                if (hex.size() != hexEncodedSize(entries.keysets[k].size())) {
+                    throw std::invalid_argument("Keyset ID must be 16 hex digits");
+                }
+                hexDecode(hex.data(), hex.size(), entries.keysets[k].data());
+            } else if (with_secret && key == "secret") {
+                // Entry k is the last, so its secret ends the buffer
+                markRead(fields, SECRET);
+                r.string(entries.secrets);
+                entries.secret_ends[k] = entries.secrets.size();
+            } else if (key == polynomial_key) {
+                markRead(fields, POLYNOMIAL);
+                const std::string_view text = r.rawString();
+                decodeCoefficientsBase64url(text.data(), text.size(), polys.degree(), polys.getModulus(), polys.row(k));
+            } else {
+                r.skip();
+            }
+        }
+        if (fields != required) {
+            throw std::invalid_argument("JSON entry lacks an amount, keyset ID, secret or polynomial");
+        }
+    }
+}
+
+void appendUnsigned(uint64_t value, std::string& out) {
+    char digits[20];
+    const std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+// s as a JSON string, escaping only what must be escaped
+void appendString(std::string_view s, std::string& out) {
+    static const char HEX[] = "0123456789abcdef";
+    out.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < s.size(); i++) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        out.push_back('\\');
+        switch (c) {
+        case '"':
+        case '\\':
+            out.push_back(static_cast<char>(c));
+            break;
+        case '\n':
+            out.push_back('n');
+            break;
+        case '\r':
+            out.push_back('r');
+            break;
+        case '\t':
+            out.push_back('t');
+            break;
+        default:
+            out.append("u00");
+            out.push_back(HEX[c >> 4]);
+            out.push_back(HEX[c & 0xf]);
+            break;
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+    out.push_back('"');
+}
+
+// Upper bound on what writeEntries() appends, so that the output grows at
+// most once per body
+size_t entriesSize(const EntryBatch& entries) {
+    const PolynomialBatch& polys = entries.polynomials;
+    const size_t polynomial = base64urlEncodedSize(packedSize(polys.degree(), polys.getModulus()));
+    // Keys and punctuation, 20 amount digits and 16 of keyset ID per entry;
+    // an escaped secret is at most six times as long
+    return 2 + entries.size() * (64 + 20 + 16 + polynomial) + 6 * entries.secrets.size();
+}
+
+void writeEntries(const EntryBatch& entries, const char* polynomial_key, bool with_secret, std::string& out) {
+    const PolynomialBatch& polys = entries.polynomials;
+    out.push_back('[');
+    for (size_t k = 0; k < entries.size(); k++) {
+        out.append(k == 0 ? "{\"amount\":" : ",{\"amount\":");
+        appendUnsigned(entries.amounts[k], out);
+        out.append(",\"id\":\"");
+        const size_t start = out.size();
+        out.resize(start + hexEncodedSize(entries.keysets[k].size()));
+        hexEncode(entries.keysets[k].data(), entries.keysets[k].size(), &out[start]);
+        out.push_back('"');
+        if (with_secret) {
+            out.append(",\"secret\":");
+            appendString(entries.secret(k), out);
+        }
+        out.append(",\"");
+        out.append(polynomial_key);
+        out.append("\":\"");
+        appendCoefficientsBase64url(polys.row(k), polys.degree(), polys.getModulus(), out);
+        out.append("\"}");
+    }
+    out.push_back(']');
+}
+
+} // namespace
+
+void readMintRequest(std::string_view json, MintRequest& request) {
+    request.clear();
+    JsonReader r(json);
+    unsigned fields = 0;
+    r.expect('{');
+    for (bool member = r.first('}'); member; member = r.more('}')) {
+        const std::string_view key = r.key();
+        if (key == "quote") {
+            markRead(fields, QUOTE);
+            r.string(request.quote);
+        } else if (key == "inputs") {
+            markRead(fields, INPUTS);
+            readEntries(r, request.inputs, "C", true);
+        } else if (key == "outputs") {
+            markRead(fields, OUTPUTS);
+            readEntries(r, request.outputs, "B_", false);
+        } else {
+            r.skip();
+        }
+    }
+    if (!r.atEnd()) {
+        throw std::invalid_argument("Trailing characters after JSON body");
+    }
+    if ((fields & (INPUTS | OUTPUTS)) == 0) {
+        throw std::invalid_argument("Request has neither inputs nor outputs");
+    }
+}
+
+void writeMintRequest(const MintRequest& request, std::string& out) {
+    out.reserve(out.size() + 40 + 6 * request.quote.size() + entriesSize(request.inputs) +
+                entriesSize(request.outputs));
+    out.push_back('{');
+    if (!request.quote.empty()) {
+        out.append("\"quote\":");
+        appendString(request.quote, out);
+        out.push_back(',');
+    }
+    if (request.inputs.size() > 0) {
+        out.append("\"inputs\":");
+        writeEntries(request.inputs, "C", true, out);
+        out.push_back(',');
+    }
+    out.append("\"outputs\":");
+    writeEntries(request.outputs, "B_", false, out);
+    out.push_back('}');
+}
+
+void readSignatures(std::string_view json, EntryBatch& signatures) {
+    signatures.clear();
+    JsonReader r(json);
+    unsigned fields = 0;
+    r.expect('{');
+    for (bool member = r.first('}'); member; member = r.more('}')) {
+        if (r.key() == "signatures") {
+            markRead(fields, OUTPUTS);
+            readEntries(r, signatures, "C_", false);
+        } else {
+            r.skip();
+        }
+    }
+    if (!r.atEnd()) {
+        throw std::invalid_argument("Trailing characters after JSON body");
+    }
+    if (fields == 0) {
+        throw std::invalid_argument("Response has no signatures");
+    }
+}
+
+void writeSignatures(const EntryBatch& signatures, std::string& out) {
+    out.reserve(out.size() + 16 + entriesSize(signatures));
+    out.append("{\"signatures\":");
+    writeEntries(signatures, "C_", false, out);
+    out.push_back('}');
+}
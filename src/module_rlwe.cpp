@@ -0,0 +1,155 @@
+#include <module_rlwe.h>
+#include <logging.h>
+#include <sampler.h>
+#include "primitives.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Checked before the ring's tables are looked up, which caches them
+static const ParameterSet& ringParams(size_t n, uint64_t q) {
+    if (n == 0 || (n & (n - 1)) != 0) {
+        throw std::invalid_argument("n must be a power of 2");
+    }
+    return ParameterSet::get(n, q);
+}
+
+ModuleRLWESignature::ModuleRLWESignature(size_t k, size_t n, uint64_t q)
+    : rank_k(k),
+      params(&ringParams(n, q)),
+      validator(*params)
+{
+    if (k == 0 || k > 256) {
+        throw std::invalid_argument("Module rank must be between 1 and 256");
+    }
+    A.assign(k, PolyVector(k, Polynomial(n, q)));
+    b.assign(k, Polynomial(n, q));
+    s.assign(k, Polynomial(n, q));
+
+    Logger::log("Created module RLWE instance with k=" + std::to_string(k) +
+                ", n=" + std::to_string(n) + ", q=" + std::to_string(q));
+}
+
+ModuleRLWESignature::ModuleRLWESignature(size_t k, ParameterPreset preset)
+    : ModuleRLWESignature(k, ParameterSet::fromPreset(preset).n, ParameterSet::fromPreset(preset).q)
+{
+}
+
+Polynomial ModuleRLWESignature::sampleUniform() const {
+    std::vector<uint64_t> coeffs(params->n);
+    getSecureRandomBytes(reinterpret_cast<uint8_t*>(coeffs.data()), coeffs.size() * sizeof(uint64_t));
+    for (auto& c : coeffs) {
+        c %= params->q;
+    }
+    return Polynomial(coeffs, params->q);
+}
+
+Polynomial ModuleRLWESignature::sampleGaussian() const {
+    std::vector<uint64_t> words(params->n);
+    std::vector<uint64_t> coeffs(params->n);
+    getSecureRandomBytes(reinterpret_cast<uint8_t*>(words.data()), words.size() * sizeof(uint64_t));
+    GaussianSampler::sample(coeffs.data(), words.data(), params->n, *params);
+    return Polynomial(coeffs, params->q);
+}
+
+ModuleRLWESignature::PolyVector ModuleRLWESignature::sampleGaussianVector() const {
+    PolyVector v;
+    v.reserve(rank_k);
+    for (size_t i = 0; i < rank_k; i++) {
+        v.push_back(sampleGaussian());
+    }
+    return v;
+}
+
+void ModuleRLWESignature::checkVector(const PolyVector& v) const {
+    if (v.size() != rank_k) {
+        throw std::invalid_argument("Vector length must equal the module rank");
+    }
+    for (const auto& p : v) {
+        if (p.degree() != params->n || p.getModulus() != params->q) {
+            throw std::invalid_argument("Polynomials must be in the module's ring");
+        }
+    }
+}
+
+void ModuleRLWESignature::generateKeys() {
+    Logger::log("\nGenerating module keys...");
+    for (auto& row : A) {
+        for (auto& entry : row) {
+            entry = sampleUniform();
+        }
+    }
+    s = sampleGaussianVector();
+    PolyVector e = sampleGaussianVector();
+
+    // b_j = <column j of A, s> + e_j
+    for (size_t j = 0; j < rank_k; j++) {
+        PolyVector column;
+        column.reserve(rank_k);
+        for (size_t i = 0; i < rank_k; i++) {
+            column.push_back(A[i][j]);
+        }
+        b[j] = Polynomial::dot(column, s) + e[j];
+    }
+    Logger::log("Module keys generated");
+}
+
+ModuleRLWESignature::PolyVector ModuleRLWESignature::hashToPolynomials(const std::vector<uint8_t>& message) const {
+    // Component i hashes the index byte followed by the message, so the
+    // components are independent and no two (i, message) pairs collide
+    std::vector<uint8_t> input(1 + message.size());
+    std::copy(message.begin(), message.end(), input.begin() + 1);
+
+    PolyVector Y;
+    Y.reserve(rank_k);
+    std::vector<uint64_t> coeffs(params->n);
+    for (size_t i = 0; i < rank_k; i++) {
+        input[0] = static_cast<uint8_t>(i);
+        hashToCoefficients(coeffs.data(), params->n, params->q, input);
+        Y.emplace_back(coeffs, params->q);
+    }
+    return Y;
+}
+
+std::pair<ModuleRLWESignature::PolyVector, ModuleRLWESignature::PolyVector>
+ModuleRLWESignature::computeBlindedMessage(const std::vector<uint8_t>& secret) {
+    Logger::log("\nComputing module blinded message...");
+    PolyVector r = sampleGaussianVector();
+    PolyVector B = hashToPolynomials(secret);
+
+    // B_i = Y_i + sum_j A_ij r_j
+    for (size_t i = 0; i < rank_k; i++) {
+        B[i] = B[i] + Polynomial::dot(A[i], r);
+    }
+    return std::make_pair(B, r);
+}
+
+Polynomial ModuleRLWESignature::blindSign(const PolyVector& blindedMessage) {
+    Logger::log("\nPerforming module blind signing...");
+    if (blindedMessage.size() != rank_k) {
+        throw std::invalid_argument("Vector length must equal the module rank");
+    }
+    for (const auto& component : blindedMessage) {
+        validator.validate(component);
+    }
+    return Polynomial::dot(s, blindedMessage) + sampleGaussian();
+}
+
+Polynomial ModuleRLWESignature::computeSignature(const Polynomial& blindSignature,
+                                                 const PolyVector& blindingFactor,
+                                                 const PolyVector& publicKey) const {
+    checkVector(blindingFactor);
+    checkVector(publicKey);
+    return blindSignature - Polynomial::dot(blindingFactor, publicKey);
+}
+
+bool ModuleRLWESignature::verify(const std::vector<uint8_t>& secret, const Polynomial& signature) {
+    Logger::log("\nVerifying module signature...");
+    if (signature.degree() != params->n || signature.getModulus() != params->q) {
+        return false;
+    }
+    Polynomial expected = Polynomial::dot(s, hashToPolynomials(secret));
+    bool result = signature.polySignal().getCoeffs() == expected.polySignal().getCoeffs();
+    Logger::log(result ? "Verification result: SUCCESS" : "Verification result: FAILED");
+    return result;
+}
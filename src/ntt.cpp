@@ -0,0 +1,299 @@
+#include <ntt.h>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// High 64 bits of the 128-bit product a * b
+static inline uint64_t mulHigh64(uint64_t a, uint64_t b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    _umul128(a, b, &high);
+    return high;
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    return __umulh(a, b);
+#elif defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128_t;
+    return static_cast<uint64_t>((static_cast<uint128_t>(a) * b) >> 64);
+#else
+    // Schoolbook on 32-bit halves
+    const uint64_t a_lo = a & 0xffffffffu, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xffffffffu, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo;
+    const uint64_t hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+    return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+// Shoup multiplication: a * w mod q using the precomputed w' = floor(w * 2^32 / q).
+// Valid for a < 2^32 and w < q < 2^31.
+static inline uint64_t mulShoup(uint64_t a, uint64_t w, uint64_t w_shoup, uint64_t q) {
+    uint64_t t = (a * w_shoup) >> 32;
+    uint64_t r = a * w - t * q;
+    return r >= q ? r - q : r;
+}
+
+uint64_t NTT::reduce(uint64_t x, const ParameterSet& params) {
+    uint64_t t = mulHigh64(x, params.barrett);
+    uint64_t r = x - t * params.q;
+    return r >= params.q ? r - params.q : r;
+}
+
+void NTT::forward(uint64_t* a, const ParameterSet& params) {
+    const size_t n = params.n;
+    const uint64_t q = params.q;
+
+    // Cooley-Tukey butterflies, natural order in, bit-reversed order out
+    size_t t = n;
+    for (size_t m = 1; m < n; m <<= 1) {
+        t >>= 1;
+        for (size_t i = 0; i < m; i++) {
+            const size_t j1 = 2 * i * t;
+            const uint64_t w = params.psi_rev[m + i];
+            const uint64_t w_shoup = params.psi_rev_shoup[m + i];
+            for (size_t j = j1; j < j1 + t; j++) {
+                uint64_t u = a[j];
+                uint64_t v = mulShoup(a[j + t], w, w_shoup, q);
+                uint64_t sum = u + v;
+                uint64_t diff = u + q - v;
+                a[j] = sum >= q ? sum - q : sum;
+                a[j + t] = diff >= q ? diff - q : diff;
+            }
+        }
+    }
+}
+
+void NTT::inverse(uint64_t* a, const ParameterSet& params) {
+    const size_t n = params.n;
+    const uint64_t q = params.q;
+
+    // Gentleman-Sande butterflies, bit-reversed order in, natural order out
+    size_t t = 1;
+    for (size_t m = n; m > 1; m >>= 1) {
+        const size_t h = m >> 1;
+        size_t j1 = 0;
+        for (size_t i = 0; i < h; i++) {
+            const uint64_t w = params.psi_inv_rev[h + i];
+            const uint64_t w_shoup = params.psi_inv_rev_shoup[h + i];
+            for (size_t j = j1; j < j1 + t; j++) {
+                uint64_t u = a[j];
+                uint64_t v = a[j + t];
+                uint64_t sum = u + v;
+                uint64_t diff = u + q - v;
+                a[j] = sum >= q ? sum - q : sum;
+                a[j + t] = mulShoup(diff >= q ? diff - q : diff, w, w_shoup, q);
+            }
+            j1 += 2 * t;
+        }
+        t <<= 1;
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        a[j] = mulShoup(a[j], params.n_inv, params.n_inv_shoup, q);
+    }
+}
+
+// Cooley-Tukey butterfly with fully reduced inputs and outputs
+static inline void forwardButterfly(uint64_t& x, uint64_t& y, uint64_t w, uint64_t w_shoup, uint64_t q) {
+    uint64_t u = x;
+    uint64_t v = mulShoup(y, w, w_shoup, q);
+    uint64_t sum = u + v;
+    uint64_t diff = u + q - v;
+    x = sum >= q ? sum - q : sum;
+    y = diff >= q ? diff - q : diff;
+}
+
+// Gentleman-Sande butterfly with fully reduced inputs and outputs
+static inline void inverseButterfly(uint64_t& x, uint64_t& y, uint64_t w, uint64_t w_shoup, uint64_t q) {
+    uint64_t u = x;
+    uint64_t v = y;
+    uint64_t sum = u + v;
+    uint64_t diff = u + q - v;
+    x = sum >= q ? sum - q : sum;
+    y = mulShoup(diff >= q ? diff - q : diff, w, w_shoup, q);
+}
+
+// Batched transforms: up to BATCH_LANES polynomials are interleaved
+// coefficient by coefficient, so x[j * BATCH_LANES + l] is coefficient j of
+// polynomial l. Every butterfly of the single network then applies one
+// twiddle to BATCH_LANES independent pairs, which fill the SIMD lanes even
+// at the short-stride layers where a single transform cannot.
+static constexpr size_t BATCH_LANES = 8;
+
+static void interleave(uint64_t* x, uint64_t* const* polys, size_t count, size_t n) {
+    for (size_t j = 0; j < n; j++) {
+        for (size_t l = 0; l < BATCH_LANES; l++) {
+            x[j * BATCH_LANES + l] = l < count ? polys[l][j] : 0;
+        }
+    }
+}
+
+static void deinterleave(uint64_t* const* polys, const uint64_t* x, size_t count, size_t n) {
+    for (size_t j = 0; j < n; j++) {
+        for (size_t l = 0; l < count; l++) {
+            polys[l][j] = x[j * BATCH_LANES + l];
+        }
+    }
+}
+
+static void forwardInterleaved(uint64_t* x, const ParameterSet& params) {
+    const size_t n = params.n;
+    const uint64_t q = params.q;
+    size_t t = n;
+    for (size_t m = 1; m < n; m <<= 1) {
+        t >>= 1;
+        for (size_t i = 0; i < m; i++) {
+            const uint64_t w = params.psi_rev[m + i];
+            const uint64_t w_shoup = params.psi_rev_shoup[m + i];
+            for (size_t j = 2 * i * t; j < 2 * i * t + t; j++) {
+                uint64_t* u = x + j * BATCH_LANES;
+                uint64_t* v = x + (j + t) * BATCH_LANES;
+                #pragma omp simd
+                for (size_t l = 0; l < BATCH_LANES; l++) {
+                    forwardButterfly(u[l], v[l], w, w_shoup, q);
+                }
+            }
+        }
+    }
+}
+
+static void inverseInterleaved(uint64_t* x, const ParameterSet& params) {
+    const size_t n = params.n;
+    const uint64_t q = params.q;
+    size_t t = 1;
+    for (size_t m = n; m > 1; m >>= 1) {
+        const size_t h = m >> 1;
+        for (size_t i = 0; i < h; i++) {
+            const uint64_t w = params.psi_inv_rev[h + i];
+            const uint64_t w_shoup = params.psi_inv_rev_shoup[h + i];
+            for (size_t j = 2 * i * t; j < 2 * i * t + t; j++) {
+                uint64_t* u = x + j * BATCH_LANES;
+                uint64_t* v = x + (j + t) * BATCH_LANES;
+                #pragma omp simd
+                for (size_t l = 0; l < BATCH_LANES; l++) {
+                    inverseButterfly(u[l], v[l], w, w_shoup, q);
+                }
+            }
+        }
+        t <<= 1;
+    }
+
+    #pragma omp simd
+    for (size_t k = 0; k < n * BATCH_LANES; k++) {
+        x[k] = mulShoup(x[k], params.n_inv, params.n_inv_shoup, q);
+    }
+}
+
+void NTT::forwardBatch(uint64_t* const* polys, size_t count, const ParameterSet& params) {
+    std::vector<uint64_t> x(params.n * BATCH_LANES);
+    for (size_t first = 0; first < count; first += BATCH_LANES) {
+        const size_t lanes = std::min(BATCH_LANES, count - first);
+        interleave(x.data(), polys + first, lanes, params.n);
+        forwardInterleaved(x.data(), params);
+        deinterleave(polys + first, x.data(), lanes, params.n);
+    }
+}
+
+void NTT::inverseBatch(uint64_t* const* polys, size_t count, const ParameterSet& params) {
+    std::vector<uint64_t> x(params.n * BATCH_LANES);
+    for (size_t first = 0; first < count; first += BATCH_LANES) {
+        const size_t lanes = std::min(BATCH_LANES, count - first);
+        interleave(x.data(), polys + first, lanes, params.n);
+        inverseInterleaved(x.data(), params);
+        deinterleave(polys + first, x.data(), lanes, params.n);
+    }
+}
+
+void NTT::pointwise(uint64_t* out, const uint64_t* a, const uint64_t* b,
+                    const ParameterSet& params) {
+    for (size_t i = 0; i < params.n; i++) {
+        out[i] = reduce(a[i] * b[i], params);
+    }
+}
+
+void NTT::pointwiseDot(uint64_t* out, const uint64_t* const* a, const uint64_t* const* b, size_t count,
+                       const ParameterSet& params) {
+    const size_t n = params.n;
+    const uint64_t q = params.q;
+
+    // Each product is below (q-1)^2, so a reduced residual plus `budget`
+    // products fits 64 bits. For q < 2^31 the budget is at least 3.
+    const uint64_t max_product = (q - 1) * (q - 1);
+    const size_t budget = max_product == 0 ? count : static_cast<size_t>((UINT64_MAX - (q - 1)) / max_product);
+
+    std::fill(out, out + n, 0);
+    for (size_t first = 0; first < count; first += budget) {
+        const size_t last = std::min(count, first + budget);
+        for (size_t i = first; i < last; i++) {
+            const uint64_t* ai = a[i];
+            const uint64_t* bi = b[i];
+            for (size_t j = 0; j < n; j++) {
+                out[j] += ai[j] * bi[j];
+            }
+        }
+        for (size_t j = 0; j < n; j++) {
+            out[j] = reduce(out[j], params);
+        }
+    }
+}
+
+std::vector<uint64_t> NTT::dot(const std::vector<std::vector<uint64_t>>& a,
+                               const std::vector<std::vector<uint64_t>>& b,
+                               const ParameterSet& params) {
+    if (!isSupported(params)) {
+        throw std::invalid_argument("Parameters do not support the NTT");
+    }
+    if (a.size() != b.size() || a.empty()) {
+        throw std::invalid_argument("Dot product needs two non-empty vectors of equal length");
+    }
+
+    // All 2k operands in one buffer, transformed together
+    const size_t n = params.n;
+    const size_t k = a.size();
+    std::vector<uint64_t> buffer(2 * k * n);
+    std::vector<uint64_t*> rows(2 * k);
+    for (size_t i = 0; i < 2 * k; i++) {
+        const std::vector<uint64_t>& src = i < k ? a[i] : b[i - k];
+        if (src.size() != n) {
+            throw std::invalid_argument("Operand size must match the ring dimension");
+        }
+        rows[i] = buffer.data() + i * n;
+        for (size_t j = 0; j < n; j++) {
+            rows[i][j] = src[j] % params.q;
+        }
+    }
+    forwardBatch(rows.data(), rows.size(), params);
+
+    std::vector<uint64_t> result(n);
+    pointwiseDot(result.data(), rows.data(), rows.data() + k, k, params);
+    inverse(result.data(), params);
+    return result;
+}
+
+std::vector<uint64_t> NTT::multiply(const std::vector<uint64_t>& a,
+                                    const std::vector<uint64_t>& b,
+                                    const ParameterSet& params) {
+    if (!isSupported(params)) {
+        throw std::invalid_argument("Parameters do not support the NTT");
+    }
+    if (a.size() != params.n || b.size() != params.n) {
+        throw std::invalid_argument("Operand size must match the ring dimension");
+    }
+
+    std::vector<uint64_t> fa(params.n);
+    std::vector<uint64_t> fb(params.n);
+    for (size_t i = 0; i < params.n; i++) {
+        fa[i] = a[i] % params.q;
+        fb[i] = b[i] % params.q;
+    }
+
+    forward(fa.data(), params);
+    forward(fb.data(), params);
+    pointwise(fa.data(), fa.data(), fb.data(), params);
+    inverse(fa.data(), params);
+    return fa;
+}
@@ -0,0 +1,155 @@
+#ifndef PARAM_TABLES_H
+#define PARAM_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Table generators shared by the compile-time presets and the runtime
+// parameter cache. Everything here is constexpr so presets are fully
+// evaluated by the compiler, while other parameter sets reuse the same
+// code at runtime and get bit-identical tables.
+namespace param_tables {
+
+// Modular arithmetic for q < 2^32
+constexpr uint64_t mulMod(uint64_t a, uint64_t b, uint64_t q) {
+    return (a * b) % q;
+}
+
+constexpr uint64_t powMod(uint64_t base, uint64_t exp, uint64_t q) {
+    uint64_t result = 1;
+    base %= q;
+    while (exp > 0) {
+        if (exp & 1) {
+            result = mulMod(result, base, q);
+        }
+        base = mulMod(base, base, q);
+        exp >>= 1;
+    }
+    return result;
+}
+
+constexpr bool isPrime(uint64_t q) {
+    if (q < 2) return false;
+    if (q % 2 == 0) return q == 2;
+    for (uint64_t d = 3; d * d <= q; d += 2) {
+        if (q % d == 0) return false;
+    }
+    return true;
+}
+
+// The negacyclic NTT needs a primitive 2n-th root of unity modulo a prime q.
+// Twiddles and their Shoup companions must fit 32 bits.
+constexpr bool isNTTFriendly(size_t n, uint64_t q) {
+    return n >= 2 && (n & (n - 1)) == 0 && q < (uint64_t(1) << 31) &&
+           (q - 1) % (2 * n) == 0 && isPrime(q);
+}
+
+// Smallest g^((q-1)/2n) that is a primitive 2n-th root of unity
+constexpr uint64_t findPsi(size_t n, uint64_t q) {
+    for (uint64_t g = 2; g < q; g++) {
+        uint64_t psi = powMod(g, (q - 1) / (2 * n), q);
+        if (powMod(psi, n, q) == q - 1) {
+            return psi;
+        }
+    }
+    return 0;
+}
+
+constexpr size_t bitReverse(size_t x, size_t bits) {
+    size_t r = 0;
+    for (size_t i = 0; i < bits; i++) {
+        r = (r << 1) | ((x >> i) & 1);
+    }
+    return r;
+}
+
+constexpr size_t log2Exact(size_t n) {
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n) bits++;
+    return bits;
+}
+
+// Precomputed floor(w * 2^32 / q) for Shoup modular multiplication
+constexpr uint64_t shoup(uint64_t w, uint64_t q) {
+    return (w << 32) / q;
+}
+
+constexpr uint64_t barrettFactor(uint64_t q) {
+    // floor(2^64 / q) computed without 128-bit arithmetic
+    return (~uint64_t(0)) / q + (((~uint64_t(0)) % q + 1) == q ? 1 : 0);
+}
+
+template <typename Array>
+constexpr void fillTwiddles(Array& psi_rev, Array& psi_rev_shoup,
+                            Array& psi_inv_rev, Array& psi_inv_rev_shoup,
+                            size_t n, uint64_t q) {
+    const size_t bits = log2Exact(n);
+    const uint64_t psi = findPsi(n, q);
+    const uint64_t psi_inv = powMod(psi, q - 2, q);
+
+    uint64_t power = 1;
+    uint64_t inv_power = 1;
+    for (size_t i = 0; i < n; i++) {
+        const size_t r = bitReverse(i, bits);
+        psi_rev[r] = power;
+        psi_rev_shoup[r] = shoup(power, q);
+        psi_inv_rev[r] = inv_power;
+        psi_inv_rev_shoup[r] = shoup(inv_power, q);
+        power = mulMod(power, psi, q);
+        inv_power = mulMod(inv_power, psi_inv, q);
+    }
+}
+
+// exp(x) for x <= 0 by argument halving and a Taylor series
+constexpr double expNonPositive(double x) {
+    int halvings = 0;
+    while (x < -0.5) {
+        x /= 2;
+        halvings++;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int i = 1; i < 30; i++) {
+        term *= x / i;
+        sum += term;
+    }
+    while (halvings-- > 0) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+constexpr double gaussianDensity(double x, double sigma) {
+    return expNonPositive(-(x * x) / (2 * sigma * sigma)) / (sigma * 2.5066282746310002);
+}
+
+// P(round(X) = k) for X ~ N(0, sigma^2), by Simpson's rule on [k - 1/2, k + 1/2]
+constexpr double roundedGaussianMass(size_t k, double sigma) {
+    constexpr int steps = 64;
+    const double lo = static_cast<double>(k) - 0.5;
+    const double h = 1.0 / steps;
+    double sum = gaussianDensity(lo, sigma) + gaussianDensity(lo + 1.0, sigma);
+    for (int i = 1; i < steps; i++) {
+        sum += (i % 2 ? 4.0 : 2.0) * gaussianDensity(lo + i * h, sigma);
+    }
+    return sum * h / 3.0;
+}
+
+// cdt[i] = 2^63 * P(|round(X)| <= i), accumulated in integers so the
+// table is monotone and bounded by 2^63 regardless of rounding
+template <typename Array>
+constexpr void fillGaussianCdt(Array& cdt, size_t size, double sigma) {
+    constexpr double scale = 9223372036854775808.0;  // 2^63
+    constexpr uint64_t limit = uint64_t(1) << 63;
+    uint64_t acc = 0;
+    for (size_t k = 0; k < size; k++) {
+        double mass = roundedGaussianMass(k, sigma) * (k == 0 ? 1.0 : 2.0);
+        uint64_t step = static_cast<uint64_t>(mass * scale + 0.5);
+        acc = (limit - acc < step) ? limit : acc + step;
+        cdt[k] = acc;
+    }
+}
+
+} // namespace param_tables
+
+#endif // PARAM_TABLES_H
@@ -0,0 +1,215 @@
+#include <params.h>
+#include "param_tables.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Compile-time tables for one preset
+template <size_t N, uint64_t Q>
+struct PresetTables {
+    static_assert(param_tables::isNTTFriendly(N, Q), "Preset parameters must support the NTT");
+
+    std::array<uint64_t, N> psi_rev{};
+    std::array<uint64_t, N> psi_rev_shoup{};
+    std::array<uint64_t, N> psi_inv_rev{};
+    std::array<uint64_t, N> psi_inv_rev_shoup{};
+    std::array<uint64_t, ParameterSet::CDT_SIZE> cdt{};
+    uint64_t n_inv = 0;
+
+    constexpr PresetTables() {
+        param_tables::fillTwiddles(psi_rev, psi_rev_shoup, psi_inv_rev, psi_inv_rev_shoup, N, Q);
+        param_tables::fillGaussianCdt(cdt, ParameterSet::CDT_SIZE, ParameterSet::GAUSSIAN_STDDEV);
+        n_inv = param_tables::powMod(N, Q - 2, Q);
+    }
+
+    constexpr ParameterSet makeSet(const char* name) const {
+        return ParameterSet{
+            name, N, Q, ParameterSet::GAUSSIAN_STDDEV, true,
+            true, param_tables::barrettFactor(Q), n_inv, param_tables::shoup(n_inv, Q),
+            psi_rev.data(), psi_rev_shoup.data(), psi_inv_rev.data(), psi_inv_rev_shoup.data(),
+            cdt.data(), ParameterSet::CDT_SIZE
+        };
+    }
+};
+
+constexpr PresetTables<256, 7681> tables_256_7681{};
+constexpr PresetTables<256, 12289> tables_256_12289{};
+constexpr PresetTables<512, 12289> tables_512_12289{};
+constexpr PresetTables<1024, 12289> tables_1024_12289{};
+
+constexpr ParameterSet preset_256_7681 = tables_256_7681.makeSet("RLWE-256-7681");
+constexpr ParameterSet preset_256_12289 = tables_256_12289.makeSet("RLWE-256-12289");
+constexpr ParameterSet preset_512_12289 = tables_512_12289.makeSet("RLWE-512-12289");
+constexpr ParameterSet preset_1024_12289 = tables_1024_12289.makeSet("RLWE-1024-12289");
+
+constexpr const ParameterSet* preset_table[] = {
+    &preset_256_7681,
+    &preset_256_12289,
+    &preset_512_12289,
+    &preset_1024_12289,
+};
+
+// Tables for parameters without a preset, built on first use
+struct RuntimeTables {
+    std::string name;
+    std::vector<uint64_t> psi_rev;
+    std::vector<uint64_t> psi_rev_shoup;
+    std::vector<uint64_t> psi_inv_rev;
+    std::vector<uint64_t> psi_inv_rev_shoup;
+    std::vector<uint64_t> cdt;
+    ParameterSet set;
+
+    RuntimeTables(size_t n, uint64_t q)
+        : name("runtime-" + std::to_string(n) + "-" + std::to_string(q)),
+          cdt(ParameterSet::CDT_SIZE) {
+        param_tables::fillGaussianCdt(cdt, ParameterSet::CDT_SIZE, ParameterSet::GAUSSIAN_STDDEV);
+
+        set = ParameterSet{
+            name.c_str(), n, q, ParameterSet::GAUSSIAN_STDDEV, false,
+            false, 0, 0, 0, nullptr, nullptr, nullptr, nullptr,
+            cdt.data(), ParameterSet::CDT_SIZE
+        };
+
+        if (param_tables::isNTTFriendly(n, q)) {
+            psi_rev.resize(n);
+            psi_rev_shoup.resize(n);
+            psi_inv_rev.resize(n);
+            psi_inv_rev_shoup.resize(n);
+            param_tables::fillTwiddles(psi_rev, psi_rev_shoup, psi_inv_rev, psi_inv_rev_shoup, n, q);
+
+            set.ntt_friendly = true;
+            set.barrett = param_tables::barrettFactor(q);
+            set.n_inv = param_tables::powMod(n, q - 2, q);
+            set.n_inv_shoup = param_tables::shoup(set.n_inv, q);
+            set.psi_rev = psi_rev.data();
+            set.psi_rev_shoup = psi_rev_shoup.data();
+            set.psi_inv_rev = psi_inv_rev.data();
+            set.psi_inv_rev_shoup = psi_inv_rev_shoup.data();
+        }
+    }
+};
+
+// Runtime sets live in an open-addressed table of MAX_RUNTIME_SETS * 2
+// slots. A slot is written once, under runtime_mutex, and never cleared,
+// so lookups read it without the lock; the acquire load pairs with the
+// release store that publishes a fully built entry.
+constexpr size_t RUNTIME_SLOTS = ParameterSet::MAX_RUNTIME_SETS * 2;
+
+std::mutex runtime_mutex;
+std::array<std::atomic<const RuntimeTables*>, RUNTIME_SLOTS> runtime_slots{};
+std::vector<std::unique_ptr<RuntimeTables>> runtime_tables;  // Owns the slots' entries
+std::atomic<size_t> runtime_builds{0};
+
+size_t slotOf(size_t n, uint64_t q) {
+    uint64_t h = (static_cast<uint64_t>(n) * 0x9e3779b97f4a7c15ULL) ^ q;
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return static_cast<size_t>(h) & (RUNTIME_SLOTS - 1);
+}
+
+// The entry for (n, q), or the empty slot where it belongs
+const RuntimeTables* probe(size_t n, uint64_t q, size_t& slot) {
+    for (slot = slotOf(n, q);; slot = (slot + 1) & (RUNTIME_SLOTS - 1)) {
+        const RuntimeTables* entry = runtime_slots[slot].load(std::memory_order_acquire);
+        if (entry == nullptr || (entry->set.n == n && entry->set.q == q)) {
+            return entry;
+        }
+    }
+}
+
+} // namespace
+
+const ParameterSet& ParameterSet::fromPreset(ParameterPreset preset) {
+    switch (preset) {
+        case ParameterPreset::RLWE_256_Q7681: return preset_256_7681;
+        case ParameterPreset::RLWE_256_Q12289: return preset_256_12289;
+        case ParameterPreset::RLWE_512_Q12289: return preset_512_12289;
+        case ParameterPreset::RLWE_1024_Q12289: return preset_1024_12289;
+    }
+    throw std::invalid_argument("Unknown parameter preset");
+}
+
+const ParameterSet& ParameterSet::get(size_t n, uint64_t q) {
+    for (const ParameterSet* preset : preset_table) {
+        if (preset->n == n && preset->q == q) {
+            return *preset;
+        }
+    }
+
+    if (n == 0 || n > MAX_DEGREE || q < 2) {
+        throw std::invalid_argument("Ring dimension must be between 1 and 2^24 and modulus at least 2");
+    }
+
+    size_t slot;
+    if (const RuntimeTables* found = probe(n, q, slot)) {
+        return found->set;
+    }
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    if (const RuntimeTables* found = probe(n, q, slot)) {
+        return found->set;  // Built by another thread meanwhile
+    }
+    if (runtime_tables.size() == MAX_RUNTIME_SETS) {
+        throw std::runtime_error("More than " + std::to_string(MAX_RUNTIME_SETS) +
+                                 " rings without a preset are in use");
+    }
+    runtime_tables.push_back(std::make_unique<RuntimeTables>(n, q));
+    runtime_slots[slot].store(runtime_tables.back().get(), std::memory_order_release);
+    runtime_builds.fetch_add(1, std::memory_order_relaxed);
+    return runtime_tables.back()->set;
+}
+
+const ParameterSet* ParameterSet::nttTables(size_t n, uint64_t q) {
+    for (const ParameterSet* preset : preset_table) {
+        if (preset->n == n && preset->q == q) {
+            return preset;
+        }
+    }
+    if (n > MAX_DEGREE) {
+        return nullptr;
+    }
+
+    size_t slot;
+    if (const RuntimeTables* found = probe(n, q, slot)) {
+        return found->set.ntt_friendly ? &found->set : nullptr;
+    }
+    // Rings without an NTT are left out of the table, so they cannot crowd
+    // out the ones that need it
+    if (!param_tables::isNTTFriendly(n, q)) {
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(runtime_mutex);
+        if (const RuntimeTables* found = probe(n, q, slot)) {
+            return &found->set;
+        }
+        if (runtime_tables.size() < MAX_RUNTIME_SETS) {
+            runtime_tables.push_back(std::make_unique<RuntimeTables>(n, q));
+            runtime_slots[slot].store(runtime_tables.back().get(), std::memory_order_release);
+            runtime_builds.fetch_add(1, std::memory_order_relaxed);
+            return &runtime_tables.back()->set;
+        }
+    }
+
+    // The table is full: keep the last such ring per thread instead
+    thread_local std::unique_ptr<RuntimeTables> overflow;
+    if (!overflow || overflow->set.n != n || overflow->set.q != q) {
+        overflow = std::make_unique<RuntimeTables>(n, q);
+        runtime_builds.fetch_add(1, std::memory_order_relaxed);
+    }
+    return &overflow->set;
+}
+
+const std::vector<const ParameterSet*>& ParameterSet::presets() {
+    static const std::vector<const ParameterSet*> all(std::begin(preset_table), std::end(preset_table));
+    return all;
+}
+
+size_t ParameterSet::runtimeBuildCount() {
+    return runtime_builds.load(std::memory_order_relaxed);
+}
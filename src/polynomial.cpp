@@ -1,40 +1,107 @@
 #include <polynomial.h>
+#include <params.h>
+#include <ntt.h>
+#include <algorithm>
 #include <stdexcept>
 
+// Reference rounding rule: is coeff closer to q/2 than to 0 in the cyclic group?
+static bool isCloserToHalf(uint64_t coeff, uint64_t modulus, uint64_t half_mod) {
+    uint64_t dist_to_zero = std::min(coeff, modulus - coeff);
+    uint64_t dist_to_half = std::min(
+        (coeff >= half_mod) ? coeff - half_mod : half_mod - coeff,
+        (coeff >= half_mod) ? modulus - coeff + half_mod : modulus - half_mod + coeff
+    );
+    return dist_to_zero > dist_to_half;
+}
+
+// On [0, q) the coefficients rounding to q/2 form one interval [lo, hi]
+// around q/2: membership grows monotonically on [0, q/2] and shrinks
+// monotonically on [q/2, q). Locate both ends once with the reference
+// rule, so that each coefficient is classified with a single unsigned
+// compare. Returns false for moduli too small for the interval.
+static bool signalInterval(uint64_t modulus, uint64_t& lo, uint64_t& hi) {
+    const uint64_t half_mod = modulus / 2;
+    lo = half_mod;
+    hi = half_mod;
+    if (modulus < 4) {
+        return false;
+    }
+    uint64_t left = 0, right = half_mod;
+    while (left < right) {
+        uint64_t mid = left + (right - left) / 2;
+        if (isCloserToHalf(mid, modulus, half_mod)) right = mid; else left = mid + 1;
+    }
+    lo = left;
+    left = half_mod;
+    right = modulus - 1;
+    while (left < right) {
+        uint64_t mid = left + (right - left + 1) / 2;
+        if (isCloserToHalf(mid, modulus, half_mod)) left = mid; else right = mid - 1;
+    }
+    hi = left;
+    return true;
+}
+
 // Implementation of polySignal
 Polynomial Polynomial::polySignal() const {
     Polynomial result(ring_dim, modulus);
     uint64_t half_mod = modulus / 2;
+    uint64_t lo, hi;
+    const bool use_interval = signalInterval(modulus, lo, hi);
+    const uint64_t width = hi - lo;
     
+    const uint64_t* in = coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        uint64_t coeff = coeffs[i];
-        // Determine if coefficient is closer to 0 or q/2 in cyclic group
-        uint64_t dist_to_zero = std::min(coeff, modulus - coeff);
-        uint64_t dist_to_half = std::min(
-            (coeff >= half_mod) ? coeff - half_mod : half_mod - coeff,
-            (coeff >= half_mod) ? modulus - coeff + half_mod : modulus - half_mod + coeff
-        );
-        
-        result[i] = (dist_to_zero <= dist_to_half) ? 0 : half_mod;
+        uint64_t coeff = in[i];
+        if (use_interval && coeff < modulus) {
+            out[i] = (coeff - lo <= width) ? half_mod : 0;
+        } else {
+            // Unreduced input: apply the rule literally
+            out[i] = isCloserToHalf(coeff, modulus, half_mod) ? half_mod : 0;
+        }
     }
     
     Logger::log("Rounded polynomial coefficients to binary signal");
     return result;
 }
 
+bool Polynomial::sameSignal(const uint64_t* x, const uint64_t* y, size_t n, uint64_t q) {
+    const uint64_t half_mod = q / 2;
+    uint64_t lo, hi;
+    const bool use_interval = signalInterval(q, lo, hi);
+    const uint64_t width = hi - lo;
+    auto signal = [&](uint64_t coeff) {
+        return use_interval && coeff < q ? coeff - lo <= width : isCloserToHalf(coeff, q, half_mod);
+    };
+    for (size_t i = 0; i < n; i++) {
+        if (signal(x[i]) != signal(y[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Polynomial Polynomial::operator+(const Polynomial& other) const {
     if (ring_dim != other.ring_dim || modulus != other.modulus) {
         throw std::invalid_argument("Polynomials must be in the same ring");
     }
 
-    Logger::log("Adding polynomials:\n  " + toString() + "\n  " + other.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Adding polynomials:\n  " + toString() + "\n  " + other.toString());
+    }
 
     Polynomial result(ring_dim, modulus);
+    const uint64_t* a = coeffs.data();
+    const uint64_t* b = other.coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        result[i] = (coeffs[i] + other.coeffs[i]) % modulus;
+        out[i] = (a[i] + b[i]) % modulus;
     }
 
-    Logger::log("Addition result:\n  " + result.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Addition result:\n  " + result.toString());
+    }
     return result;
 }
 
@@ -43,79 +110,256 @@ Polynomial Polynomial::operator-(const Polynomial& other) const {
         throw std::invalid_argument("Polynomials must be in the same ring");
     }
 
-    Logger::log("Subtracting polynomials:\n  " + toString() + "\n  " + other.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Subtracting polynomials:\n  " + toString() + "\n  " + other.toString());
+    }
 
     Polynomial result(ring_dim, modulus);
+    const uint64_t* a = coeffs.data();
+    const uint64_t* b = other.coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        result[i] = mod(static_cast<int64_t>(coeffs[i]) - 
-                       static_cast<int64_t>(other.coeffs[i]), modulus);
+        out[i] = mod(static_cast<int64_t>(a[i]) - static_cast<int64_t>(b[i]), modulus);
     }
 
-    Logger::log("Subtraction result:\n  " + result.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Subtraction result:\n  " + result.toString());
+    }
     return result;
 }
 
 Polynomial Polynomial::operator-() const {
-    Logger::log("Negating polynomial:\n  " + toString());
+    if (Logger::enable_logging) {
+        Logger::log("Negating polynomial:\n  " + toString());
+    }
 
     Polynomial result(ring_dim, modulus);
+    const uint64_t* a = coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        result[i] = (coeffs[i] == 0) ? 0 : modulus - coeffs[i];
+        out[i] = (a[i] == 0) ? 0 : modulus - a[i];
     }
 
-    Logger::log("Negation result:\n  " + result.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Negation result:\n  " + result.toString());
+    }
     return result;
 }
 
+// c mod q, with the division only taken for unreduced inputs
+static inline uint64_t reduceMod(uint64_t c, uint64_t q) {
+    return c < q ? c : c % q;
+}
+
+// -c mod q for any c
+static inline uint64_t negateMod(uint64_t c, uint64_t q) {
+    c = reduceMod(c, q);
+    return c == 0 ? 0 : q - c;
+}
+
+// Operands with at most log2(n) nonzero coefficients are multiplied by
+// rotation; beyond that the NTT wins even for ternary operands
+static size_t sparseWeightLimit(size_t n) {
+    size_t limit = 0;
+    while ((size_t(1) << (limit + 1)) <= n) limit++;
+    return limit;
+}
+
+// Whether p has at most `limit` nonzero coefficients, stopping early
+static bool isSparse(const CoeffBuffer& p, uint64_t q, size_t limit) {
+    size_t count = 0;
+    for (uint64_t c : p) {
+        if (c != 0 && c % q != 0 && ++count > limit) return false;
+    }
+    return true;
+}
+
 Polynomial Polynomial::operator*(const Polynomial& other) const {
     if (ring_dim != other.ring_dim || modulus != other.modulus) {
         throw std::invalid_argument("Polynomials must be in the same ring");
     }
 
-    Logger::log("Multiplying polynomials:\n  " + toString() + "\n  " + other.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Multiplying polynomials:\n  " + toString() + "\n  " + other.toString());
+    }
 
-    // Create temporary vector for the result with double size
-    std::vector<uint64_t> temp(2 * ring_dim, 0);
+    const size_t limit = sparseWeightLimit(ring_dim);
+    if (isSparse(coeffs, modulus, limit)) {
+        return multiplySparse(other);
+    }
+    if (isSparse(other.coeffs, modulus, limit)) {
+        return other.multiplySparse(*this);
+    }
 
-    // Perform polynomial multiplication
-    for (size_t i = 0; i < ring_dim; i++) {
-        for (size_t j = 0; j < ring_dim; j++) {
-            uint64_t prod = (static_cast<uint64_t>(coeffs[i]) * 
-                           static_cast<uint64_t>(other.coeffs[j])) % modulus;
-            temp[i + j] = (temp[i + j] + prod) % modulus;
+    // Use the NTT whenever the ring supports it. Both operands are
+    // transformed in polynomial-sized buffers, which are inline for tiny
+    // rings, so the product allocates nothing beyond the large-ring heap.
+    if (const ParameterSet* ntt = ParameterSet::nttTables(ring_dim, modulus)) {
+        const ParameterSet& params = *ntt;
+        Polynomial result(ring_dim, modulus);
+        Polynomial transformed(ring_dim, modulus);
+        uint64_t* fa = result.coeffs.data();
+        uint64_t* fb = transformed.coeffs.data();
+        for (size_t i = 0; i < ring_dim; i++) {
+            fa[i] = reduceMod(coeffs[i], modulus);
+            fb[i] = reduceMod(other.coeffs[i], modulus);
         }
+        NTT::forward(fa, params);
+        NTT::forward(fb, params);
+        NTT::pointwise(fa, fa, fb, params);
+        NTT::inverse(fa, params);
+        if (Logger::enable_logging) {
+            Logger::log("NTT multiplication result:\n  " + result.toString());
+        }
+        return result;
     }
 
-    Logger::log("Intermediate multiplication result:\n  " + 
-                Logger::vectorToString(temp, "  temp = "));
+    return multiplySchoolbook(other);
+}
+
+void Polynomial::rotateNegacyclic(uint64_t* out, const uint64_t* in, size_t n, int64_t k, uint64_t q) {
+    // x^k has period 2n; the upper half of the period is the lower half negated
+    const int64_t period = 2 * static_cast<int64_t>(n);
+    int64_t r = k % period;
+    if (r < 0) r += period;
+    const bool negate = r >= static_cast<int64_t>(n);
+    const size_t shift = static_cast<size_t>(negate ? r - static_cast<int64_t>(n) : r);
 
-    // Reduce modulo x^n + 1
+    // in[j] moves to j + shift; the last `shift` coefficients wrap around
+    // past x^n and change sign. Both loops are straight copies for reduced
+    // input apart from the compare.
+    if (!negate) {
+        for (size_t j = 0; j < n - shift; j++) out[j + shift] = reduceMod(in[j], q);
+        for (size_t j = n - shift; j < n; j++) out[j + shift - n] = negateMod(in[j], q);
+    } else {
+        for (size_t j = 0; j < n - shift; j++) out[j + shift] = negateMod(in[j], q);
+        for (size_t j = n - shift; j < n; j++) out[j + shift - n] = reduceMod(in[j], q);
+    }
+}
+
+Polynomial Polynomial::mulMonomial(int64_t k) const {
     Polynomial result(ring_dim, modulus);
+    rotateNegacyclic(result.coeffs.data(), coeffs.data(), ring_dim, k, modulus);
+    return result;
+}
+
+Polynomial Polynomial::dot(const std::vector<Polynomial>& u, const std::vector<Polynomial>& v) {
+    if (u.size() != v.size() || u.empty()) {
+        throw std::invalid_argument("Dot product needs two non-empty vectors of equal length");
+    }
+    const size_t n = u[0].ring_dim;
+    const uint64_t q = u[0].modulus;
+    for (size_t i = 0; i < u.size(); i++) {
+        if (u[i].ring_dim != n || v[i].ring_dim != n || u[i].modulus != q || v[i].modulus != q) {
+            throw std::invalid_argument("Polynomials must be in the same ring");
+        }
+    }
+
+    const ParameterSet* params = ParameterSet::nttTables(n, q);
+    if (params == nullptr) {
+        Polynomial sum = u[0] * v[0];
+        for (size_t i = 1; i < u.size(); i++) {
+            sum = sum + u[i] * v[i];
+        }
+        return sum;
+    }
+
+    std::vector<std::vector<uint64_t>> a, b;
+    a.reserve(u.size());
+    b.reserve(v.size());
+    for (size_t i = 0; i < u.size(); i++) {
+        a.emplace_back(u[i].coeffs.begin(), u[i].coeffs.end());
+        b.emplace_back(v[i].coeffs.begin(), v[i].coeffs.end());
+    }
+    return Polynomial(NTT::dot(a, b, *params), q);
+}
+
+size_t Polynomial::weight() const {
+    size_t count = 0;
+    for (uint64_t c : coeffs) {
+        count += (c % modulus) != 0;
+    }
+    return count;
+}
+
+Polynomial Polynomial::multiplySparse(const Polynomial& dense) const {
+    if (ring_dim != dense.ring_dim || modulus != dense.modulus) {
+        throw std::invalid_argument("Polynomials must be in the same ring");
+    }
+
+    const size_t n = ring_dim;
+    const uint64_t q = modulus;
+    const uint64_t half = q / 2;
+    Polynomial reduced(n, q);
+    uint64_t* d = reduced.coeffs.data();
+    for (size_t j = 0; j < n; j++) {
+        d[j] = reduceMod(dense.coeffs[j], q);
+    }
+
+    // Each term w * x^t adds w * d[j] to coefficient j + t, with the sign
+    // flipped for the part that wraps past x^n. Terms above q/2 are treated
+    // as -(q - w), so weights stay small and ternary terms need no products.
+    Polynomial result(n, q);
+    uint64_t* acc = result.coeffs.data();
+    for (size_t t = 0; t < n; t++) {
+        const uint64_t c = reduceMod(coeffs[t], q);
+        if (c == 0) continue;
+        const bool negative = c > half;
+        const uint64_t w = negative ? q - c : c;
+
+        auto term = [&](size_t j) { return w == 1 ? d[j] : (w * d[j]) % q; };
+        auto add = [&](uint64_t& a, uint64_t v) { a += v; a = a >= q ? a - q : a; };
+        auto sub = [&](uint64_t& a, uint64_t v) { a += q - v; a = a >= q ? a - q : a; };
+        for (size_t j = 0; j < n - t; j++) {
+            if (negative) sub(acc[j + t], term(j)); else add(acc[j + t], term(j));
+        }
+        for (size_t j = n - t; j < n; j++) {
+            if (negative) add(acc[j + t - n], term(j)); else sub(acc[j + t - n], term(j));
+        }
+    }
+    return result;
+}
+
+Polynomial Polynomial::multiplySchoolbook(const Polynomial& other) const {
+    // Accumulate straight into the result: x^(i+j) with i + j >= n wraps
+    // to x^(i+j-n) with its sign flipped, since x^n = -1
+    Polynomial result(ring_dim, modulus);
+    const uint64_t* a = coeffs.data();
+    const uint64_t* b = other.coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        // Start with the regular coefficient
-        result[i] = temp[i];
-        
-        // Subtract corresponding coefficient from higher degree when reducing mod x^n + 1
-        size_t higher_degree = i + ring_dim;
-        while (higher_degree < temp.size()) {
-            result[i] = mod(static_cast<int64_t>(result[i]) - 
-                          static_cast<int64_t>(temp[higher_degree]), modulus);
-            higher_degree += ring_dim;
+        for (size_t j = 0; j < ring_dim; j++) {
+            uint64_t prod = (a[i] * b[j]) % modulus;
+            size_t k = i + j;
+            if (k < ring_dim) {
+                out[k] = (out[k] + prod) % modulus;
+            } else {
+                out[k - ring_dim] = mod(static_cast<int64_t>(out[k - ring_dim]) - 
+                                        static_cast<int64_t>(prod), modulus);
+            }
         }
     }
 
-    Logger::log("Final multiplication result after reduction:\n  " + result.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Final multiplication result after reduction:\n  " + result.toString());
+    }
     return result;
 }
 
 Polynomial Polynomial::operator*(uint64_t scalar) const {
-    Logger::log("Multiplying polynomial by scalar " + std::to_string(scalar) + ":\n  " + toString());
+    if (Logger::enable_logging) {
+        Logger::log("Multiplying polynomial by scalar " + std::to_string(scalar) + ":\n  " + toString());
+    }
 
     Polynomial result(ring_dim, modulus);
+    const uint64_t* a = coeffs.data();
+    uint64_t* out = result.coeffs.data();
     for (size_t i = 0; i < ring_dim; i++) {
-        result[i] = (coeffs[i] * scalar) % modulus;
+        out[i] = (a[i] * scalar) % modulus;
     }
 
-    Logger::log("Scalar multiplication result:\n  " + result.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Scalar multiplication result:\n  " + result.toString());
+    }
     return result;
 }
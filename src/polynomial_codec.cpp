@@ -0,0 +1,295 @@
+#include <polynomial_codec.h>
+#include "bit_packing.h"
+#include <algorithm>
+#include <stdexcept>
+
+static void putLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint64_t getLE(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+size_t packedSize(size_t n, uint64_t q) {
+    return (n * bitsFor(q) + 7) / 8;
+}
+
+// Moduli up to this many bits are packed and unpacked through a local
+// accumulator and output pointer, which the compiler keeps in registers;
+// wider ones go through BitWriter and BitReader
+static constexpr unsigned FAST_PACK_BITS = 56;
+
+void packCoefficients(const uint64_t* coeffs, size_t n, uint64_t q, uint8_t* out) {
+    const unsigned bits = bitsFor(q);
+    const size_t size = packedSize(n, q);
+    if (bits > FAST_PACK_BITS) {
+        std::vector<uint8_t> packed;
+        packed.reserve(size);
+        BitWriter writer(packed);
+        for (size_t i = 0; i < n; i++) {
+            writer.write(coeffs[i] < q ? coeffs[i] : coeffs[i] % q, bits);
+        }
+        writer.finish();
+        std::copy(packed.begin(), packed.end(), out);
+        return;
+    }
+
+    // Each step stores the whole accumulator, including the partly filled
+    // byte, and advances by the bytes it completed, so the loop has no
+    // data-dependent branches; only the last few stores are shortened to
+    // stay inside the output
+    uint8_t* dst = out;
+    uint8_t* const end = out + size;
+    uint64_t acc = 0;
+    unsigned used = 0;
+    for (size_t i = 0; i < n; i++) {
+        acc |= (coeffs[i] < q ? coeffs[i] : coeffs[i] % q) << used;
+        used += bits;
+        if (end - dst >= 8) {
+            storeLE64(dst, acc);
+        } else {
+            for (ptrdiff_t k = 0; k < end - dst; k++) {
+                dst[k] = static_cast<uint8_t>(acc >> (8 * k));
+            }
+        }
+        dst += used / 8;
+        acc >>= used / 8 * 8;
+        used %= 8;
+    }
+}
+
+void packCoefficients(const Polynomial& p, uint8_t* out) {
+    packCoefficients(p.getCoeffs().data(), p.degree(), p.getModulus(), out);
+}
+
+void packCoefficients(const Polynomial& p, std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    out.resize(start + packedSize(p.degree(), p.getModulus()));
+    packCoefficients(p, out.data() + start);
+}
+
+void unpackCoefficients(const uint8_t* in, Polynomial& p) {
+    unpackCoefficients(in, p.degree(), p.getModulus(), p.data());
+}
+
+void unpackCoefficients(const uint8_t* in, size_t n, uint64_t q, uint64_t* coeffs) {
+    const unsigned bits = bitsFor(q);
+    if (bits > FAST_PACK_BITS) {
+        BitReader reader(in, packedSize(n, q));
+        for (size_t i = 0; i < n; i++) {
+            coeffs[i] = reader.read(bits);
+            if (coeffs[i] >= q) {
+                throw std::invalid_argument("Packed coefficient out of range");
+            }
+        }
+        return;
+    }
+
+    // Coefficient i starts at bit i * bits and fits in the 8 bytes from
+    // its first byte; those whose 8 bytes lie inside the input are read
+    // independently, the rest byte by byte
+    const size_t size = packedSize(n, q);
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    uint64_t out_of_range = 0;
+    size_t i = 0;
+    for (; i < n && (i * bits) / 8 + 8 <= size; i++) {
+        const size_t pos = i * bits;
+        coeffs[i] = (loadLE64(in + pos / 8) >> (pos % 8)) & mask;
+        out_of_range |= coeffs[i] >= q;
+    }
+    if (i < n) {
+        BitReader reader(in + (i * bits) / 8, size - (i * bits) / 8);
+        if ((i * bits) % 8 != 0) {
+            reader.read((i * bits) % 8);
+        }
+        for (; i < n; i++) {
+            coeffs[i] = reader.read(bits);
+            out_of_range |= coeffs[i] >= q;
+        }
+    }
+    if (out_of_range) {
+        throw std::invalid_argument("Packed coefficient out of range");
+    }
+}
+
+std::vector<uint8_t> encodePolynomials(const std::vector<Polynomial>& polys) {
+    std::vector<uint8_t> out;
+    putLE(out, polys.size(), 4);
+    for (const auto& p : polys) {
+        putLE(out, p.degree(), 4);
+        putLE(out, p.getModulus(), 8);
+        packCoefficients(p, out);
+    }
+    return out;
+}
+
+std::vector<Polynomial> decodePolynomials(const uint8_t* data, size_t size) {
+    if (size < 4) {
+        throw std::invalid_argument("Malformed polynomial encoding");
+    }
+    const uint64_t count = getLE(data, 4);
+    size_t pos = 4;
+
+    std::vector<Polynomial> polys;
+    for (uint64_t k = 0; k < count; k++) {
+        if (size - pos < 12) {
+            throw std::invalid_argument("Malformed polynomial encoding");
+        }
+        const size_t n = static_cast<size_t>(getLE(data + pos, 4));
+        const uint64_t q = getLE(data + pos + 4, 8);
+        pos += 12;
+        if (q < 2 || size - pos < packedSize(n, q)) {
+            throw std::invalid_argument("Malformed polynomial encoding");
+        }
+        Polynomial p(n, q);
+        unpackCoefficients(data + pos, p);
+        pos += packedSize(n, q);
+        polys.push_back(std::move(p));
+    }
+    if (pos != size) {
+        throw std::invalid_argument("Trailing bytes after polynomial encoding");
+    }
+    return polys;
+}
+
+// Layout of the small polynomial header: u32 n | u64 q | u8 k | u32 payload
+static constexpr size_t SMALL_HEADER_SIZE = 4 + 8 + 1 + 4;
+static constexpr unsigned MAX_RICE_PARAMETER = 7;
+
+// Bit reader specialized for Rice codes: unary runs are counted a whole
+// 64-bit window at a time with a count-trailing-zeros instruction
+class RiceReader {
+public:
+    RiceReader(const uint8_t* data, size_t size) : ptr(data), end(data + size) {}
+
+    // Zero bits before the next one bit, which is consumed
+    unsigned unary() {
+        unsigned zeros = 0;
+        while (true) {
+            refill();
+            if (acc == 0) {
+                if (avail == 0) {
+                    throw std::invalid_argument("Truncated Rice code");
+                }
+                zeros += avail;
+                avail = 0;
+            } else {
+                const unsigned t = static_cast<unsigned>(__builtin_ctzll(acc));
+                acc >>= t;
+                acc >>= 1;
+                avail -= t + 1;
+                return zeros + t;
+            }
+        }
+    }
+
+    // Next bits (< 32) of the stream
+    uint64_t bits(unsigned count) {
+        if (count == 0) return 0;
+        refill();
+        if (avail < count) {
+            throw std::invalid_argument("Truncated Rice code");
+        }
+        const uint64_t value = acc & ((uint64_t(1) << count) - 1);
+        acc >>= count;
+        avail -= count;
+        return value;
+    }
+
+private:
+    const uint8_t* ptr;
+    const uint8_t* end;
+    uint64_t acc = 0;
+    unsigned avail = 0;
+
+    void refill() {
+        while (avail <= 56 && ptr != end) {
+            acc |= uint64_t(*ptr++) << avail;
+            avail += 8;
+        }
+    }
+};
+
+static size_t riceBits(const SmallPolynomial& p, unsigned k) {
+    size_t bits = 0;
+    for (size_t i = 0; i < p.degree(); i++) {
+        const unsigned m = static_cast<unsigned>(p[i] < 0 ? -p[i] : p[i]);
+        bits += (m >> k) + 1 + k + (m != 0);
+    }
+    return bits;
+}
+
+std::vector<uint8_t> encodeSmallPolynomial(const SmallPolynomial& p) {
+    unsigned k = 0;
+    size_t best = riceBits(p, 0);
+    for (unsigned candidate = 1; candidate <= MAX_RICE_PARAMETER; candidate++) {
+        const size_t bits = riceBits(p, candidate);
+        if (bits < best) {
+            best = bits;
+            k = candidate;
+        }
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(SMALL_HEADER_SIZE + (best + 7) / 8);
+    putLE(out, p.degree(), 4);
+    putLE(out, p.getModulus(), 8);
+    putLE(out, k, 1);
+    putLE(out, (best + 7) / 8, 4);
+
+    BitWriter writer(out);
+    for (size_t i = 0; i < p.degree(); i++) {
+        const unsigned m = static_cast<unsigned>(p[i] < 0 ? -p[i] : p[i]);
+        for (unsigned zeros = m >> k; zeros > 0;) {
+            const unsigned chunk = zeros < 32 ? zeros : 32;
+            writer.write(0, chunk);
+            zeros -= chunk;
+        }
+        writer.write(1, 1);
+        if (k > 0) {
+            writer.write(m, k);
+        }
+        if (m != 0) {
+            writer.write(p[i] < 0, 1);
+        }
+    }
+    writer.finish();
+    return out;
+}
+
+SmallPolynomial decodeSmallPolynomial(const uint8_t* data, size_t size, size_t* consumed) {
+    if (size < SMALL_HEADER_SIZE) {
+        throw std::invalid_argument("Malformed small polynomial encoding");
+    }
+    const size_t n = static_cast<size_t>(getLE(data, 4));
+    const uint64_t q = getLE(data + 4, 8);
+    const unsigned k = static_cast<unsigned>(data[12]);
+    const size_t payload = static_cast<size_t>(getLE(data + 13, 4));
+    // Every coefficient takes at least one bit
+    if (k > MAX_RICE_PARAMETER || n / 8 > payload || size - SMALL_HEADER_SIZE < payload ||
+        (consumed == nullptr && size - SMALL_HEADER_SIZE != payload)) {
+        throw std::invalid_argument("Malformed small polynomial encoding");
+    }
+
+    RiceReader reader(data + SMALL_HEADER_SIZE, payload);
+    std::vector<int64_t> values(n);
+    for (size_t i = 0; i < n; i++) {
+        const unsigned quotient = reader.unary();
+        if (quotient > static_cast<unsigned>(SmallPolynomial::MAX_COEFF) >> k) {
+            throw std::invalid_argument("Small polynomial coefficient out of range");
+        }
+        const int64_t m = static_cast<int64_t>((quotient << k) | reader.bits(k));
+        values[i] = (m != 0 && reader.bits(1)) ? -m : m;
+    }
+    if (consumed) {
+        *consumed = SMALL_HEADER_SIZE + payload;
+    }
+    return SmallPolynomial(values, q);
+}
@@ -0,0 +1,159 @@
+#include "primitives.h"
+#include <logging.h>
+#include <sha256.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// Platform-specific includes for secure random
+#if defined(_WIN32)
+#include <windows.h>
+#include <bcrypt.h>
+#elif defined(__APPLE__)
+#include <Security/SecRandom.h>
+#elif defined(__linux__)
+#include <sys/random.h>
+#include <cerrno>
+#endif
+
+void getSecureRandomBytes(uint8_t* buffer, size_t length) {
+#if defined(_WIN32)
+    // Windows: Use BCrypt
+    BCRYPT_ALG_HANDLE hAlg = NULL;
+    NTSTATUS status = BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_RNG_ALGORITHM, NULL, 0);
+    if (!BCRYPT_SUCCESS(status)) {
+        throw std::runtime_error("Failed to open BCrypt algorithm provider");
+    }
+    
+    status = BCryptGenRandom(hAlg, buffer, static_cast<ULONG>(length), 0);
+    BCryptCloseAlgorithmProvider(hAlg, 0);
+    
+    if (!BCRYPT_SUCCESS(status)) {
+        throw std::runtime_error("Failed to generate random bytes using BCrypt");
+    }
+#elif defined(__APPLE__)
+    // macOS: Use SecRandomCopyBytes
+    if (SecRandomCopyBytes(kSecRandomDefault, length, buffer) != 0) {
+        throw std::runtime_error("Failed to generate random bytes using SecRandomCopyBytes");
+    }
+#elif defined(__linux__)
+    // Linux: getrandom() fills the whole buffer without opening a device
+    size_t filled = 0;
+    while (filled < length) {
+        ssize_t got = getrandom(buffer + filled, length - filled, 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to generate random bytes using getrandom");
+        }
+        filled += static_cast<size_t>(got);
+    }
+#else
+    // Other Unix-like systems: Use /dev/urandom
+    std::random_device rd("/dev/urandom");
+    if (!rd.entropy()) {
+        throw std::runtime_error("Failed to access secure random source");
+    }
+    
+    for (size_t i = 0; i < length; i += sizeof(uint32_t)) {
+        uint32_t random = rd();
+        size_t remaining = std::min(sizeof(uint32_t), length - i);
+        std::memcpy(buffer + i, &random, remaining);
+    }
+#endif
+}
+
+// SHA-256 is fetched from the provider once, and each thread keeps one
+// context that is re-initialized per block, so hashing the thousands of
+// blocks of a batch does not repeat the lookup and allocation that a
+// one-shot EVP_Digest() makes per call
+static const EVP_MD* sha256Digest() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static const std::unique_ptr<EVP_MD, decltype(&EVP_MD_free)> md(EVP_MD_fetch(nullptr, "SHA256", nullptr),
+                                                                    EVP_MD_free);
+    if (!md) {
+        throw std::runtime_error("SHA-256 is not available");
+    }
+    return md.get();
+#else
+    return EVP_sha256();
+#endif
+}
+
+static EVP_MD_CTX* threadDigestContext() {
+    thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!ctx) {
+        throw std::runtime_error("Failed to create message digest context");
+    }
+    return ctx.get();
+}
+
+void hashToCoefficients(uint64_t* coeffs, size_t n, uint64_t q, const std::vector<uint8_t>& message) {
+    hashToCoefficients(coeffs, n, q, message.data(), message.size());
+}
+
+void hashToCoefficients(uint64_t* coeffs, size_t n, uint64_t q, const uint8_t* message, size_t size) {
+    const uint64_t half = q / 2;
+    const EVP_MD* md = sha256Digest();
+    EVP_MD_CTX* ctx = threadDigestContext();
+
+    // Each block is counter || message, fed to the digest in two parts
+    uint32_t counter = 0;
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    
+    size_t coeff_idx = 0;
+    while (coeff_idx < n) {
+        if (EVP_DigestInit_ex(ctx, md, nullptr) != 1 ||
+            EVP_DigestUpdate(ctx, &counter, sizeof(counter)) != 1 ||
+            EVP_DigestUpdate(ctx, message, size) != 1 ||
+            EVP_DigestFinal_ex(ctx, hash, nullptr) != 1) {
+            throw std::runtime_error("Failed to compute digest");
+        }
+        
+        if (Logger::enable_logging) {
+            std::stringstream ss;
+            ss << "Block " << counter << " hash: ";
+            for (uint8_t b : hash) {
+                ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
+            }
+            Logger::log(ss.str());
+        }
+        
+        // Convert hash bits to coefficients, most significant bit first
+        for (size_t byte_idx = 0; coeff_idx < n && byte_idx < sizeof(hash); byte_idx++) {
+            const uint8_t byte = hash[byte_idx];
+            if (coeff_idx + 8 <= n) {
+                for (int bit = 0; bit < 8; bit++) {
+                    coeffs[coeff_idx + bit] = half & (0 - static_cast<uint64_t>((byte >> (7 - bit)) & 1));
+                }
+                coeff_idx += 8;
+            } else {
+                for (int bit = 7; bit >= 0 && coeff_idx < n; bit--) {
+                    coeffs[coeff_idx++] = ((byte >> bit) & 1) ? half : 0;
+                }
+            }
+        }
+        
+        counter++;
+    }
+}
+
+void shake256(const std::vector<uint8_t>& input, uint8_t* out, size_t length) {
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>
+        mdctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!mdctx) {
+        throw std::runtime_error("Failed to create message digest context");
+    }
+    if (EVP_DigestInit_ex(mdctx.get(), EVP_shake256(), nullptr) != 1 ||
+        EVP_DigestUpdate(mdctx.get(), input.data(), input.size()) != 1 ||
+        EVP_DigestFinalXOF(mdctx.get(), out, length) != 1) {
+        throw std::runtime_error("SHAKE256 failed");
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Building blocks shared by the ring and module signature schemes. This
+// header is private to the library.
+
+// Fill buffer with bytes from the operating system's secure random source
+void getSecureRandomBytes(uint8_t* buffer, size_t length);
+
+// Counter-mode SHA-256 expansion of a message into n coefficients that
+// are each 0 or q/2. Block i is SHA256(i || message) with i a 32-bit
+// counter in native byte order; its bits are consumed most significant first.
+void hashToCoefficients(uint64_t* coeffs, size_t n, uint64_t q, const std::vector<uint8_t>& message);
+void hashToCoefficients(uint64_t* coeffs, size_t n, uint64_t q, const uint8_t* message, size_t size);
+
+// SHAKE256 of input, squeezed to length bytes
+void shake256(const std::vector<uint8_t>& input, uint8_t* out, size_t length);
+
+#endif // PRIMITIVES_H
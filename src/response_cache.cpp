@@ -0,0 +1,168 @@
+#include <response_cache.h>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+// Shared by a claim's holder and the retries waiting on it
+struct ClaimState {
+    RequestDigest request;
+    bool ended = false;
+    std::shared_ptr<const std::vector<uint8_t>> response;  // Set when too large to cache
+};
+
+CacheClaim::CacheClaim(ResponseCache* owner, std::string id, std::shared_ptr<ClaimState> claim)
+    : cache(owner), request_id(std::move(id)), state(std::move(claim)) {}
+
+CacheClaim::CacheClaim(CacheClaim&& other) noexcept
+    : cache(std::exchange(other.cache, nullptr)), request_id(std::move(other.request_id)),
+      state(std::move(other.state)) {}
+
+CacheClaim& CacheClaim::operator=(CacheClaim&& other) noexcept {
+    if (this != &other) {
+        release();
+        cache = std::exchange(other.cache, nullptr);
+        request_id = std::move(other.request_id);
+        state = std::move(other.state);
+    }
+    return *this;
+}
+
+CacheClaim::~CacheClaim() {
+    release();
+}
+
+bool CacheClaim::store(std::vector<uint8_t> response) {
+    if (!cache) {
+        throw std::runtime_error("Response cache claim on " + request_id + " has already ended");
+    }
+    return std::exchange(cache, nullptr)->finish(request_id, state, &response);
+}
+
+void CacheClaim::release() {
+    if (cache) {
+        std::exchange(cache, nullptr)->finish(request_id, state, nullptr);
+    }
+}
+
+ResponseCache::ResponseCache(size_t budget, std::chrono::milliseconds lifetime, TimeSource clock)
+    : max_bytes(budget), ttl(lifetime), now(std::move(clock))
+{
+    if (max_bytes == 0 || ttl.count() <= 0) {
+        throw std::invalid_argument("Response cache needs a positive size and lifetime");
+    }
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator it) {
+    used_bytes -= it->cost;
+    by_id.erase(it->request_id);
+    entries.erase(it);
+}
+
+CacheLookup ResponseCache::begin(const std::string& request_id, const RequestDigest& request) {
+    // Waiting is bounded in real time: a first attempt that outlives the
+    // ttl is presumed stuck, and the retry is refused rather than run
+    const Clock::time_point deadline = Clock::now() + ttl;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto claim = in_flight.find(request_id); claim != in_flight.end(); claim = in_flight.find(request_id)) {
+        const std::shared_ptr<ClaimState> state = claim->second;
+        if (state->request != request ||
+            !settled.wait_until(lock, deadline, [&state]() { return state->ended; })) {
+            conflict_count++;
+            return {CacheStatus::Conflict, {}, {}};
+        }
+        if (state->response) {
+            hit_count++;
+            return {CacheStatus::Hit, *state->response, {}};
+        }
+    }
+
+    auto it = by_id.find(request_id);
+    if (it != by_id.end() && now() >= it->second->expires) {
+        erase(it->second);
+        it = by_id.end();
+    }
+    if (it == by_id.end()) {
+        auto state = std::make_shared<ClaimState>();
+        state->request = request;
+        in_flight.emplace(request_id, state);
+        miss_count++;
+        return {CacheStatus::Miss, {}, CacheClaim(this, request_id, std::move(state))};
+    }
+    if (it->second->request != request) {
+        conflict_count++;
+        return {CacheStatus::Conflict, {}, {}};
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    hit_count++;
+    return {CacheStatus::Hit, it->second->response, {}};
+}
+
+bool ResponseCache::finish(const std::string& request_id, const std::shared_ptr<ClaimState>& state,
+                           std::vector<uint8_t>* response) {
+    const size_t cost = response ? request_id.size() + response->size() + ENTRY_OVERHEAD : 0;
+    const Clock::time_point t = response ? now() : Clock::time_point{};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    in_flight.erase(request_id);
+    state->ended = true;
+    settled.notify_all();
+    if (!response) {
+        return false;
+    }
+
+    auto existing = by_id.find(request_id);
+    if (existing != by_id.end()) {
+        erase(existing->second);
+    }
+    if (cost > max_bytes) {
+        // Too large to cache, but the retries already waiting still get it
+        // instead of running the request again
+        state->response = std::make_shared<const std::vector<uint8_t>>(std::move(*response));
+        return false;
+    }
+
+    // Expired entries at the cold end go first and are not counted as
+    // evictions; then least recently used ones until the new entry fits
+    while (!entries.empty() && t >= entries.back().expires) {
+        erase(std::prev(entries.end()));
+    }
+    while (used_bytes + cost > max_bytes) {
+        erase(std::prev(entries.end()));
+        eviction_count++;
+    }
+
+    entries.push_front({request_id, state->request, std::move(*response), t + ttl, cost});
+    by_id[request_id] = entries.begin();
+    used_bytes += cost;
+    return true;
+}
+
+size_t ResponseCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t ResponseCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used_bytes;
+}
+
+uint64_t ResponseCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+uint64_t ResponseCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
+
+uint64_t ResponseCache::evictions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return eviction_count;
+}
+
+uint64_t ResponseCache::conflicts() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return conflict_count;
+}
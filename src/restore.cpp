@@ -0,0 +1,156 @@
+#include <restore.h>
+#include <ntt.h>
+#include "primitives.h"
+#include <algorithm>
+#include <stdexcept>
+
+// Blinding factors are transformed this many at a time, one per SIMD lane
+// of NTT::forwardBatch; each group is one unit of parallel work
+static constexpr size_t LANES = 8;
+
+WalletRestorer::WalletRestorer(const SeedDerivation& seed_derivation, const Polynomial& a,
+                               const Polynomial& b, size_t batch, size_t gap)
+    : derivation(seed_derivation), keyset(a, b), params(&keyset.getParams()),
+      batch_size(batch), gap_limit(gap), use_ntt(keyset.aHat() != nullptr)
+{
+    if (batch_size == 0 || gap_limit == 0) {
+        throw std::invalid_argument("Batch size and gap limit must be positive");
+    }
+}
+
+WalletRestorer::Batch WalletRestorer::derive(uint64_t first, size_t count) const {
+    const size_t n = params->n;
+    const uint64_t q = params->q;
+
+    Batch batch;
+    batch.secrets.resize(count);
+    batch.factors.assign(count, SmallPolynomial(n, q));
+    batch.blinded.assign(count, Polynomial(n, q));
+    if (use_ntt) {
+        batch.factors_hat.resize(count * n);
+    }
+
+    const size_t groups = (count + LANES - 1) / LANES;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t g = 0; g < groups; g++) {
+        const size_t begin = g * LANES;
+        const size_t end = std::min(count, begin + LANES);
+
+        std::vector<uint64_t> products(use_ntt ? (end - begin) * n : 0);
+        uint64_t* rows[LANES];
+        uint64_t* product_rows[LANES];
+        for (size_t k = begin; k < end; k++) {
+            batch.secrets[k] = derivation.secret(first + k);
+            batch.factors[k] = derivation.blindingFactor(first + k, *params);
+
+            Polynomial Y(n, q);
+            hashToCoefficients(Y.data(), n, q, batch.secrets[k]);
+            if (use_ntt) {
+                rows[k - begin] = batch.factors_hat.data() + k * n;
+                product_rows[k - begin] = products.data() + (k - begin) * n;
+                batch.factors[k].widen(rows[k - begin]);
+                batch.blinded[k] = std::move(Y);
+            } else {
+                batch.blinded[k] = Y + batch.factors[k].multiply(keyset.getA());
+            }
+        }
+        if (!use_ntt) continue;
+
+        // a*r for the whole group, keeping NTT(r) for the unblinding product
+        NTT::forwardBatch(rows, end - begin, *params);
+        for (size_t j = 0; j < end - begin; j++) {
+            NTT::pointwise(product_rows[j], rows[j], keyset.aHat(), *params);
+        }
+        NTT::inverseBatch(product_rows, end - begin, *params);
+        for (size_t j = 0; j < end - begin; j++) {
+            uint64_t* y = batch.blinded[begin + j].data();
+            const uint64_t* ar = product_rows[j];
+            for (size_t i = 0; i < n; i++) {
+                const uint64_t sum = y[i] + ar[i];
+                y[i] = sum >= q ? sum - q : sum;
+            }
+        }
+    }
+    return batch;
+}
+
+std::vector<Polynomial> WalletRestorer::unblind(const Batch& batch, const std::vector<size_t>& indices,
+                                                const std::vector<Polynomial>& blind_signatures) const {
+    const size_t n = params->n;
+    const uint64_t q = params->q;
+
+    std::vector<Polynomial> signatures(indices.size(), Polynomial(n, q));
+    const size_t groups = (indices.size() + LANES - 1) / LANES;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t g = 0; g < groups; g++) {
+        const size_t begin = g * LANES;
+        const size_t end = std::min(indices.size(), begin + LANES);
+
+        // r*b from the NTT(r) kept by derive()
+        std::vector<Polynomial> products;
+        products.reserve(end - begin);
+        uint64_t* rows[LANES];
+        for (size_t j = begin; j < end; j++) {
+            if (use_ntt) {
+                products.emplace_back(n, q);
+                rows[j - begin] = products.back().data();
+                NTT::pointwise(rows[j - begin], batch.factors_hat.data() + indices[j] * n, keyset.bHat(), *params);
+            } else {
+                products.push_back(batch.factors[indices[j]].multiply(keyset.getB()));
+            }
+        }
+        if (use_ntt) {
+            NTT::inverseBatch(rows, end - begin, *params);
+        }
+        for (size_t j = begin; j < end; j++) {
+            signatures[j] = blind_signatures[j] - products[j - begin];
+        }
+    }
+    return signatures;
+}
+
+std::vector<Polynomial> WalletRestorer::blindedMessages(uint64_t first, size_t count) const {
+    return derive(first, count).blinded;
+}
+
+RestoreResult WalletRestorer::restore(const SignatureLookup& lookup, uint64_t start) const {
+    RestoreResult result{{}, start, 0, 0};
+    uint64_t next = start;
+    uint64_t window_end = start + gap_limit;
+
+    while (next < window_end) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(batch_size, window_end - next));
+        Batch batch = derive(next, count);
+
+        std::vector<std::optional<Polynomial>> responses = lookup(batch.blinded);
+        result.lookups++;
+        result.scanned += count;
+        if (responses.size() != count) {
+            throw std::runtime_error("Lookup returned " + std::to_string(responses.size()) +
+                                     " entries for " + std::to_string(count) + " blinded messages");
+        }
+
+        std::vector<size_t> indices;
+        std::vector<Polynomial> blind_signatures;
+        for (size_t k = 0; k < count; k++) {
+            if (!responses[k]) continue;
+            if (responses[k]->degree() != params->n || responses[k]->getModulus() != params->q) {
+                throw std::runtime_error("Lookup returned a signature outside the keyset's ring");
+            }
+            indices.push_back(k);
+            blind_signatures.push_back(std::move(*responses[k]));
+        }
+
+        std::vector<Polynomial> signatures = unblind(batch, indices, blind_signatures);
+        for (size_t j = 0; j < indices.size(); j++) {
+            const uint64_t counter = next + indices[j];
+            result.tokens.push_back({counter, std::move(batch.secrets[indices[j]]), std::move(signatures[j])});
+            result.next_counter = counter + 1;
+        }
+        if (!indices.empty()) {
+            window_end = result.next_counter + gap_limit;
+        }
+        next += count;
+    }
+    return result;
+}
@@ -1,54 +1,31 @@
 #include <polynomial.h>
 #include <rlwe.h>
+#include <signature_index.h>
+#include <polynomial_codec.h>
+#include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
 #include <limits>
 #include <random>
-#include <sha256.h>
+#include <ntt.h>
+#include <sampler.h>
+#include "primitives.h"
 
-// Platform-specific includes for secure random
 #if defined(_WIN32)
 #include <windows.h>
-#include <bcrypt.h>
-#elif defined(__APPLE__)
-#include <Security/SecRandom.h>
-#endif
-
-static void getSecureRandomBytes(uint8_t* buffer, size_t length) {
-#if defined(_WIN32)
-    // Windows: Use BCrypt
-    BCRYPT_ALG_HANDLE hAlg = NULL;
-    NTSTATUS status = BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_RNG_ALGORITHM, NULL, 0);
-    if (!BCRYPT_SUCCESS(status)) {
-        throw std::runtime_error("Failed to open BCrypt algorithm provider");
-    }
-    
-    status = BCryptGenRandom(hAlg, buffer, static_cast<ULONG>(length), 0);
-    BCryptCloseAlgorithmProvider(hAlg, 0);
-    
-    if (!BCRYPT_SUCCESS(status)) {
-        throw std::runtime_error("Failed to generate random bytes using BCrypt");
-    }
-#elif defined(__APPLE__)
-    // macOS: Use SecRandomCopyBytes
-    if (SecRandomCopyBytes(kSecRandomDefault, length, buffer) != 0) {
-        throw std::runtime_error("Failed to generate random bytes using SecRandomCopyBytes");
-    }
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
 #else
-    // Linux and other Unix-like systems: Use /dev/urandom
-    std::random_device rd("/dev/urandom");
-    if (!rd.entropy()) {
-        throw std::runtime_error("Failed to access secure random source");
-    }
-    
-    for (size_t i = 0; i < length; i += sizeof(uint32_t)) {
-        uint32_t random = rd();
-        size_t remaining = std::min(sizeof(uint32_t), length - i);
-        std::memcpy(buffer + i, &random, remaining);
-    }
+#include <fcntl.h>
+#include <unistd.h>
 #endif
-}
 
 uint64_t RLWESignature::getRandomUint64() {
     uint64_t result;
@@ -56,20 +33,6 @@ uint64_t RLWESignature::getRandomUint64() {
     return result;
 }
 
-double RLWESignature::getRandomDouble() {
-    uint64_t r1, r2;
-    getSecureRandomBytes(reinterpret_cast<uint8_t*>(&r1), sizeof(r1));
-    getSecureRandomBytes(reinterpret_cast<uint8_t*>(&r2), sizeof(r2));
-    
-    double u1 = static_cast<double>(r1) / std::numeric_limits<uint64_t>::max();
-    double u2 = static_cast<double>(r2) / std::numeric_limits<uint64_t>::max();
-    
-    double radius = std::sqrt(-2 * std::log(u1));
-    double theta = 2 * M_PI * u2;
-    
-    return radius * std::cos(theta);
-}
-
 // Helper function to check if a number is a power of 2
 static bool isPowerOfTwo(size_t n) {
     return n != 0 && (n & (n - 1)) == 0;
@@ -102,68 +65,287 @@ static bool validatePowerOfTwo(size_t n) {
 #endif
 }
 
-RLWESignature::RLWESignature(size_t n, uint64_t q)
+// The ring's tables, once n is known to be valid, so that no tables are
+// built and cached for a ring the constructor rejects
+static const ParameterSet& ringParams(size_t n, uint64_t q) {
+    if (!validatePowerOfTwo(n)) {
+        throw std::invalid_argument("n must be a power of 2");
+    }
+    return ParameterSet::get(n, q);
+}
+
+RLWESignature::RLWESignature(size_t n, uint64_t q, double stddev)
     : ring_dim_n(n),
       modulus(q),
+      gaussian_stddev(stddev),
+      params(&ringParams(n, q)),
+      validator(*params),
       a(n, q),
       b(n, q),
       s(n, q)
 {
-    // Validate that n is a power of 2 using the helper function
-    if (!validatePowerOfTwo(n)) {
-        throw std::invalid_argument("n must be a power of 2");
+    if (!(stddev > 0.0)) {
+        throw std::invalid_argument("Gaussian standard deviation must be positive");
+    }
+    if (stddev > MAX_SMALL_STDDEV) {
+        throw std::invalid_argument("Gaussian standard deviation too large for 8-bit secret storage");
+    }
+    if (stddev != params->sigma) {
+        sampler = GaussianSampler::withDeviation(*params, stddev);
     }
 
     Logger::log("Created RLWE instance with n=" + std::to_string(n) + 
                 ", q=" + std::to_string(q));
 }
 
+RLWESignature::RLWESignature(ParameterPreset preset)
+    : RLWESignature(ParameterSet::fromPreset(preset).n, ParameterSet::fromPreset(preset).q)
+{
+}
+
 void RLWESignature::generateKeys() {
     Logger::log("\nGenerating keys...");
     Logger::log("Sampling uniform polynomial a");
     a = sampleUniform();
     
     Logger::log("Sampling gaussian polynomial s (secret key)");
-    s = sampleGaussian(GAUSSIAN_STDDEV);
+    s = sampleGaussian();
     
     Logger::log("Sampling gaussian polynomial e");
-    Polynomial e = sampleGaussian(GAUSSIAN_STDDEV);
+    SmallPolynomial e = sampleGaussian();
     
     Logger::log("Computing b = a*s + e");
     b = a * s + e;
     
-    Logger::log("Public key a: " + a.toString());
-    Logger::log("Public key b: " + b.toString());  
-    Logger::log("Secret key s: " + s.toString());
+    prepared = std::make_shared<const PreparedKeyset>(a, b);
+    keyset_id = prepared->id();
+    
+    if (Logger::enable_logging) {
+        Logger::log("Keyset id: " + keysetIdToHex(keyset_id));
+        Logger::log("Public key a: " + a.toString());
+        Logger::log("Public key b: " + b.toString());
+        Logger::log("Secret key s: " + s.toString());
+    }
+}
+
+static const char KEY_FILE_MAGIC[8] = {'R', 'L', 'W', 'E', 'K', 'E', 'Y', '1'};
+
+// Writes a key file so that a crash never leaves a truncated key at path:
+// the bytes go to a fresh file in the same directory, readable by the owner
+// only, which is synced and then moved over path
+#if defined(_WIN32)
+static void writeKeyFile(const std::string& path, const std::vector<uint8_t>& file) {
+    // Windows has no mkstemp; _O_EXCL refuses a name that already exists,
+    // so draw random suffixes until one is free. Access is governed by the
+    // directory's inherited ACL, _S_IWRITE only keeps the file writable
+    std::string temp;
+    int fd = -1;
+    for (int attempt = 0; attempt < 16 && fd < 0; attempt++) {
+        uint8_t suffix[8];
+        getSecureRandomBytes(suffix, sizeof(suffix));
+        temp = path + ".";
+        for (uint8_t byte : suffix) {
+            temp += "0123456789abcdef"[byte >> 4];
+            temp += "0123456789abcdef"[byte & 15];
+        }
+        fd = _open(temp.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        throw std::runtime_error("Cannot write key file " + path);
+    }
+    size_t written = 0;
+    while (written < file.size()) {
+        const size_t left = file.size() - written;
+        const unsigned chunk = static_cast<unsigned>(left < (1u << 30) ? left : (1u << 30));
+        const int n = _write(fd, file.data() + written, chunk);
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    const bool synced = written == file.size() && _commit(fd) == 0;
+    if (_close(fd) != 0 || !synced ||
+        !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        std::remove(temp.c_str());
+        throw std::runtime_error("Cannot write key file " + path);
+    }
+}
+#else
+static void writeKeyFile(const std::string& path, const std::vector<uint8_t>& file) {
+    std::string temp = path + ".XXXXXX";
+    const int fd = mkstemp(temp.data());
+    if (fd < 0) {
+        throw std::runtime_error("Cannot write key file " + path);
+    }
+    size_t written = 0;
+    while (written < file.size()) {
+        const ssize_t n = ::write(fd, file.data() + written, file.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    const bool synced = written == file.size() && fsync(fd) == 0;
+    if (::close(fd) != 0 || !synced || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        throw std::runtime_error("Cannot write key file " + path);
+    }
+
+    // The rename is only durable once the directory entry is; filesystems
+    // that cannot sync a directory report EINVAL and need nothing more
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    const int dir_fd = ::open(dir.c_str(), O_RDONLY);
+    if (dir_fd < 0) {
+        throw std::runtime_error("Cannot sync directory of key file " + path);
+    }
+    const bool dir_synced = fsync(dir_fd) == 0 || errno == EINVAL;
+    ::close(dir_fd);
+    if (!dir_synced) {
+        throw std::runtime_error("Cannot sync directory of key file " + path);
+    }
+}
+#endif
+
+void RLWESignature::saveKeys(const std::string& path) const {
+    if (!prepared) {
+        throw std::runtime_error("No keys to save");
+    }
+    const std::vector<uint8_t> public_key = encodePolynomials({a, b});
+    const std::vector<uint8_t> secret_key = encodeSmallPolynomial(s);
+
+    std::vector<uint8_t> file(KEY_FILE_MAGIC, KEY_FILE_MAGIC + sizeof(KEY_FILE_MAGIC));
+    for (size_t i = 0; i < 4; i++) {
+        file.push_back(static_cast<uint8_t>(public_key.size() >> (8 * i)));
+    }
+    file.insert(file.end(), public_key.begin(), public_key.end());
+    file.insert(file.end(), secret_key.begin(), secret_key.end());
+
+    writeKeyFile(path, file);
+}
+
+// Reads a key file and decodes its public key; secret_offset is set to
+// the start of the secret key in file
+static std::vector<Polynomial> readPublicKey(const std::string& path, std::vector<uint8_t>& file,
+                                             size_t& secret_offset) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open key file " + path);
+    }
+    file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    const size_t header = sizeof(KEY_FILE_MAGIC) + 4;
+    if (file.size() < header || std::memcmp(file.data(), KEY_FILE_MAGIC, sizeof(KEY_FILE_MAGIC)) != 0) {
+        throw std::runtime_error("Not a key file: " + path);
+    }
+    size_t public_size = 0;
+    for (size_t i = 4; i-- > 0;) {
+        public_size = (public_size << 8) | file[sizeof(KEY_FILE_MAGIC) + i];
+    }
+    if (file.size() - header < public_size) {
+        throw std::runtime_error("Truncated key file " + path);
+    }
+    secret_offset = header + public_size;
+    try {
+        std::vector<Polynomial> public_key = decodePolynomials(file.data() + header, public_size);
+        if (public_key.size() != 2) {
+            throw std::invalid_argument("Key file must hold two public polynomials");
+        }
+        return public_key;
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("Corrupt key file " + path + ": " + e.what());
+    }
+}
+
+std::unique_ptr<RLWESignature> RLWESignature::fromKeyFile(const std::string& path) {
+    std::vector<uint8_t> file;
+    size_t secret_offset = 0;
+    const std::vector<Polynomial> public_key = readPublicKey(path, file, secret_offset);
+    std::unique_ptr<RLWESignature> key;
+    try {
+        key = std::make_unique<RLWESignature>(public_key[0].degree(), public_key[0].getModulus());
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("Key file " + path + " is for an unsupported ring: " + e.what());
+    }
+    key->loadKeys(path);
+    return key;
+}
+
+void RLWESignature::loadKeys(const std::string& path) {
+    std::vector<uint8_t> file;
+    size_t secret_offset = 0;
+    std::vector<Polynomial> public_key = readPublicKey(path, file, secret_offset);
+    try {
+        SmallPolynomial secret_key = decodeSmallPolynomial(file.data() + secret_offset, file.size() - secret_offset);
+        for (const auto& p : public_key) {
+            if (p.degree() != ring_dim_n || p.getModulus() != modulus) {
+                throw std::invalid_argument("Key file is for another ring");
+            }
+        }
+        if (secret_key.degree() != ring_dim_n || secret_key.getModulus() != modulus) {
+            throw std::invalid_argument("Key file is for another ring");
+        }
+        s = std::move(secret_key);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("Corrupt key file " + path + ": " + e.what());
+    }
+
+    a = std::move(public_key[0]);
+    b = std::move(public_key[1]);
+    prepared = std::make_shared<const PreparedKeyset>(a, b);
+    keyset_id = prepared->id();
+
+    if (Logger::enable_logging) {
+        Logger::log("Loaded keyset " + keysetIdToHex(keyset_id) + " from " + path);
+    }
 }
 
 std::pair<Polynomial, Polynomial> RLWESignature::computeBlindedMessage(const std::vector<uint8_t>& secret) {
     Logger::log("\nComputing blinded message...");
     
     // Sample random blinding factor
-    Polynomial r = sampleGaussian(GAUSSIAN_STDDEV);
-    Logger::log("Random blinding factor r: " + r.toString());
+    SmallPolynomial r = sampleGaussian();
+    if (Logger::enable_logging) {
+        Logger::log("Random blinding factor r: " + r.toString());
+    }
     
+    return std::make_pair(computeBlindedMessage(secret, r), r.toPolynomial());
+}
+
+Polynomial RLWESignature::computeBlindedMessage(const std::vector<uint8_t>& secret,
+                                                const SmallPolynomial& blindingFactor) {
+    if (blindingFactor.degree() != ring_dim_n || blindingFactor.getModulus() != modulus) {
+        throw std::invalid_argument("Blinding factor must be in the key's ring");
+    }
+
     // Hash secret to polynomial
     Polynomial Y = hashToPolynomial(secret);
-    Logger::log("Hashed secret Y: " + Y.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Hashed secret Y: " + Y.toString());
+    }
     
     // Compute blinded message: Y + a*r    
-    Polynomial blindedMessage = Y + a * r;
-    Logger::log("Blinded message (Y + a*r): " + blindedMessage.toString());
-    
-    return std::make_pair(blindedMessage, r);
+    Polynomial blindedMessage = Y + a * blindingFactor;
+    if (Logger::enable_logging) {
+        Logger::log("Blinded message (Y + a*r): " + blindedMessage.toString());
+    }
+    return blindedMessage;
 }
 
 Polynomial RLWESignature::blindSign(const Polynomial& blindedMessagePoly) {
     Logger::log("\nPerforming blind signing...");
-    Logger::log("Blinded message received: " + blindedMessagePoly.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Blinded message received: " + blindedMessagePoly.toString());
+    }
+    validator.validate(blindedMessagePoly);
     
-    Polynomial e1 = sampleGaussian(GAUSSIAN_STDDEV);
+    SmallPolynomial e1 = sampleGaussian();
 
     // Compute signature: s * blinded_message
     Polynomial signature = s * blindedMessagePoly + e1;
-    Logger::log("Computed blind signature (s * blinded_message): " + signature.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Computed blind signature (s * blinded_message): " + signature.toString());
+    }
+    if (signature_index) {
+        signature_index->record(blindedMessagePoly, signature, keyset_id);
+    }
     
     return signature;
 }
@@ -171,41 +353,163 @@ Polynomial RLWESignature::blindSign(const Polynomial& blindedMessagePoly) {
 bool RLWESignature::verify(const std::vector<uint8_t>& message,
                           const Polynomial& signature) {
     Logger::log("\nVerifying signature...");
-    logMessageBytes("Message", message);
-    Logger::log("Signature to verify: " + signature.toString());
+    if (Logger::enable_logging) {
+        logMessageBytes("Message", message);
+        Logger::log("Signature to verify: " + signature.toString());
+    }
+    if (signature.degree() != ring_dim_n || signature.getModulus() != modulus) {
+        Logger::log("Verification result: FAILED (signature not in the ring)");
+        return false;
+    }
     
     // Hash message to polynomial
     Polynomial z = hashToPolynomial(message);
-    Logger::log("Hashed message z: " + z.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Hashed message z: " + z.toString());
+    }
     
     // Expected value: s * z
     Polynomial expected = s * z;
-    Logger::log("Expected value (s*z): " + expected.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Expected value (s*z): " + expected.toString());
+    }
 
+    bool result = signalsMatch(signature, expected);
+    Logger::log(result ? "Verification result: SUCCESS" : "Verification result: FAILED");
+    return result;
+}
+
+bool RLWESignature::signalsMatch(const Polynomial& signature, const Polynomial& expected) const {
     // Round both polynomials to binary signals (0 or q/2)
     Polynomial actual_signal = signature.polySignal();
     Polynomial expected_signal = expected.polySignal();
     
-    Logger::log("Rounded signature: " + actual_signal.toString());
-    Logger::log("Rounded expected: " + expected_signal.toString());
+    if (Logger::enable_logging) {
+        Logger::log("Rounded signature: " + actual_signal.toString());
+        Logger::log("Rounded expected: " + expected_signal.toString());
+    }
 
     // Compare the coefficients
     const auto& actual_coeffs = actual_signal.getCoeffs();
     const auto& expected_coeffs = expected_signal.getCoeffs();
     
-    bool result = true;
     for (size_t i = 0; i < actual_coeffs.size(); i++) {
         if (actual_coeffs[i] != expected_coeffs[i]) {
-            Logger::log("Mismatch at coefficient " + std::to_string(i) + 
-                       ": actual=" + std::to_string(actual_coeffs[i]) + 
-                       ", expected=" + std::to_string(expected_coeffs[i]));
-            result = false;
-            break;
+            if (Logger::enable_logging) {
+                Logger::log("Mismatch at coefficient " + std::to_string(i) + 
+                           ": actual=" + std::to_string(actual_coeffs[i]) + 
+                           ", expected=" + std::to_string(expected_coeffs[i]));
+            }
+            return false;
         }
     }
-    
-    Logger::log("Verification result: " + std::string(result ? "SUCCESS" : "FAILED"));
-    return result;
+    return true;
+}
+
+std::vector<Polynomial> RLWESignature::multiplyBySecret(const std::vector<Polynomial>& polys) const {
+    for (const auto& p : polys) {
+        if (p.degree() != ring_dim_n || p.getModulus() != modulus) {
+            throw std::invalid_argument("Polynomials must be in the same ring");
+        }
+    }
+
+    // One contiguous buffer holding all operands, transformed in batches
+    PolynomialBatch batch(polys.size(), ring_dim_n, modulus);
+    for (size_t k = 0; k < polys.size(); k++) {
+        uint64_t* row = batch.row(k);
+        const auto& coeffs = polys[k].getCoeffs();
+        for (size_t i = 0; i < ring_dim_n; i++) {
+            row[i] = coeffs[i] % modulus;
+        }
+    }
+    multiplyBySecret(batch);
+
+    std::vector<Polynomial> products;
+    products.reserve(polys.size());
+    for (size_t k = 0; k < batch.size(); k++) {
+        products.emplace_back(std::vector<uint64_t>(batch.row(k), batch.row(k) + ring_dim_n), modulus);
+    }
+    return products;
+}
+
+void RLWESignature::multiplyBySecret(PolynomialBatch& batch) const {
+    if (!NTT::isSupported(*params)) {
+        Polynomial p(ring_dim_n, modulus);
+        for (size_t k = 0; k < batch.size(); k++) {
+            std::copy(batch.row(k), batch.row(k) + ring_dim_n, p.data());
+            const Polynomial product = s * p;
+            std::copy(product.getCoeffs().begin(), product.getCoeffs().end(), batch.row(k));
+        }
+        return;
+    }
+
+    std::vector<uint64_t> s_hat(ring_dim_n);
+    s.widen(s_hat.data());
+    NTT::forward(s_hat.data(), *params);
+    std::vector<uint64_t*> rows(batch.size());
+    for (size_t k = 0; k < batch.size(); k++) {
+        rows[k] = batch.row(k);
+    }
+    NTT::forwardBatch(rows.data(), rows.size(), *params);
+    for (uint64_t* row : rows) {
+        NTT::pointwise(row, row, s_hat.data(), *params);
+    }
+    NTT::inverseBatch(rows.data(), rows.size(), *params);
+}
+
+std::vector<Polynomial> RLWESignature::blindSignBatch(const std::vector<Polynomial>& blindedMessages) {
+    Logger::log("\nPerforming batch blind signing of " + std::to_string(blindedMessages.size()) + " messages...");
+    for (const auto& message : blindedMessages) {
+        validator.validate(message);
+    }
+    std::vector<Polynomial> signatures = multiplyBySecret(blindedMessages);
+    for (auto& signature : signatures) {
+        signature = signature + sampleGaussian();
+    }
+    if (signature_index) {
+        signature_index->recordBatch(blindedMessages, signatures, keyset_id);
+    }
+    return signatures;
+}
+
+std::vector<bool> RLWESignature::verifyBatch(const std::vector<std::vector<uint8_t>>& secrets,
+                                             const std::vector<Polynomial>& signatures) {
+    if (secrets.size() != signatures.size()) {
+        throw std::invalid_argument("Number of secrets and signatures must match");
+    }
+    Logger::log("\nVerifying batch of " + std::to_string(secrets.size()) + " signatures...");
+
+    std::vector<Polynomial> hashed;
+    hashed.reserve(secrets.size());
+    for (const auto& secret : secrets) {
+        hashed.push_back(hashToPolynomial(secret));
+    }
+    std::vector<Polynomial> expected = multiplyBySecret(hashed);
+
+    std::vector<bool> results(secrets.size());
+    for (size_t k = 0; k < secrets.size(); k++) {
+        results[k] = signatures[k].degree() == ring_dim_n && signatures[k].getModulus() == modulus &&
+                     signalsMatch(signatures[k], expected[k]);
+    }
+    return results;
+}
+
+void RLWESignature::verifyBatch(const uint8_t* const* secrets, const size_t* secret_sizes,
+                                const PolynomialBatch& signatures, bool* results) const {
+    const size_t count = signatures.size();
+    if (signatures.degree() != ring_dim_n || signatures.getModulus() != modulus) {
+        std::fill(results, results + count, false);
+        return;
+    }
+
+    PolynomialBatch expected(count, ring_dim_n, modulus);
+    for (size_t k = 0; k < count; k++) {
+        hashToCoefficients(expected.row(k), ring_dim_n, modulus, secrets[k], secret_sizes[k]);
+    }
+    multiplyBySecret(expected);
+    for (size_t k = 0; k < count; k++) {
+        results[k] = Polynomial::sameSignal(signatures.row(k), expected.row(k), ring_dim_n, modulus);
+    }
 }
 
 Polynomial RLWESignature::computeSignature(
@@ -219,31 +523,47 @@ Polynomial RLWESignature::computeSignature(
     return C_ - r*A;
 }
 
-Polynomial RLWESignature::sampleUniform() {
-    std::vector<uint64_t> coeffs(ring_dim_n);
-    
-    for (size_t i = 0; i < ring_dim_n; i++) {
-        coeffs[i] = getRandomUint64() % modulus;
+Polynomial RLWESignature::computeSignature(const Polynomial& blindSignature,
+                                           const SmallPolynomial& blindingFactor,
+                                           const Polynomial& publicKey) const {
+    return blindSignature - blindingFactor * publicKey;
+}
+
+const PreparedKeyset& RLWESignature::preparedKeyset() const {
+    if (!prepared) {
+        throw std::runtime_error("Keys have not been generated");
     }
-    
-    return Polynomial(coeffs, modulus);
+    return *prepared;
+}
+
+PolynomialBatch RLWESignature::computeBlindedMessageBatch(const std::vector<std::vector<uint8_t>>& secrets,
+                                                          const std::vector<SmallPolynomial>& blindingFactors) const {
+    return preparedKeyset().blind(secrets, blindingFactors);
+}
+
+PolynomialBatch RLWESignature::computeSignatureBatch(const std::vector<Polynomial>& blindSignatures,
+                                                     const std::vector<SmallPolynomial>& blindingFactors) const {
+    return preparedKeyset().unblind(blindSignatures, blindingFactors);
 }
 
-Polynomial RLWESignature::sampleGaussian(double stddev) {
-    std::vector<uint64_t> coeffs(ring_dim_n);
+Polynomial RLWESignature::sampleUniform() {
+    Polynomial result(ring_dim_n, modulus);
+    uint64_t* coeffs = result.data();
+    getSecureRandomBytes(reinterpret_cast<uint8_t*>(coeffs), ring_dim_n * sizeof(uint64_t));
     
     for (size_t i = 0; i < ring_dim_n; i++) {
-        double sample = getRandomDouble() * stddev;
-        int64_t rounded = static_cast<int64_t>(std::round(sample));
-        
-        if (rounded < 0) {
-            rounded += modulus;
-        }
-        
-        coeffs[i] = rounded % modulus;
+        coeffs[i] %= modulus;
     }
     
-    return Polynomial(coeffs, modulus);
+    return result;
+}
+
+SmallPolynomial RLWESignature::sampleGaussian() {
+    // Table-driven sampling with one bulk read from the random source
+    const ParameterSet& tables = sampler ? *sampler : *params;
+    std::vector<uint64_t> words(ring_dim_n);
+    getSecureRandomBytes(reinterpret_cast<uint8_t*>(words.data()), words.size() * sizeof(uint64_t));
+    return SmallPolynomial::sampleGaussian(words.data(), tables);
 }
 
 Polynomial RLWESignature::messageToPolynomial(const std::vector<uint8_t>& message) {
@@ -264,57 +584,18 @@ Polynomial RLWESignature::messageToPolynomial(const std::vector<uint8_t>& messag
 
 Polynomial RLWESignature::hashToPolynomial(const std::vector<uint8_t>& message) {
     Logger::log("\nConverting message to polynomial using counter-based hashing");
-    logMessageBytes("Input message", message);
-    
-    // Create a polynomial to hold the result
-    std::vector<uint64_t> coeffs(ring_dim_n, 0);
-        
-    // Process message in blocks using counter
-    size_t coeff_idx = 0;
-    uint32_t counter = 0;
-    
-    while (coeff_idx < ring_dim_n) {
-        // Prepare message block with counter
-        std::vector<uint8_t> block;
-        block.reserve(message.size() + sizeof(counter));
-        
-        // Add counter to the beginning of the block
-        const uint8_t* counter_bytes = reinterpret_cast<const uint8_t*>(&counter);
-        block.insert(block.end(), counter_bytes, counter_bytes + sizeof(counter));
-        
-        // Add original message
-        block.insert(block.end(), message.begin(), message.end());
-        
-        Logger::log("Block " + std::to_string(counter) + " content:");
-        logMessageBytes("  ", block);
-        
-        // Hash the block
-        std::vector<uint8_t> hash = SHA256::hash(block);
-        std::stringstream ss;
-        ss << "Block " << counter << " hash: ";
-        for (uint8_t b : hash) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
-        }
-        Logger::log(ss.str());
-
-        // Convert hash bits to coefficients
-        for (size_t byte_idx = 0; coeff_idx < ring_dim_n && byte_idx < hash.size(); byte_idx++) {
-            for (int bit = 7; bit >= 0 && coeff_idx < ring_dim_n; bit--) {
-                bool bit_value = (hash[byte_idx] >> bit) & 1;
-                coeffs[coeff_idx++] = bit_value ? (modulus / 2) : 0;
-            }
-        }
-        
-        counter++;
+    if (Logger::enable_logging) {
+        logMessageBytes("Input message", message);
     }
     
-    Logger::log("Final polynomial coefficients:");
-    std::stringstream result_ss;
-    for (size_t i = 0; i < coeffs.size(); i++) {
-        if (i > 0) result_ss << ", ";
-        result_ss << coeffs[i];
+    // Hash straight into the result polynomial
+    Polynomial result(ring_dim_n, modulus);
+    hashToCoefficients(result.data(), ring_dim_n, modulus, message);
+    
+    if (Logger::enable_logging) {
+        Logger::log("Final polynomial coefficients:");
+        Logger::log(Logger::vectorToString(result.getCoeffs()));
     }
-    Logger::log(result_ss.str());
     
-    return Polynomial(coeffs, modulus);
+    return result;
 }
@@ -0,0 +1,49 @@
+#include <sampler.h>
+#include "param_tables.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+void GaussianSampler::sample(uint64_t* coeffs, const uint64_t* words, size_t count,
+                             const ParameterSet& params) {
+    const int64_t q = static_cast<int64_t>(params.q);
+    for (size_t i = 0; i < count; i++) {
+        int64_t value = fromWord(words[i], params) % q;
+        coeffs[i] = static_cast<uint64_t>(value < 0 ? value + q : value);
+    }
+}
+
+void GaussianSampler::sampleCentered(int8_t* coeffs, const uint64_t* words, size_t count,
+                                     const ParameterSet& params) {
+    static_assert(ParameterSet::CDT_SIZE <= std::numeric_limits<int8_t>::max(),
+                  "Gaussian samples must fit a signed byte");
+    if (params.cdt_size > static_cast<size_t>(std::numeric_limits<int8_t>::max())) {
+        throw std::invalid_argument("Gaussian table too wide for 8-bit samples");
+    }
+    for (size_t i = 0; i < count; i++) {
+        coeffs[i] = static_cast<int8_t>(fromWord(words[i], params));
+    }
+}
+
+std::shared_ptr<const ParameterSet> GaussianSampler::withDeviation(const ParameterSet& params, double sigma) {
+    if (!(sigma > 0.0 && sigma <= 12.0)) {
+        throw std::invalid_argument("Gaussian standard deviation must be in (0, 12]");
+    }
+    struct Tables {
+        std::vector<uint64_t> cdt;
+        ParameterSet set;
+    };
+    const size_t size = std::min(static_cast<size_t>(std::ceil(10.0 * sigma)) + 2,
+                                 static_cast<size_t>(std::numeric_limits<int8_t>::max()));
+    auto tables = std::make_shared<Tables>();
+    tables->cdt.resize(size);
+    param_tables::fillGaussianCdt(tables->cdt, size, sigma);
+    tables->set = params;
+    tables->set.sigma = sigma;
+    tables->set.cdt = tables->cdt.data();
+    tables->set.cdt_size = size;
+    // The set shares ownership of the table it points into
+    return std::shared_ptr<const ParameterSet>(tables, &tables->set);
+}
@@ -39,6 +39,13 @@ std::vector<uint8_t> SHA256::hash(const std::string& data) {
     return hash(std::vector<uint8_t>(data.begin(), data.end()));
 }
 
+void SHA256::hash(const uint8_t* data, size_t length, uint8_t* digest) {
+    unsigned int digest_len = 0;
+    if (EVP_Digest(data, length, digest, &digest_len, EVP_sha256(), nullptr) != 1) {
+        throw std::runtime_error("Failed to compute digest");
+    }
+}
+
 std::vector<uint8_t> SHA256::polyToHash(const Polynomial& poly) {
     // Use the polynomial's toBytes method and hash the result
     return hash(poly.toBytes());
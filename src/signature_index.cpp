@@ -0,0 +1,385 @@
+#include <signature_index.h>
+#include <sha256.h>
+#include <polynomial_codec.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char INDEX_MAGIC[8] = {'R', 'L', 'W', 'E', 'S', 'I', 'X', '1'};
+
+// digest, keyset, u32 n, u64 q
+static constexpr size_t BODY_HEADER_SIZE = 32 + 8 + 4 + 8;
+
+static void putLE(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint64_t getLE(const uint8_t* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = bytes; i-- > 0;) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Positional file access, so appends and concurrent lookups never share a
+// file pointer
+#if defined(_WIN32)
+static int openLog(const std::string& path) {
+    return _open(path.c_str(), _O_RDWR | _O_BINARY);
+}
+
+static bool writeAt(int fd, uint64_t offset, const uint8_t* data, size_t size) {
+    HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    while (size > 0) {
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD done = 0;
+        const DWORD chunk = static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30));
+        if (!WriteFile(file, data, chunk, &done, &at) || done == 0) return false;
+        data += done;
+        offset += done;
+        size -= done;
+    }
+    return true;
+}
+
+static bool readAt(int fd, uint64_t offset, uint8_t* data, size_t size) {
+    HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    while (size > 0) {
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD done = 0;
+        const DWORD chunk = static_cast<DWORD>(size < (1u << 30) ? size : (1u << 30));
+        if (!ReadFile(file, data, chunk, &done, &at) || done == 0) return false;
+        data += done;
+        offset += done;
+        size -= done;
+    }
+    return true;
+}
+
+static bool syncLog(int fd) {
+    return _commit(fd) == 0;
+}
+
+static void truncateLog(int fd, uint64_t size) {
+    _chsize_s(fd, static_cast<long long>(size));
+}
+
+static void closeLog(int fd) {
+    _close(fd);
+}
+#else
+static int openLog(const std::string& path) {
+    return ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+}
+
+static bool writeAt(int fd, uint64_t offset, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        offset += static_cast<uint64_t>(n);
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool readAt(int fd, uint64_t offset, uint8_t* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        offset += static_cast<uint64_t>(n);
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool syncLog(int fd) {
+    int result;
+    do {
+        result = ::fsync(fd);
+    } while (result != 0 && errno == EINTR);
+    return result == 0;
+}
+
+static void truncateLog(int fd, uint64_t size) {
+    (void)::ftruncate(fd, static_cast<off_t>(size));
+}
+
+static void closeLog(int fd) {
+    ::close(fd);
+}
+#endif
+
+// Appends one framed record and returns the offset of its body in `out`
+static size_t encodeRecord(std::vector<uint8_t>& out, const MessageDigest& digest, const KeysetId& keyset,
+                           const Polynomial& signature) {
+    const uint64_t q = signature.getModulus();
+    const size_t n = signature.degree();
+    const size_t body_size = BODY_HEADER_SIZE + packedSize(n, q);
+
+    putLE(out, body_size, 4);
+    const size_t body = out.size();
+    out.insert(out.end(), digest.begin(), digest.end());
+    out.insert(out.end(), keyset.begin(), keyset.end());
+    putLE(out, n, 4);
+    putLE(out, q, 8);
+    packCoefficients(signature, out);
+
+    putLE(out, fnv1a(out.data() + body, body_size), 4);
+    return body;
+}
+
+MessageDigest digestBlindedMessage(const Polynomial& blinded) {
+    const uint64_t q = blinded.getModulus();
+    std::vector<uint8_t> encoding;
+    encoding.reserve(16 + packedSize(blinded.degree(), q));
+    putLE(encoding, blinded.degree(), 8);
+    putLE(encoding, q, 8);
+    packCoefficients(blinded, encoding);
+
+    MessageDigest digest;
+    SHA256::hash(encoding.data(), encoding.size(), digest.data());
+    return digest;
+}
+
+size_t SignatureIndex::DigestHash::operator()(const MessageDigest& d) const {
+    // The digest is already uniformly distributed
+    size_t h;
+    std::memcpy(&h, d.data(), sizeof(h));
+    return h;
+}
+
+size_t SignatureIndex::shardOf(const MessageDigest& digest) {
+    // DigestHash uses the leading bytes; take the shard from the other end
+    return digest.back() % SHARDS;
+}
+
+SignatureIndex::SignatureIndex(const std::string& index_path) : path(index_path) {
+    if (!std::filesystem::exists(path) || std::filesystem::file_size(path) == 0) {
+        std::ofstream create(path, std::ios::binary | std::ios::trunc);
+        create.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        if (!create) {
+            throw std::runtime_error("Cannot create signature index " + path);
+        }
+    }
+    replay();
+
+    fd = openLog(path);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open signature index " + path);
+    }
+}
+
+SignatureIndex::~SignatureIndex() {
+    syncLog(fd);
+    closeLog(fd);
+}
+
+void SignatureIndex::replay() {
+    std::ifstream in(path, std::ios::binary);
+    const uint64_t file_size = std::filesystem::file_size(path);
+    char magic[sizeof(INDEX_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw std::runtime_error(path + " is not a signature index");
+    }
+
+    // Records are read one at a time, so opening a large index needs
+    // memory for its locations only.
+    //
+    // An interrupted append can only leave its damage in the last record,
+    // so a bad record that runs to the end of the file is cut off. One with
+    // intact records after it is corruption, and the file is left alone
+    std::vector<uint8_t> record;
+    uint64_t pos = sizeof(INDEX_MAGIC);
+    while (pos != file_size) {
+        const uint64_t remaining = file_size - pos;
+        uint8_t length[4];
+        if (remaining >= 4 && !in.read(reinterpret_cast<char*>(length), 4)) {
+            throw std::runtime_error("Cannot read signature index " + path);
+        }
+        const uint64_t body_size = remaining >= 4 ? getLE(length, 4) : 0;
+        const bool complete = remaining >= 4 && remaining - 4 >= body_size + 4;
+        bool valid = complete && body_size >= BODY_HEADER_SIZE;
+        if (valid) {
+            record.resize(body_size + 4);
+            if (!in.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(record.size()))) {
+                throw std::runtime_error("Cannot read signature index " + path);
+            }
+            const uint8_t* body = record.data();
+            valid = getLE(body + body_size, 4) == fnv1a(body, body_size);
+            if (valid) {
+                const uint64_t n = getLE(body + 40, 4);
+                const uint64_t q = getLE(body + 44, 8);
+                valid = q >= 2 && body_size == BODY_HEADER_SIZE + packedSize(n, q);
+            }
+        }
+        if (!valid) {
+            if (complete && remaining - 4 > body_size + 4) {
+                throw std::runtime_error("Corrupt record at offset " + std::to_string(pos) + " of signature index " +
+                                         path);
+            }
+            in.close();
+            std::filesystem::resize_file(path, pos);
+            break;
+        }
+
+        MessageDigest digest;
+        std::copy(record.begin(), record.begin() + digest.size(), digest.begin());
+        shards[shardOf(digest)].locations[digest] = {pos + 4, static_cast<uint32_t>(body_size)};
+        pos += 4 + body_size + 4;
+    }
+    end = pos;
+}
+
+void SignatureIndex::record(const Polynomial& blinded, const Polynomial& blind_signature, const KeysetId& keyset) {
+    recordBatch({blinded}, {blind_signature}, keyset);
+}
+
+void SignatureIndex::recordBatch(const std::vector<Polynomial>& blinded,
+                                 const std::vector<Polynomial>& blind_signatures, const KeysetId& keyset) {
+    if (blinded.size() != blind_signatures.size()) {
+        throw std::invalid_argument("Number of blinded messages and signatures must match");
+    }
+
+    // Hash and encode before taking any lock
+    std::vector<MessageDigest> digests(blinded.size());
+    std::vector<uint8_t> framed;
+    std::vector<size_t> body_offsets(blinded.size());
+    for (size_t k = 0; k < blinded.size(); k++) {
+        digests[k] = digestBlindedMessage(blinded[k]);
+        body_offsets[k] = encodeRecord(framed, digests[k], keyset, blind_signatures[k]);
+    }
+    append(digests, framed, body_offsets);
+}
+
+void SignatureIndex::append(const std::vector<MessageDigest>& digests, const std::vector<uint8_t>& framed,
+                            const std::vector<size_t>& body_offsets) {
+    // The log lock orders the appends; lookups only wait for the shard
+    // updates below, which happen after the records are in the file
+    std::lock_guard<std::mutex> log_lock(log_mutex);
+    const uint64_t base = end;
+    if (!writeAt(fd, base, framed.data(), framed.size())) {
+        // Cut off a partial write, so the next append does not leave a torn
+        // record in the middle of the log
+        truncateLog(fd, base);
+        throw std::runtime_error("Failed to append to signature index " + path);
+    }
+
+    for (size_t k = 0; k < digests.size(); k++) {
+        const uint32_t body_size = static_cast<uint32_t>(getLE(framed.data() + body_offsets[k] - 4, 4));
+        Shard& shard = shards[shardOf(digests[k])];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.locations[digests[k]] = {base + body_offsets[k], body_size};
+    }
+    end = base + framed.size();
+}
+
+static IssuedSignature decodeBody(const uint8_t* body) {
+    KeysetId keyset;
+    std::copy(body + 32, body + 40, keyset.begin());
+    const size_t n = static_cast<size_t>(getLE(body + 40, 4));
+    const uint64_t q = getLE(body + 44, 8);
+
+    Polynomial signature(n, q);
+    unpackCoefficients(body + BODY_HEADER_SIZE, signature);
+    return {keyset, std::move(signature)};
+}
+
+std::vector<std::optional<IssuedSignature>> SignatureIndex::lookup(const std::vector<MessageDigest>& digests) const {
+    // Only the locations are read under the shard locks; records never
+    // move once written, so they are read from the file afterwards
+    std::vector<std::pair<Location, size_t>> found;
+    for (size_t k = 0; k < digests.size(); k++) {
+        const Shard& shard = shards[shardOf(digests[k])];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.locations.find(digests[k]);
+        if (it != shard.locations.end()) {
+            found.push_back({it->second, k});
+        }
+    }
+
+    // In file order, so a large restore query reads the log front to back
+    std::sort(found.begin(), found.end(), [](const auto& x, const auto& y) {
+        return x.first.offset < y.first.offset;
+    });
+    std::vector<std::optional<IssuedSignature>> result(digests.size());
+    std::vector<uint8_t> body;
+    for (const auto& [location, k] : found) {
+        body.resize(location.size + 4);
+        if (!readAt(fd, location.offset, body.data(), body.size())) {
+            throw std::runtime_error("Cannot read signature index " + path);
+        }
+        if (getLE(body.data() + location.size, 4) != fnv1a(body.data(), location.size)) {
+            throw std::runtime_error("Corrupt record at offset " + std::to_string(location.offset - 4) +
+                                     " of signature index " + path);
+        }
+        result[k] = decodeBody(body.data());
+    }
+    return result;
+}
+
+std::vector<std::optional<Polynomial>> SignatureIndex::lookup(const std::vector<Polynomial>& blinded) const {
+    std::vector<MessageDigest> digests(blinded.size());
+    for (size_t k = 0; k < blinded.size(); k++) {
+        digests[k] = digestBlindedMessage(blinded[k]);
+    }
+
+    std::vector<std::optional<IssuedSignature>> issued = lookup(digests);
+    std::vector<std::optional<Polynomial>> result(issued.size());
+    for (size_t k = 0; k < issued.size(); k++) {
+        if (issued[k]) {
+            result[k] = std::move(issued[k]->blind_signature);
+        }
+    }
+    return result;
+}
+
+void SignatureIndex::flush() {
+    if (!syncLog(fd)) {
+        throw std::runtime_error("Cannot sync signature index " + path);
+    }
+}
+
+size_t SignatureIndex::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.locations.size();
+    }
+    return total;
+}
+
+size_t SignatureIndex::storedBytes() const {
+    return static_cast<size_t>(end - sizeof(INDEX_MAGIC));
+}
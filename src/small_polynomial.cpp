@@ -0,0 +1,152 @@
+#include <small_polynomial.h>
+#include <ntt.h>
+#include <sampler.h>
+#include <sstream>
+#include <stdexcept>
+
+SmallPolynomial::SmallPolynomial(size_t n, uint64_t q)
+    : coeffs(n, 0), ring_dim(n), modulus(q)
+{
+}
+
+SmallPolynomial::SmallPolynomial(const std::vector<int64_t>& values, uint64_t q)
+    : coeffs(values.size()), ring_dim(values.size()), modulus(q)
+{
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] > MAX_COEFF || values[i] < -MAX_COEFF) {
+            throw std::invalid_argument("Coefficient " + std::to_string(values[i]) +
+                                        " does not fit a small polynomial");
+        }
+        // Centered values round-trip through Z_q only if 2|v| < q
+        if (2 * static_cast<uint64_t>(values[i] < 0 ? -values[i] : values[i]) >= q) {
+            throw std::invalid_argument("Coefficient " + std::to_string(values[i]) +
+                                        " does not fit modulus " + std::to_string(q));
+        }
+        coeffs[i] = static_cast<int8_t>(values[i]);
+    }
+}
+
+SmallPolynomial SmallPolynomial::fromPolynomial(const Polynomial& p) {
+    const uint64_t q = p.getModulus();
+    const CoeffView in = p.getCoeffs();
+    SmallPolynomial result(p.degree(), q);
+    for (size_t i = 0; i < in.size(); i++) {
+        const uint64_t c = in[i] % q;
+        const int64_t centered = c > q / 2 ? -static_cast<int64_t>(q - c) : static_cast<int64_t>(c);
+        if (centered > MAX_COEFF || centered < -MAX_COEFF) {
+            throw std::invalid_argument("Polynomial coefficients are not small");
+        }
+        result.coeffs[i] = static_cast<int8_t>(centered);
+    }
+    return result;
+}
+
+SmallPolynomial SmallPolynomial::sampleGaussian(const uint64_t* words, const ParameterSet& params) {
+    SmallPolynomial result(params.n, params.q);
+    GaussianSampler::sampleCentered(result.coeffs.data(), words, params.n, params);
+    return result;
+}
+
+void SmallPolynomial::widen(uint64_t* out) const {
+    for (size_t i = 0; i < ring_dim; i++) {
+        const int64_t c = coeffs[i];
+        const uint64_t m = static_cast<uint64_t>(c < 0 ? -c : c) % modulus;
+        out[i] = (c < 0 && m != 0) ? modulus - m : m;
+    }
+}
+
+Polynomial SmallPolynomial::toPolynomial() const {
+    Polynomial result(ring_dim, modulus);
+    widen(result.data());
+    return result;
+}
+
+Polynomial SmallPolynomial::addTo(const Polynomial& full) const {
+    if (full.degree() != ring_dim || full.getModulus() != modulus) {
+        throw std::invalid_argument("Polynomials must be in the same ring");
+    }
+    Polynomial result(ring_dim, modulus);
+    const CoeffView f = full.getCoeffs();
+    uint64_t* out = result.data();
+    widen(out);
+    for (size_t i = 0; i < ring_dim; i++) {
+        const uint64_t sum = out[i] + f[i] % modulus;
+        out[i] = sum >= modulus ? sum - modulus : sum;
+    }
+    return result;
+}
+
+Polynomial SmallPolynomial::multiply(const Polynomial& full) const {
+    if (full.degree() != ring_dim || full.getModulus() != modulus) {
+        throw std::invalid_argument("Polynomials must be in the same ring");
+    }
+
+    const bool direct_fits = ring_dim <= DIRECT_MAX_N &&
+                             modulus <= (uint64_t(1) << 31) / (uint64_t(MAX_COEFF) * ring_dim);
+    if (direct_fits) {
+        return multiplyDirect(full);
+    }
+    const ParameterSet* ntt = ParameterSet::nttTables(ring_dim, modulus);
+    if (ntt == nullptr) {
+        return toPolynomial() * full;
+    }
+    const ParameterSet& params = *ntt;
+
+    Polynomial result(ring_dim, modulus);
+    Polynomial other(ring_dim, modulus);
+    uint64_t* fa = result.data();
+    uint64_t* fb = other.data();
+    const CoeffView f = full.getCoeffs();
+    widen(fa);
+    for (size_t i = 0; i < ring_dim; i++) {
+        fb[i] = f[i] < modulus ? f[i] : f[i] % modulus;
+    }
+    NTT::forward(fa, params);
+    NTT::forward(fb, params);
+    NTT::pointwise(fa, fa, fb, params);
+    NTT::inverse(fa, params);
+    return result;
+}
+
+Polynomial SmallPolynomial::multiplyDirect(const Polynomial& full) const {
+    const size_t n = ring_dim;
+    const uint64_t q = modulus;
+
+    // |sum| <= n * MAX_COEFF * (q - 1) fits a signed 32-bit word, so
+    // the accumulators and the widened full operand are 32 bits wide
+    int32_t f[DIRECT_MAX_N];
+    int32_t acc[DIRECT_MAX_N] = {};
+    const CoeffView in = full.getCoeffs();
+    for (size_t j = 0; j < n; j++) {
+        f[j] = static_cast<int32_t>(in[j] < q ? in[j] : in[j] % q);
+    }
+
+    // Each row sign-extends one byte and adds it times the full operand;
+    // x^(i+j) with i + j >= n wraps with its sign flipped
+    for (size_t i = 0; i < n; i++) {
+        const int32_t w = coeffs[i];
+        if (w == 0) continue;
+        for (size_t j = 0; j < n - i; j++) acc[i + j] += w * f[j];
+        for (size_t j = n - i; j < n; j++) acc[i + j - n] -= w * f[j];
+    }
+
+    Polynomial result(n, q);
+    uint64_t* out = result.data();
+    const int32_t sq = static_cast<int32_t>(q);
+    for (size_t k = 0; k < n; k++) {
+        const int32_t v = acc[k] % sq;
+        out[k] = static_cast<uint64_t>(v < 0 ? v + sq : v);
+    }
+    return result;
+}
+
+std::string SmallPolynomial::toString() const {
+    std::stringstream ss;
+    ss << "SmallPolynomial(dim=" << ring_dim << ", q=" << modulus << "): [";
+    for (size_t i = 0; i < ring_dim; i++) {
+        if (i > 0) ss << ", ";
+        ss << static_cast<int>(coeffs[i]);
+    }
+    ss << "]";
+    return ss.str();
+}
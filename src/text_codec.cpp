@@ -0,0 +1,310 @@
+#include <text_codec.h>
+#include <polynomial_codec.h>
+#include "bit_packing.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// Characters are classified and mapped this many at a time
+static constexpr size_t BLOCK = 256;
+
+// Marks a character outside the alphabet; any 6-bit or 4-bit value ORed
+// with it keeps the top bit set
+static constexpr uint8_t INVALID = 0x80;
+
+// 6-bit value to base64url character, as a chain of selects rather than a
+// table so that the loop over a block vectorizes
+static inline uint8_t base64Char(uint8_t v) {
+    uint8_t c = v + 'A';
+    c = v >= 26 ? static_cast<uint8_t>(v + ('a' - 26)) : c;
+    c = v >= 52 ? static_cast<uint8_t>(v - (52 - '0')) : c;
+    c = v == 62 ? static_cast<uint8_t>('-') : c;
+    c = v == 63 ? static_cast<uint8_t>('_') : c;
+    return c;
+}
+
+static inline uint8_t base64Value(uint8_t c) {
+    uint8_t v = INVALID;
+    v = (c >= 'A' && c <= 'Z') ? static_cast<uint8_t>(c - 'A') : v;
+    v = (c >= 'a' && c <= 'z') ? static_cast<uint8_t>(c - ('a' - 26)) : v;
+    v = (c >= '0' && c <= '9') ? static_cast<uint8_t>(c + (52 - '0')) : v;
+    v = c == '-' ? 62 : v;
+    v = c == '_' ? 63 : v;
+    return v;
+}
+
+static inline uint8_t hexValue(uint8_t c) {
+    uint8_t v = INVALID;
+    v = (c >= '0' && c <= '9') ? static_cast<uint8_t>(c - '0') : v;
+    v = (c >= 'a' && c <= 'f') ? static_cast<uint8_t>(c - ('a' - 10)) : v;
+    v = (c >= 'A' && c <= 'F') ? static_cast<uint8_t>(c - ('A' - 10)) : v;
+    return v;
+}
+
+// Maps count characters to their values and reports whether all were valid
+template <uint8_t (*Value)(uint8_t)>
+static bool classify(const char* in, size_t count, uint8_t* values) {
+    const uint8_t* chars = reinterpret_cast<const uint8_t*>(in);
+    uint8_t invalid = 0;
+    #pragma omp simd reduction(|:invalid)
+    for (size_t i = 0; i < count; i++) {
+        values[i] = Value(chars[i]);
+        invalid |= values[i];
+    }
+    return (invalid & INVALID) == 0;
+}
+
+size_t base64urlEncodedSize(size_t bytes) {
+    return bytes / 3 * 4 + (bytes % 3 == 0 ? 0 : bytes % 3 + 1);
+}
+
+size_t base64urlDecodedSize(size_t chars) {
+    if (chars % 4 == 1) {
+        throw std::invalid_argument("Invalid base64url length");
+    }
+    return chars / 4 * 3 + (chars % 4 == 0 ? 0 : chars % 4 - 1);
+}
+
+// Six bytes, as the top 48 bits of bytes, split into eight 6-bit values
+// stored first to last in the bytes of the result, least significant first
+static inline uint64_t splitSextets(uint64_t bytes) {
+    uint64_t x = (bytes >> 40) | ((bytes >> 16 & 0xffffff) << 32);
+    x = (x >> 12 & 0x00000fff00000fffULL) | ((x & 0x00000fff00000fffULL) << 16);
+    return (x >> 6 & 0x003f003f003f003fULL) | ((x & 0x003f003f003f003fULL) << 8);
+}
+
+// Inverse of splitSextets(): eight 6-bit values to six bytes in the top 48
+// bits of the result
+static inline uint64_t joinSextets(uint64_t values) {
+    uint64_t x = ((values & 0x00ff00ff00ff00ffULL) << 6) | (values >> 8 & 0x00ff00ff00ff00ffULL);
+    x = ((x & 0x0000ffff0000ffffULL) << 12) | (x >> 16 & 0x0000ffff0000ffffULL);
+    return ((x & 0xffffff) << 40) | (x >> 32 << 16);
+}
+
+void base64urlEncode(const uint8_t* in, size_t size, char* out) {
+    uint8_t values[BLOCK];
+    const size_t full = size / 3 * 3;
+    for (size_t pos = 0; pos < full;) {
+        const size_t groups = std::min(BLOCK / 4, (full - pos) / 3);
+        const uint8_t* src = in + pos;
+        // Six bytes at a time while eight can be loaded, then three
+        size_t g = 0;
+        for (; g + 2 <= groups && pos + 3 * g + 8 <= size; g += 2) {
+            storeLE64(values + 4 * g, splitSextets(loadBE64(src + 3 * g)));
+        }
+        for (; g < groups; g++) {
+            const uint32_t word = (uint32_t(src[3 * g]) << 16) | (uint32_t(src[3 * g + 1]) << 8) | src[3 * g + 2];
+            values[4 * g] = static_cast<uint8_t>(word >> 18);
+            values[4 * g + 1] = static_cast<uint8_t>((word >> 12) & 0x3f);
+            values[4 * g + 2] = static_cast<uint8_t>((word >> 6) & 0x3f);
+            values[4 * g + 3] = static_cast<uint8_t>(word & 0x3f);
+        }
+        #pragma omp simd
+        for (size_t i = 0; i < 4 * groups; i++) {
+            out[i] = static_cast<char>(base64Char(values[i]));
+        }
+        pos += 3 * groups;
+        out += 4 * groups;
+    }
+
+    const size_t tail = size - full;
+    if (tail > 0) {
+        const uint8_t* src = in + full;
+        const uint32_t word = (uint32_t(src[0]) << 16) | (tail == 2 ? uint32_t(src[1]) << 8 : 0);
+        out[0] = static_cast<char>(base64Char(static_cast<uint8_t>(word >> 18)));
+        out[1] = static_cast<char>(base64Char(static_cast<uint8_t>((word >> 12) & 0x3f)));
+        if (tail == 2) {
+            out[2] = static_cast<char>(base64Char(static_cast<uint8_t>((word >> 6) & 0x3f)));
+        }
+    }
+}
+
+void base64urlDecode(const char* in, size_t size, uint8_t* out) {
+    const size_t tail = size % 4;
+    if (tail == 1) {
+        throw std::invalid_argument("Invalid base64url length");
+    }
+    uint8_t values[BLOCK];
+    const size_t full = size - tail;
+    const size_t out_size = base64urlDecodedSize(size);
+    for (size_t pos = 0; pos < full;) {
+        const size_t count = std::min(BLOCK, full - pos);
+        if (!classify<base64Value>(in + pos, count, values)) {
+            throw std::invalid_argument("Invalid base64url character");
+        }
+        // Eight characters at a time while eight bytes can be stored,
+        // then four
+        size_t g = 0;
+        for (; g + 2 <= count / 4 && pos / 4 * 3 + 3 * g + 8 <= out_size; g += 2) {
+            storeBE64(out + 3 * g, joinSextets(loadLE64(values + 4 * g)));
+        }
+        for (; g < count / 4; g++) {
+            const uint32_t word = (uint32_t(values[4 * g]) << 18) | (uint32_t(values[4 * g + 1]) << 12) |
+                                  (uint32_t(values[4 * g + 2]) << 6) | values[4 * g + 3];
+            out[3 * g] = static_cast<uint8_t>(word >> 16);
+            out[3 * g + 1] = static_cast<uint8_t>(word >> 8);
+            out[3 * g + 2] = static_cast<uint8_t>(word);
+        }
+        pos += count;
+        out += count / 4 * 3;
+    }
+
+    if (tail > 0) {
+        if (!classify<base64Value>(in + full, tail, values)) {
+            throw std::invalid_argument("Invalid base64url character");
+        }
+        const uint32_t word = (uint32_t(values[0]) << 18) | (uint32_t(values[1]) << 12) |
+                              (tail == 3 ? uint32_t(values[2]) << 6 : 0);
+        // The bits past the last whole byte must be zero, so every byte
+        // string has exactly one encoding
+        if ((word & (tail == 3 ? 0xff : 0xffff)) != 0) {
+            throw std::invalid_argument("Non-canonical base64url encoding");
+        }
+        out[0] = static_cast<uint8_t>(word >> 16);
+        if (tail == 3) {
+            out[1] = static_cast<uint8_t>(word >> 8);
+        }
+    }
+}
+
+void hexEncode(const uint8_t* in, size_t size, char* out) {
+    #pragma omp simd
+    for (size_t i = 0; i < size; i++) {
+        const uint8_t hi = in[i] >> 4;
+        const uint8_t lo = in[i] & 0x0f;
+        out[2 * i] = static_cast<char>(hi + (hi < 10 ? '0' : 'a' - 10));
+        out[2 * i + 1] = static_cast<char>(lo + (lo < 10 ? '0' : 'a' - 10));
+    }
+}
+
+void hexDecode(const char* in, size_t size, uint8_t* out) {
+    if (size % 2 != 0) {
+        throw std::invalid_argument("Hex string has odd length");
+    }
+    uint8_t values[BLOCK];
+    for (size_t pos = 0; pos < size;) {
+        const size_t count = std::min(BLOCK, size - pos);
+        if (!classify<hexValue>(in + pos, count, values)) {
+            throw std::invalid_argument("Invalid hex character");
+        }
+        #pragma omp simd
+        for (size_t i = 0; i < count / 2; i++) {
+            out[i] = static_cast<uint8_t>((values[2 * i] << 4) | values[2 * i + 1]);
+        }
+        pos += count;
+        out += count / 2;
+    }
+}
+
+size_t Base64urlEncoder::update(const uint8_t* in, size_t size, char* out) {
+    size_t written = 0;
+    if (pending_size > 0) {
+        const size_t take = std::min(size, 3 - pending_size);
+        std::copy(in, in + take, pending + pending_size);
+        pending_size += take;
+        in += take;
+        size -= take;
+        if (pending_size < 3) {
+            return 0;
+        }
+        base64urlEncode(pending, 3, out);
+        pending_size = 0;
+        written = 4;
+    }
+    const size_t full = size / 3 * 3;
+    base64urlEncode(in, full, out + written);
+    written += full / 3 * 4;
+    pending_size = size - full;
+    std::copy(in + full, in + size, pending);
+    return written;
+}
+
+size_t Base64urlEncoder::finish(char* out) {
+    const size_t written = base64urlEncodedSize(pending_size);
+    base64urlEncode(pending, pending_size, out);
+    pending_size = 0;
+    return written;
+}
+
+size_t Base64urlDecoder::update(const char* in, size_t size, uint8_t* out) {
+    size_t written = 0;
+    if (pending_size > 0) {
+        const size_t take = std::min(size, 4 - pending_size);
+        std::copy(in, in + take, pending + pending_size);
+        pending_size += take;
+        in += take;
+        size -= take;
+        if (pending_size < 4) {
+            return 0;
+        }
+        base64urlDecode(pending, 4, out);
+        pending_size = 0;
+        written = 3;
+    }
+    const size_t full = size / 4 * 4;
+    base64urlDecode(in, full, out + written);
+    written += full / 4 * 3;
+    pending_size = size - full;
+    std::copy(in + full, in + size, pending);
+    return written;
+}
+
+size_t Base64urlDecoder::finish(uint8_t* out) {
+    const size_t written = base64urlDecodedSize(pending_size);
+    base64urlDecode(pending, pending_size, out);
+    pending_size = 0;
+    return written;
+}
+
+static std::vector<uint8_t>& scratch() {
+    thread_local std::vector<uint8_t> buffer;
+    buffer.clear();
+    return buffer;
+}
+
+void appendPolynomialBase64url(const Polynomial& p, std::string& out) {
+    appendCoefficientsBase64url(p.getCoeffs().data(), p.degree(), p.getModulus(), out);
+}
+
+void appendCoefficientsBase64url(const uint64_t* coeffs, size_t n, uint64_t q, std::string& out) {
+    std::vector<uint8_t>& packed = scratch();
+    packed.resize(packedSize(n, q));
+    packCoefficients(coeffs, n, q, packed.data());
+    const size_t start = out.size();
+    out.resize(start + base64urlEncodedSize(packed.size()));
+    base64urlEncode(packed.data(), packed.size(), &out[start]);
+}
+
+void appendPolynomialHex(const Polynomial& p, std::string& out) {
+    std::vector<uint8_t>& packed = scratch();
+    packCoefficients(p, packed);
+    const size_t start = out.size();
+    out.resize(start + hexEncodedSize(packed.size()));
+    hexEncode(packed.data(), packed.size(), &out[start]);
+}
+
+void decodePolynomialBase64url(const char* in, size_t size, Polynomial& p) {
+    decodeCoefficientsBase64url(in, size, p.degree(), p.getModulus(), p.data());
+}
+
+void decodeCoefficientsBase64url(const char* in, size_t size, size_t n, uint64_t q, uint64_t* coeffs) {
+    const size_t bytes = packedSize(n, q);
+    if (size != base64urlEncodedSize(bytes)) {
+        throw std::invalid_argument("Encoded polynomial has the wrong length");
+    }
+    std::vector<uint8_t>& packed = scratch();
+    packed.resize(bytes);
+    base64urlDecode(in, size, packed.data());
+    unpackCoefficients(packed.data(), n, q, coeffs);
+}
+
+void decodePolynomialHex(const char* in, size_t size, Polynomial& p) {
+    const size_t bytes = packedSize(p.degree(), p.getModulus());
+    if (size != hexEncodedSize(bytes)) {
+        throw std::invalid_argument("Encoded polynomial has the wrong length");
+    }
+    std::vector<uint8_t>& packed = scratch();
+    packed.resize(bytes);
+    hexDecode(in, size, packed.data());
+    unpackCoefficients(packed.data(), p);
+}
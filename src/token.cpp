@@ -0,0 +1,309 @@
+#include <token.h>
+#include <polynomial_codec.h>
+#include "cbor.h"
+#include <algorithm>
+#include <stdexcept>
+
+void PolynomialView::unpack(Polynomial& p) const {
+    if (p.degree() != n || p.getModulus() != q) {
+        throw std::invalid_argument("Polynomial is not in the view's ring");
+    }
+    unpackCoefficients(data, p);
+}
+
+Polynomial PolynomialView::toPolynomial() const {
+    Polynomial p(n, q);
+    unpack(p);
+    return p;
+}
+
+TokenWriter::TokenWriter(uint8_t* out, size_t size, std::string_view mint, std::string_view unit)
+    : buffer(out), capacity(size)
+{
+    cbor::Writer w(buffer, capacity);
+    w.indefinite(cbor::MAP);
+    w.key('m');
+    w.text(mint.data(), mint.size());
+    w.key('u');
+    w.text(unit.data(), unit.size());
+    w.key('t');
+    w.indefinite(cbor::ARRAY);
+    used = w.written();
+}
+
+void TokenWriter::beginKeyset(const KeysetId& keyset, size_t n, uint64_t q) {
+    cbor::Writer w(buffer + used, capacity - used);
+    if (keyset_open) {
+        w.endIndefinite();
+    }
+    w.head(cbor::MAP, 4);
+    w.key('i');
+    w.bytes(keyset.data(), keyset.size());
+    w.key('n');
+    w.head(cbor::UNSIGNED, n);
+    w.key('q');
+    w.head(cbor::UNSIGNED, q);
+    w.key('p');
+    w.indefinite(cbor::ARRAY);
+    used += w.written();
+    keyset_open = true;
+    ring_dim = n;
+    modulus = q;
+}
+
+void TokenWriter::addProof(uint64_t amount, const uint8_t* secret, size_t secret_size,
+                           const Polynomial& signature) {
+    if (!keyset_open) {
+        throw std::invalid_argument("Proofs must follow beginKeyset()");
+    }
+    if (signature.degree() != ring_dim || signature.getModulus() != modulus) {
+        throw std::invalid_argument("Signature is not in the keyset's ring");
+    }
+    const size_t packed = packedSize(ring_dim, modulus);
+    cbor::Writer w(buffer + used, capacity - used);
+    w.head(cbor::MAP, 3);
+    w.key('a');
+    w.head(cbor::UNSIGNED, amount);
+    w.key('s');
+    w.bytes(secret, secret_size);
+    w.key('c');
+    w.head(cbor::BYTES, packed);
+    packCoefficients(signature, w.reserve(packed));
+    used += w.written();
+}
+
+size_t TokenWriter::finish() {
+    cbor::Writer w(buffer + used, capacity - used);
+    if (keyset_open) {
+        w.endIndefinite();
+        keyset_open = false;
+    }
+    w.endIndefinite();
+    w.endIndefinite();
+    used += w.written();
+    return used;
+}
+
+size_t TokenWriter::headerSize(std::string_view mint, std::string_view unit) {
+    using cbor::Writer;
+    // Map and "t" array heads and breaks, and the three keys
+    return 4 + 3 * 2 + Writer::headSize(mint.size()) + mint.size() + Writer::headSize(unit.size()) + unit.size();
+}
+
+size_t TokenWriter::keysetSize(size_t n, uint64_t q) {
+    using cbor::Writer;
+    // Map head, four keys, the "p" array's head and break
+    return 1 + 4 * 2 + 2 + Writer::headSize(8) + 8 + Writer::headSize(n) + Writer::headSize(q);
+}
+
+size_t TokenWriter::proofSize(uint64_t amount, size_t secret_size, size_t n, uint64_t q) {
+    using cbor::Writer;
+    const size_t packed = packedSize(n, q);
+    return 1 + 3 * 2 + Writer::headSize(amount) + Writer::headSize(secret_size) + secret_size +
+           Writer::headSize(packed) + packed;
+}
+
+static bool startsGroup(const std::vector<TokenProof>& proofs, size_t k) {
+    if (k == 0) return true;
+    const TokenProof& prev = proofs[k - 1];
+    const TokenProof& cur = proofs[k];
+    return cur.keyset != prev.keyset || cur.signature->degree() != prev.signature->degree() ||
+           cur.signature->getModulus() != prev.signature->getModulus();
+}
+
+size_t TokenWriter::tokenSize(std::string_view mint, std::string_view unit, const std::vector<TokenProof>& proofs) {
+    size_t size = headerSize(mint, unit);
+    for (size_t k = 0; k < proofs.size(); k++) {
+        const Polynomial& sig = *proofs[k].signature;
+        if (startsGroup(proofs, k)) {
+            size += keysetSize(sig.degree(), sig.getModulus());
+        }
+        size += proofSize(proofs[k].amount, proofs[k].secret_size, sig.degree(), sig.getModulus());
+    }
+    return size;
+}
+
+size_t TokenWriter::write(uint8_t* out, size_t capacity, std::string_view mint, std::string_view unit,
+                          const std::vector<TokenProof>& proofs) {
+    TokenWriter writer(out, capacity, mint, unit);
+    for (size_t k = 0; k < proofs.size(); k++) {
+        const Polynomial& sig = *proofs[k].signature;
+        if (startsGroup(proofs, k)) {
+            writer.beginKeyset(proofs[k].keyset, sig.degree(), sig.getModulus());
+        }
+        writer.addProof(proofs[k].amount, proofs[k].secret, proofs[k].secret_size, sig);
+    }
+    return writer.finish();
+}
+
+std::vector<uint8_t> writeToken(std::string_view mint, std::string_view unit, const std::vector<TokenProof>& proofs) {
+    std::vector<uint8_t> token(TokenWriter::tokenSize(mint, unit, proofs));
+    TokenWriter::write(token.data(), token.size(), mint, unit, proofs);
+    return token;
+}
+
+static std::string_view textValue(cbor::Reader& r) {
+    size_t size = 0;
+    const uint8_t* text = r.string(cbor::TEXT, size);
+    return std::string_view(reinterpret_cast<const char*>(text), size);
+}
+
+TokenReader::TokenReader(const uint8_t* token, size_t token_size) : data(token), size(token_size) {
+    cbor::Reader r(data, size);
+    const cbor::Reader::Head map = r.expect(cbor::MAP);
+    bool has_mint = false;
+    bool has_unit = false;
+    for (uint64_t i = 0; map.indefinite ? !r.consumeBreak() : i < map.value; i++) {
+        switch (r.key()) {
+        case 'm':
+            mint_url = textValue(r);
+            has_mint = true;
+            break;
+        case 'u':
+            token_unit = textValue(r);
+            has_unit = true;
+            break;
+        case 'd':
+            token_memo = textValue(r);
+            break;
+        case 't':
+            // Proofs are read lazily; checking the structure here means
+            // next() can only fail on the meaning of an entry
+            proofs_start = r.position();
+            r.expect(cbor::ARRAY);
+            r.seek(proofs_start);
+            r.skip();
+            break;
+        default:
+            r.skip();
+            break;
+        }
+    }
+    if (!r.atEnd()) {
+        throw std::invalid_argument("Trailing bytes after token");
+    }
+    if (!has_mint || !has_unit || proofs_start == nullptr) {
+        throw std::invalid_argument("Token lacks a mint, unit or proofs");
+    }
+    rewind();
+}
+
+void TokenReader::rewind() {
+    cbor::Reader r(proofs_start, static_cast<size_t>(data + size - proofs_start));
+    const cbor::Reader::Head array = r.expect(cbor::ARRAY);
+    groups = {array.value, array.indefinite};
+    in_proofs = false;
+    cursor = r.position();
+}
+
+// Whether an array or map being read has another entry; consumes the
+// BREAK or counts the entry
+static bool hasNext(cbor::Reader& r, uint64_t& count, bool indefinite) {
+    if (indefinite) {
+        return !r.consumeBreak();
+    }
+    if (count == 0) {
+        return false;
+    }
+    count--;
+    return true;
+}
+
+bool TokenReader::next(ProofView& proof) {
+    cbor::Reader r(cursor, static_cast<size_t>(data + size - cursor));
+    while (true) {
+        if (in_proofs) {
+            if (hasNext(r, proofs.count, proofs.indefinite)) {
+                break;
+            }
+            in_proofs = false;
+            while (hasNext(r, group_entries.count, group_entries.indefinite)) {
+                r.key();
+                r.skip();
+            }
+        }
+        if (!hasNext(r, groups.count, groups.indefinite)) {
+            cursor = r.position();
+            return false;
+        }
+
+        // Keyset group: the ID and ring, then the proofs
+        const cbor::Reader::Head map = r.expect(cbor::MAP);
+        group_entries = {map.value, map.indefinite};
+        unsigned fields = 0;
+        while (!in_proofs && hasNext(r, group_entries.count, group_entries.indefinite)) {
+            switch (r.key()) {
+            case 'i': {
+                size_t id_size = 0;
+                const uint8_t* id = r.string(cbor::BYTES, id_size);
+                if (id_size != keyset.size()) {
+                    throw std::invalid_argument("Keyset ID must be 8 bytes");
+                }
+                std::copy(id, id + id_size, keyset.begin());
+                fields |= 1;
+                break;
+            }
+            case 'n':
+                ring_dim = static_cast<size_t>(std::min<uint64_t>(r.unsignedInt(), MAX_DEGREE + 1));
+                fields |= 2;
+                break;
+            case 'q':
+                modulus = r.unsignedInt();
+                fields |= 4;
+                break;
+            case 'p': {
+                if (fields != 7) {
+                    throw std::invalid_argument("Keyset ID and ring must precede the proofs");
+                }
+                if (ring_dim == 0 || ring_dim > MAX_DEGREE || modulus < 2) {
+                    throw std::invalid_argument("Invalid ring in token");
+                }
+                const cbor::Reader::Head array = r.expect(cbor::ARRAY);
+                proofs = {array.value, array.indefinite};
+                in_proofs = true;
+                break;
+            }
+            default:
+                r.skip();
+                break;
+            }
+        }
+    }
+
+    const cbor::Reader::Head map = r.expect(cbor::MAP);
+    Remaining entries{map.value, map.indefinite};
+    const size_t packed = packedSize(ring_dim, modulus);
+    unsigned fields = 0;
+    while (hasNext(r, entries.count, entries.indefinite)) {
+        switch (r.key()) {
+        case 'a':
+            proof.amount = r.unsignedInt();
+            fields |= 1;
+            break;
+        case 's':
+            proof.secret = r.string(cbor::BYTES, proof.secret_size);
+            fields |= 2;
+            break;
+        case 'c': {
+            size_t signature_size = 0;
+            proof.signature.data = r.string(cbor::BYTES, signature_size);
+            if (signature_size != packed) {
+                throw std::invalid_argument("Signature size does not match the keyset's ring");
+            }
+            fields |= 4;
+            break;
+        }
+        default:
+            r.skip();
+            break;
+        }
+    }
+    if (fields != 7) {
+        throw std::invalid_argument("Proof lacks an amount, secret or signature");
+    }
+    proof.keyset = keyset;
+    proof.signature.n = ring_dim;
+    proof.signature.q = modulus;
+    cursor = r.position();
+    return true;
+}
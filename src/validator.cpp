@@ -0,0 +1,74 @@
+#include <validator.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+ValidationResult PolynomialValidator::check(const Polynomial& p) const {
+    if (p.degree() != params->n) {
+        return ValidationResult::WrongDimension;
+    }
+    if (p.getModulus() != params->q) {
+        return ValidationResult::WrongModulus;
+    }
+
+    // One pass with no data-dependent branches, so it vectorizes
+    const uint64_t q = params->q;
+    const uint64_t* c = p.getCoeffs().data();
+    const size_t n = params->n;
+    uint64_t out_of_range = 0;
+    uint64_t zeros = 0;
+    uint64_t sum = 0;
+    uint64_t differs = 0;
+    for (size_t i = 0; i < n; i++) {
+        out_of_range |= static_cast<uint64_t>(c[i] >= q);
+        zeros += static_cast<uint64_t>(c[i] == 0);
+        sum += c[i];
+        differs |= c[i] ^ c[0];
+    }
+    if (out_of_range) {
+        return ValidationResult::CoefficientOutOfRange;
+    }
+    if (!check_distribution) {
+        return ValidationResult::OK;
+    }
+
+    // The moment tests below are too loose to catch a constant polynomial
+    // in a small ring (at n = 8 an all-zero input passes both), so one is
+    // rejected outright wherever a uniform draw is that unlikely to be one
+    const double nn = static_cast<double>(n);
+    const double qq = static_cast<double>(q);
+    if (!differs && (nn - 1) * std::log2(qq) >= CONSTANT_FLOOR_BITS) {
+        return ValidationResult::ImplausibleDistribution;
+    }
+
+    // Uniform on [0, q): zeros ~ Binomial(n, 1/q), sum has mean n(q-1)/2
+    // and variance n(q^2-1)/12
+    const double zero_mean = nn / qq;
+    const double zero_limit = zero_mean + 8.0 * std::sqrt(zero_mean) + 8.0;
+    const double sum_mean = nn * (qq - 1) / 2;
+    const double sum_sd = std::sqrt(nn * (qq * qq - 1) / 12);
+    if (static_cast<double>(zeros) > zero_limit ||
+        std::fabs(static_cast<double>(sum) - sum_mean) > 8.0 * sum_sd) {
+        return ValidationResult::ImplausibleDistribution;
+    }
+    return ValidationResult::OK;
+}
+
+void PolynomialValidator::validate(const Polynomial& p) const {
+    ValidationResult result = check(p);
+    if (result != ValidationResult::OK) {
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        throw std::invalid_argument(std::string("Rejected polynomial: ") + describe(result));
+    }
+}
+
+const char* PolynomialValidator::describe(ValidationResult result) {
+    switch (result) {
+        case ValidationResult::OK: return "ok";
+        case ValidationResult::WrongDimension: return "wrong ring dimension";
+        case ValidationResult::WrongModulus: return "wrong modulus";
+        case ValidationResult::CoefficientOutOfRange: return "coefficient not reduced mod q";
+        case ValidationResult::ImplausibleDistribution: return "coefficients not plausibly uniform";
+    }
+    return "unknown";
+}
@@ -0,0 +1,379 @@
+#include <verify_pipeline.h>
+#include <polynomial_batch.h>
+#include <polynomial_codec.h>
+#include <rlwe.h>
+#include <token.h>
+#include "bounded_queue.h"
+#include "primitives.h"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Proofs of one keyset and ring on their way through the stages
+struct Batch {
+    size_t token = 0;
+    KeysetId keyset{};
+    size_t n = 0;    // Ring the token declares for the proofs
+    uint64_t q = 0;
+    const RLWESignature* key = nullptr;  // Null if unknown or of another ring
+    ProofStatus rejected = ProofStatus::UnknownKeyset;  // Status of every proof without key
+    std::vector<VerifiedProof> proofs;
+    PolynomialBatch signatures{0, 0, 0};  // Row k unpacked from proof k
+    PolynomialBatch expected{0, 0, 0};    // Hash of secret k, then its product
+};
+
+using Queue = BoundedQueue<Batch*>;
+
+// State the workers of one run share. queues[i] feeds stage i + 1, and
+// the last stage hands batches back to the free pool for the first.
+struct Run {
+    const PipelineOptions& opts;
+    std::vector<std::unique_ptr<Batch>> pool;
+    std::unique_ptr<Queue> free;
+    std::array<std::unique_ptr<Queue>, VERIFY_STAGE_COUNT - 1> queues;
+    std::array<std::atomic<size_t>, VERIFY_STAGE_COUNT> running;  // Workers still going
+    std::atomic<size_t> next_token{0};
+    std::atomic<bool> failed{false};
+
+    std::mutex mutex;  // Guards error and stats, and serializes the sink
+    std::exception_ptr error;
+    PipelineStats stats;
+
+    explicit Run(const PipelineOptions& opts) : opts(opts) {
+        size_t batches = opts.queue_depth * queues.size();
+        for (size_t stage = 0; stage < VERIFY_STAGE_COUNT; stage++) {
+            running[stage].store(opts.workers[stage], std::memory_order_relaxed);
+            stats.stages[stage].workers = opts.workers[stage];
+            batches += opts.workers[stage];
+        }
+        // Enough batches to fill every queue and keep every worker busy
+        free = std::make_unique<Queue>(batches);
+        for (size_t i = 0; i < batches; i++) {
+            pool.push_back(std::make_unique<Batch>());
+            free->tryPush(pool.back().get());
+        }
+        for (auto& queue : queues) {
+            queue = std::make_unique<Queue>(opts.queue_depth);
+        }
+    }
+
+    // Keeps the first error; the stages then pass batches on untouched,
+    // or drop them, until the parse stage stops
+    void fail(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = e;
+        }
+        failed.store(true);
+        // Parked producers look at failed again
+        free->wake();
+        for (auto& queue : queues) {
+            queue->wake();
+        }
+    }
+
+    // Adds a worker's stats to its stage; the stage's last worker closes
+    // the queue after it
+    void finish(size_t stage, const StageStats& worker) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            StageStats& s = stats.stages[stage];
+            s.batches += worker.batches;
+            s.proofs += worker.proofs;
+            s.busy += worker.busy;
+            s.starved += worker.starved;
+            s.blocked += worker.blocked;
+        }
+        if (running[stage].fetch_sub(1, std::memory_order_acq_rel) == 1 && stage < queues.size()) {
+            queues[stage]->close();
+        }
+    }
+};
+
+// Splits a worker's wall time into the three parts of StageStats
+class StageTimer {
+public:
+    // Ends a span of the given kind (busy, starved or blocked)
+    void lap(std::chrono::nanoseconds& into) {
+        const Clock::time_point now = Clock::now();
+        into += now - last;
+        last = now;
+    }
+
+private:
+    Clock::time_point last = Clock::now();
+};
+
+void startBatch(Batch& batch, size_t token, const ProofView& proof, const VerifyPipeline::KeyLookup& keys) {
+    batch.token = token;
+    batch.keyset = proof.keyset;
+    batch.n = proof.signature.n;
+    batch.q = proof.signature.q;
+    batch.proofs.clear();
+    batch.key = keys(proof.keyset);
+    if (batch.key == nullptr) {
+        batch.rejected = ProofStatus::UnknownKeyset;
+        return;
+    }
+    const size_t n = batch.key->degree();
+    const uint64_t q = batch.key->getModulus();
+    if (proof.signature.n != n || proof.signature.q != q) {
+        batch.key = nullptr;
+        batch.rejected = ProofStatus::Invalid;
+        return;
+    }
+    if (batch.signatures.degree() != n || batch.signatures.getModulus() != q) {
+        batch.signatures = PolynomialBatch(0, n, q);
+        batch.expected = PolynomialBatch(0, n, q);
+    }
+    batch.signatures.resize(0);
+}
+
+void addProof(Batch& batch, const ProofView& proof, uint64_t index) {
+    VerifiedProof result;
+    result.token = batch.token;
+    result.index = index;
+    result.keyset = proof.keyset;
+    result.amount = proof.amount;
+    result.secret = proof.secret;
+    result.secret_size = proof.secret_size;
+    if (batch.key != nullptr) {
+        const size_t k = batch.proofs.size();
+        const size_t n = batch.signatures.degree();
+        const uint64_t q = batch.signatures.getModulus();
+        batch.signatures.resize(k + 1);
+        if (proof.signature.n != n || proof.signature.q != q) {
+            result.status = ProofStatus::Invalid;  // Would not fit the row
+        } else {
+            try {
+                unpackCoefficients(proof.signature.data, n, q, batch.signatures.row(k));
+            } catch (const std::invalid_argument&) {
+                result.status = ProofStatus::Invalid;  // A coefficient not below q
+            }
+        }
+    } else {
+        result.status = batch.rejected;
+    }
+    batch.proofs.push_back(result);
+}
+
+} // namespace
+
+const char* verifyStageName(VerifyStage stage) {
+    static const char* const NAMES[VERIFY_STAGE_COUNT] = {"parse", "hash", "multiply", "compare", "spent check"};
+    return NAMES[static_cast<size_t>(stage)];
+}
+
+VerifyStage PipelineStats::bottleneck() const {
+    size_t slowest = 0;
+    double slowest_ns = -1;
+    for (size_t stage = 0; stage < VERIFY_STAGE_COUNT; stage++) {
+        if (stages[stage].workers == 0) {
+            continue;
+        }
+        const double ns = static_cast<double>(stages[stage].busy.count()) / static_cast<double>(stages[stage].workers);
+        if (ns > slowest_ns) {
+            slowest = stage;
+            slowest_ns = ns;
+        }
+    }
+    return static_cast<VerifyStage>(slowest);
+}
+
+VerifyPipeline::VerifyPipeline(KeyLookup keys, SpentCheck spent, PipelineOptions options)
+    : keys(std::move(keys)), spent(std::move(spent)), opts(options) {
+    if (opts.batch == 0 || opts.queue_depth == 0) {
+        throw std::invalid_argument("Pipeline batch size and queue depth must be positive");
+    }
+    for (size_t workers : opts.workers) {
+        if (workers == 0) {
+            throw std::invalid_argument("Every pipeline stage needs a worker");
+        }
+    }
+}
+
+PipelineStats VerifyPipeline::run(const uint8_t* const* tokens, const size_t* sizes, size_t count,
+                                  const Sink& sink) const {
+    Run state(opts);
+
+    auto parse = [&]() {
+        StageStats s;
+        StageTimer timer;
+        Queue& out = *state.queues[0];
+        Batch* batch = nullptr;
+        auto emit = [&]() {
+            timer.lap(s.busy);
+            s.batches++;
+            s.proofs += batch->proofs.size();
+            // Dropped if failed is set, as the stage after may have stopped
+            out.push(batch, state.failed);
+            batch = nullptr;
+            timer.lap(s.blocked);
+        };
+        try {
+            while (!state.failed.load(std::memory_order_relaxed)) {
+                const size_t token = state.next_token.fetch_add(1, std::memory_order_relaxed);
+                if (token >= count) {
+                    break;
+                }
+                TokenReader reader(tokens[token], sizes[token]);
+                ProofView proof;
+                uint64_t index = 0;
+                while (reader.next(proof)) {
+                    // A token may reuse a keyset ID with another ring, so the
+                    // ring also ends a batch
+                    if (batch != nullptr && (proof.keyset != batch->keyset || proof.signature.n != batch->n ||
+                                             proof.signature.q != batch->q || batch->proofs.size() == opts.batch)) {
+                        emit();
+                    }
+                    if (batch == nullptr) {
+                        timer.lap(s.busy);
+                        const bool got = state.free->pop(batch, &state.failed);
+                        timer.lap(s.starved);
+                        if (!got) {
+                            batch = nullptr;
+                            break;
+                        }
+                        startBatch(*batch, token, proof, keys);
+                    }
+                    addProof(*batch, proof, index++);
+                }
+                if (batch != nullptr) {
+                    emit();
+                }
+            }
+        } catch (...) {
+            // A batch cut short here stays out of the pool until the run ends
+            state.fail(std::current_exception());
+        }
+        timer.lap(s.busy);
+        state.finish(static_cast<size_t>(VerifyStage::Parse), s);
+    };
+
+    auto stage = [&](VerifyStage which, auto process) {
+        const size_t index = static_cast<size_t>(which);
+        StageStats s;
+        StageTimer timer;
+        Queue& in = *state.queues[index - 1];
+        Queue& out = index < state.queues.size() ? *state.queues[index] : *state.free;
+        Batch* batch;
+        while (in.pop(batch)) {
+            timer.lap(s.starved);
+            if (!state.failed.load(std::memory_order_relaxed)) {
+                try {
+                    process(*batch);
+                } catch (...) {
+                    state.fail(std::current_exception());
+                }
+            }
+            s.batches++;
+            s.proofs += batch->proofs.size();
+            timer.lap(s.busy);
+            out.push(batch, state.failed);
+            timer.lap(s.blocked);
+        }
+        timer.lap(s.starved);
+        state.finish(index, s);
+    };
+
+    auto hash = [](Batch& batch) {
+        if (batch.key == nullptr) {
+            return;
+        }
+        const size_t n = batch.key->degree();
+        const uint64_t q = batch.key->getModulus();
+        batch.expected.resize(batch.proofs.size());
+        for (size_t k = 0; k < batch.proofs.size(); k++) {
+            const VerifiedProof& proof = batch.proofs[k];
+            if (proof.status == ProofStatus::Valid) {
+                hashToCoefficients(batch.expected.row(k), n, q, proof.secret, proof.secret_size);
+            }
+        }
+    };
+    auto multiply = [](Batch& batch) {
+        if (batch.key != nullptr) {
+            batch.key->multiplyBySecret(batch.expected);
+        }
+    };
+    auto compare = [](Batch& batch) {
+        if (batch.key == nullptr) {
+            return;
+        }
+        const size_t n = batch.key->degree();
+        const uint64_t q = batch.key->getModulus();
+        for (size_t k = 0; k < batch.proofs.size(); k++) {
+            VerifiedProof& proof = batch.proofs[k];
+            if (proof.status == ProofStatus::Valid &&
+                !Polynomial::sameSignal(batch.signatures.row(k), batch.expected.row(k), n, q)) {
+                proof.status = ProofStatus::Invalid;
+            }
+        }
+    };
+    auto check = [&](Batch& batch) {
+        if (spent) {
+            for (VerifiedProof& proof : batch.proofs) {
+                if (proof.status == ProofStatus::Valid && spent(proof.secret, proof.secret_size)) {
+                    proof.status = ProofStatus::Spent;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.failed.load(std::memory_order_relaxed)) {
+            sink(batch.proofs.data(), batch.proofs.size());
+        }
+    };
+
+    const Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    size_t started[VERIFY_STAGE_COUNT] = {};
+    try {
+        for (size_t i = 0; i < VERIFY_STAGE_COUNT; i++) {
+            for (; started[i] < opts.workers[i]; started[i]++) {
+                switch (static_cast<VerifyStage>(i)) {
+                case VerifyStage::Parse:
+                    threads.emplace_back(parse);
+                    break;
+                case VerifyStage::Hash:
+                    threads.emplace_back(stage, VerifyStage::Hash, hash);
+                    break;
+                case VerifyStage::Multiply:
+                    threads.emplace_back(stage, VerifyStage::Multiply, multiply);
+                    break;
+                case VerifyStage::Compare:
+                    threads.emplace_back(stage, VerifyStage::Compare, compare);
+                    break;
+                case VerifyStage::SpentCheck:
+                    threads.emplace_back(stage, VerifyStage::SpentCheck, check);
+                    break;
+                }
+            }
+        }
+    } catch (...) {
+        // Stand in for the workers that never started, so the queues after
+        // them still close and the started ones drain and stop
+        state.fail(std::current_exception());
+        for (size_t i = 0; i < VERIFY_STAGE_COUNT; i++) {
+            for (; started[i] < opts.workers[i]; started[i]++) {
+                state.finish(i, StageStats());
+            }
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    state.stats.elapsed = Clock::now() - start;
+    state.stats.proofs = state.stats.stages[static_cast<size_t>(VerifyStage::SpentCheck)].proofs;
+    return state.stats;
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <derivation.h>
+#include <rlwe.h>
+#include <sampler.h>
+#include <vector>
+
+static std::vector<uint8_t> testSeed() {
+    std::vector<uint8_t> seed(32);
+    for (size_t i = 0; i < seed.size(); i++) seed[i] = static_cast<uint8_t>(i);
+    return seed;
+}
+
+static const KeysetId TEST_KEYSET = {0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7};
+
+TEST(DerivationTest, MatchesShake256Vectors) {
+    // Expected values computed independently with Python's hashlib.shake_256
+    SeedDerivation wallet(testSeed(), TEST_KEYSET);
+    const std::vector<uint8_t> expected_secret = {
+        0x12, 0x51, 0x86, 0x7c, 0x41, 0x17, 0xfb, 0xff, 0x72, 0x8f, 0xff, 0x0c, 0xbb, 0xc2, 0xcd, 0xc5,
+        0xf8, 0x92, 0x51, 0xd0, 0x38, 0xb2, 0x18, 0x72, 0x81, 0x05, 0x72, 0x5d, 0x10, 0xe2, 0x1c, 0xe9,
+    };
+    EXPECT_EQ(wallet.secret(5), expected_secret);
+
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    SmallPolynomial r = wallet.blindingFactor(5, params);
+    EXPECT_EQ(r[0], GaussianSampler::fromWord(0xb089b9b0615e09d5ULL, params));
+    EXPECT_EQ(r[1], GaussianSampler::fromWord(0x013bd02ec43b59d2ULL, params));
+}
+
+TEST(DerivationTest, OutputsDependOnEveryInput) {
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    SeedDerivation wallet(testSeed(), TEST_KEYSET);
+    EXPECT_EQ(wallet.secret(1), SeedDerivation(testSeed(), TEST_KEYSET).secret(1));
+    EXPECT_NE(wallet.secret(1), wallet.secret(2));
+
+    KeysetId other_keyset = TEST_KEYSET;
+    other_keyset[7] ^= 1;
+    EXPECT_NE(wallet.secret(1), SeedDerivation(testSeed(), other_keyset).secret(1));
+    std::vector<uint8_t> other_seed = testSeed();
+    other_seed[0] ^= 1;
+    EXPECT_NE(wallet.secret(1), SeedDerivation(other_seed, TEST_KEYSET).secret(1));
+
+    // Secret and blinding factor come from separate domains
+    EXPECT_EQ(wallet.blindingFactor(1, params).toPolynomial().getCoeffs(),
+              wallet.blindingFactor(1, params).toPolynomial().getCoeffs());
+    EXPECT_NE(wallet.blindingFactor(1, params).toPolynomial().getCoeffs(),
+              wallet.blindingFactor(2, params).toPolynomial().getCoeffs());
+
+    EXPECT_THROW(SeedDerivation(std::vector<uint8_t>(15), TEST_KEYSET), std::invalid_argument);
+}
+
+TEST(DerivationTest, WalletUnblindsWithRegeneratedFactor) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    const KeysetId id = mint.keysetId();
+    EXPECT_EQ(keysetIdToHex(id).size(), 16u);
+    EXPECT_EQ(mint.keysetId(), id);
+
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    SeedDerivation wallet(testSeed(), id);
+    for (uint64_t counter = 0; counter < 4; counter++) {
+        // Blind with a derived factor, then forget it
+        Polynomial blinded = mint.computeBlindedMessage(wallet.secret(counter),
+                                                        wallet.blindingFactor(counter, params));
+        Polynomial blind_signature = mint.blindSign(blinded);
+
+        // Regenerate r from the counter alone to unblind
+        Polynomial signature = mint.computeSignature(blind_signature, wallet.blindingFactor(counter, params),
+                                                     mint.getPublicKey().second);
+        EXPECT_TRUE(mint.verify(wallet.secret(counter), signature)) << "counter=" << counter;
+
+        // The full-polynomial path gives the same signature
+        EXPECT_EQ(signature.getCoeffs(),
+                  mint.computeSignature(blind_signature, wallet.blindingFactor(counter, params).toPolynomial(),
+                                        mint.getPublicKey().second).getCoeffs());
+    }
+
+    mint.generateKeys();
+    EXPECT_NE(mint.keysetId(), id);
+}
@@ -0,0 +1,339 @@
+#include <gtest/gtest.h>
+#include "reference.h"
+#include <ntt.h>
+#include <params.h>
+#include <polynomial.h>
+#include <rlwe.h>
+#include <sampler.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Differential harness: every optimized kernel is compared against the
+// frozen reference implementations in reference.cpp on random and
+// edge-case inputs across all parameter presets and the test rings.
+//
+// By default each test makes a single pass, which is what ctest runs.
+// With --soak=SECONDS every test keeps drawing fresh random inputs until
+// the time budget is spent:
+//
+//     rlwe_differential --soak=3600 --seed=42
+
+namespace {
+
+double soak_seconds = 0.0;
+uint64_t base_seed = 1;
+
+// Run body(pass) once, then repeatedly until the soak budget is used up.
+// Returns the number of passes made.
+size_t runPasses(const std::function<void(size_t)>& body) {
+    const auto start = std::chrono::steady_clock::now();
+    size_t pass = 0;
+    do {
+        body(pass++);
+        if (::testing::Test::HasFailure()) {
+            break;
+        }
+    } while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < soak_seconds);
+    return pass;
+}
+
+struct Ring {
+    size_t n;
+    uint64_t q;
+};
+
+// All presets, the rings used by the unit tests, and rings that exercise
+// the schoolbook fallback
+std::vector<Ring> rings() {
+    std::vector<Ring> result;
+    for (const ParameterSet* preset : ParameterSet::presets()) {
+        result.push_back({preset->n, preset->q});
+    }
+    result.push_back({4, 17});
+    result.push_back({8, 7681});
+    result.push_back({32, 7681});
+    result.push_back({16, 7919});    // q - 1 not divisible by 2n: no NTT
+    result.push_back({64, 65521});   // q - 1 not divisible by 2n: no NTT
+    return result;
+}
+
+struct MultiplyBackend {
+    std::string name;
+    std::function<bool(const ParameterSet&)> supports;
+    std::function<Polynomial(const Polynomial&, const Polynomial&)> multiply;
+};
+
+// Every multiplication path that must agree with Reference::multiply
+std::vector<MultiplyBackend> multiplyBackends() {
+    return {
+        {"operator*",
+         [](const ParameterSet&) { return true; },
+         [](const Polynomial& a, const Polynomial& b) { return a * b; }},
+        {"ntt",
+         [](const ParameterSet& p) { return NTT::isSupported(p); },
+         [](const Polynomial& a, const Polynomial& b) {
+             const ParameterSet& p = ParameterSet::get(a.degree(), a.getModulus());
+             return Polynomial(NTT::multiply(a.getCoeffs(), b.getCoeffs(), p), a.getModulus());
+         }},
+        {"sparse",
+         [](const ParameterSet&) { return true; },
+         [](const Polynomial& a, const Polynomial& b) { return a.multiplySparse(b); }},
+        {"ntt-batch",
+         [](const ParameterSet& p) { return NTT::isSupported(p); },
+         [](const Polynomial& a, const Polynomial& b) {
+             // Both operands ride in one interleaved batch
+             const ParameterSet& p = ParameterSet::get(a.degree(), a.getModulus());
+             std::vector<uint64_t> fa(a.getCoeffs()), fb(b.getCoeffs());
+             for (auto& c : fa) c %= p.q;
+             for (auto& c : fb) c %= p.q;
+             uint64_t* rows[] = {fa.data(), fb.data()};
+             NTT::forwardBatch(rows, 2, p);
+             NTT::pointwise(fa.data(), fa.data(), fb.data(), p);
+             NTT::inverseBatch(rows, 1, p);
+             return Polynomial(fa, a.getModulus());
+         }},
+    };
+}
+
+// Edge-case and random operands for one ring
+std::vector<std::pair<std::string, std::vector<uint64_t>>> operands(const Ring& ring, std::mt19937_64& rng) {
+    const size_t n = ring.n;
+    const uint64_t q = ring.q;
+    std::vector<std::pair<std::string, std::vector<uint64_t>>> cases;
+
+    cases.push_back({"zero", std::vector<uint64_t>(n, 0)});
+    std::vector<uint64_t> one(n, 0);
+    one[0] = 1;
+    cases.push_back({"one", one});
+    std::vector<uint64_t> top(n, 0);
+    top[n - 1] = 1;
+    cases.push_back({"x^(n-1)", top});
+    cases.push_back({"all q-1", std::vector<uint64_t>(n, q - 1)});
+    cases.push_back({"all q/2", std::vector<uint64_t>(n, q / 2)});
+
+    std::vector<uint64_t> alternating(n);
+    for (size_t i = 0; i < n; i++) alternating[i] = (i % 2) ? q - 1 : 0;
+    cases.push_back({"alternating", alternating});
+
+    std::vector<uint64_t> small(n);
+    for (auto& c : small) {
+        int64_t v = static_cast<int64_t>(rng() % 31) - 15;
+        c = v < 0 ? q + v : v;
+    }
+    cases.push_back({"small centered", small});
+
+    std::vector<uint64_t> uniform(n);
+    for (auto& c : uniform) c = rng() % q;
+    cases.push_back({"uniform", uniform});
+
+    std::vector<uint64_t> unreduced(n);
+    for (auto& c : unreduced) c = q + rng() % q;
+    cases.push_back({"unreduced", unreduced});
+
+    return cases;
+}
+
+std::string ringName(const Ring& ring) {
+    return "n=" + std::to_string(ring.n) + ", q=" + std::to_string(ring.q);
+}
+
+} // namespace
+
+TEST(DifferentialTest, MultiplyMatchesReference) {
+    const auto backends = multiplyBackends();
+    size_t passes = runPasses([&](size_t pass) {
+        std::mt19937_64 rng(base_seed + pass);
+        for (const Ring& ring : rings()) {
+            const ParameterSet& params = ParameterSet::get(ring.n, ring.q);
+            auto cases = operands(ring, rng);
+            const auto& random = cases[cases.size() - 2].second;
+
+            // Every case against a random operand, plus every case squared
+            for (const auto& [name, coeffs] : cases) {
+                for (const auto* other : {&random, &coeffs}) {
+                    Polynomial a(coeffs, ring.q);
+                    Polynomial b(*other, ring.q);
+                    Polynomial expected = Reference::multiply(a, b);
+                    for (const auto& backend : backends) {
+                        if (!backend.supports(params)) continue;
+                        ASSERT_EQ(backend.multiply(a, b).getCoeffs(), expected.getCoeffs())
+                            << backend.name << " differs from reference for " << name
+                            << (other == &random ? " * uniform" : " squared") << " with " << ringName(ring);
+                    }
+                }
+            }
+        }
+    });
+    std::cout << "multiply: " << passes << " pass(es)" << std::endl;
+}
+
+TEST(DifferentialTest, DotMatchesReference) {
+    size_t passes = runPasses([&](size_t pass) {
+        std::mt19937_64 rng(base_seed + pass);
+        for (const Ring& ring : rings()) {
+            // All edge cases against rotated copies of themselves in one inner product
+            auto cases = operands(ring, rng);
+            std::vector<Polynomial> u, v;
+            for (size_t i = 0; i < cases.size(); i++) {
+                u.emplace_back(cases[i].second, ring.q);
+                v.emplace_back(cases[(i + 3) % cases.size()].second, ring.q);
+            }
+            for (size_t k : {size_t(1), size_t(2), u.size()}) {
+                std::vector<Polynomial> uk(u.begin(), u.begin() + k), vk(v.begin(), v.begin() + k);
+                Polynomial expected = Reference::multiply(uk[0], vk[0]);
+                for (size_t i = 1; i < k; i++) {
+                    expected = expected + Reference::multiply(uk[i], vk[i]);
+                }
+                ASSERT_EQ(Polynomial::dot(uk, vk).getCoeffs(), expected.getCoeffs())
+                    << "k=" << k << " with " << ringName(ring);
+            }
+        }
+    });
+    std::cout << "dot: " << passes << " pass(es)" << std::endl;
+}
+
+TEST(DifferentialTest, MulMonomialMatchesReference) {
+    size_t passes = runPasses([&](size_t pass) {
+        std::mt19937_64 rng(base_seed + pass);
+        for (const Ring& ring : rings()) {
+            const int64_t n = static_cast<int64_t>(ring.n);
+            for (const auto& [name, coeffs] : operands(ring, rng)) {
+                Polynomial p(coeffs, ring.q);
+                for (int64_t k : std::vector<int64_t>{0, 1, n - 1, n, n + 1, 2 * n - 1, 2 * n, -1, -n,
+                                  static_cast<int64_t>(rng() % (4 * ring.n)) - 2 * n}) {
+                    const int64_t r = ((k % (2 * n)) + 2 * n) % (2 * n);
+                    std::vector<uint64_t> one_hot(ring.n, 0);
+                    one_hot[r % n] = r < n ? 1 : ring.q - 1;
+                    ASSERT_EQ(p.mulMonomial(k).getCoeffs(),
+                              Reference::multiply(p, Polynomial(one_hot, ring.q)).getCoeffs())
+                        << name << " * x^" << k << " with " << ringName(ring);
+                }
+            }
+        }
+    });
+    std::cout << "mulMonomial: " << passes << " pass(es)" << std::endl;
+}
+
+TEST(DifferentialTest, PolySignalMatchesReference) {
+    // Exhaustive over [0, q) for every modulus in use plus small moduli
+    std::vector<uint64_t> moduli = {2, 3, 4, 5, 16, 17};
+    for (const Ring& ring : rings()) moduli.push_back(ring.q);
+
+    for (uint64_t q : moduli) {
+        std::vector<uint64_t> all(q);
+        for (uint64_t c = 0; c < q; c++) all[c] = c;
+        Polynomial p(all, q);
+        ASSERT_EQ(p.polySignal().getCoeffs(), Reference::polySignal(p).getCoeffs()) << "q=" << q;
+    }
+
+    // Random, including unreduced coefficients that may come from untrusted input
+    size_t passes = runPasses([&](size_t pass) {
+        std::mt19937_64 rng(base_seed + pass);
+        for (uint64_t q : moduli) {
+            std::vector<uint64_t> coeffs(1024);
+            for (auto& c : coeffs) {
+                c = (rng() % 4 == 0) ? rng() % (uint64_t(1) << 40) : rng() % q;
+            }
+            Polynomial p(coeffs, q);
+            ASSERT_EQ(p.polySignal().getCoeffs(), Reference::polySignal(p).getCoeffs()) << "q=" << q;
+        }
+    });
+    std::cout << "polySignal: " << passes << " pass(es)" << std::endl;
+}
+
+TEST(DifferentialTest, HashToPolynomialMatchesReference) {
+    size_t passes = runPasses([&](size_t pass) {
+        std::mt19937_64 rng(base_seed + pass);
+        for (const Ring& ring : rings()) {
+            if ((ring.n & (ring.n - 1)) != 0) continue;
+            RLWESignature rlwe(ring.n, ring.q);
+            for (size_t len : {size_t(0), size_t(1), size_t(2), size_t(31), size_t(32), size_t(33),
+                               static_cast<size_t>(rng() % 200)}) {
+                std::vector<uint8_t> message(len);
+                for (auto& b : message) b = static_cast<uint8_t>(rng());
+                ASSERT_EQ(rlwe.hashToPolynomial(message).getCoeffs(),
+                          Reference::hashToPolynomial(message, ring.n, ring.q).getCoeffs())
+                    << "message length " << len << " with " << ringName(ring);
+            }
+        }
+    });
+    std::cout << "hashToPolynomial: " << passes << " pass(es)" << std::endl;
+}
+
+TEST(DifferentialTest, GaussianSamplerMatchesReferenceDistribution) {
+    // Two-sample chi-square test between the table sampler and the
+    // reference Box-Muller sampler, at the preset deviation and at tables
+    // built for others. Histograms accumulate across soak passes, so
+    // longer runs detect smaller deviations.
+    const ParameterSet& preset = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    const std::vector<std::shared_ptr<const ParameterSet>> tables = {
+        std::shared_ptr<const ParameterSet>(&preset, [](const ParameterSet*) {}),
+        GaussianSampler::withDeviation(preset, 2.5),
+        GaussianSampler::withDeviation(preset, 4.0),
+    };
+    const size_t samples_per_pass = 200000;
+    std::vector<std::map<int64_t, double>> table_hist(tables.size()), reference_hist(tables.size());
+    double total = 0;
+
+    size_t passes = runPasses([&](size_t pass) {
+        for (size_t t = 0; t < tables.size(); t++) {
+            const ParameterSet& params = *tables[t];
+            std::mt19937_64 rng(base_seed + pass * tables.size() + t);
+            for (size_t i = 0; i < samples_per_pass; i++) {
+                table_hist[t][GaussianSampler::fromWord(rng(), params)] += 1;
+                uint64_t r1 = rng(), r2 = rng();
+                reference_hist[t][Reference::sampleGaussian(r1, r2, params.sigma)] += 1;
+            }
+
+            // Bins |x| <= 12, tails merged into the outermost bins
+            double chi2 = 0;
+            size_t bins = 0;
+            for (int64_t x = -12; x <= 12; x++) {
+                double a = 0, b = 0;
+                for (const auto& [value, count] : table_hist[t]) {
+                    if ((x == -12 && value <= x) || (x == 12 && value >= x) || value == x) a += count;
+                }
+                for (const auto& [value, count] : reference_hist[t]) {
+                    if ((x == -12 && value <= x) || (x == 12 && value >= x) || value == x) b += count;
+                }
+                if (a + b < 10) continue;
+                chi2 += (a - b) * (a - b) / (a + b);
+                bins++;
+            }
+
+            // Critical value at p = 1e-6 (Wilson-Hilferty approximation)
+            const double df = static_cast<double>(bins - 1);
+            const double z = 4.753;
+            const double critical = df * std::pow(1 - 2 / (9 * df) + z * std::sqrt(2 / (9 * df)), 3);
+            ASSERT_LT(chi2, critical) << "table sampler at sigma " << params.sigma << " deviates from reference after "
+                                      << total + samples_per_pass << " samples (chi2=" << chi2 << ", df=" << df << ")";
+        }
+        total += samples_per_pass;
+    });
+    std::cout << "sampler: " << passes << " pass(es), " << total << " samples per deviation" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--soak=", 0) == 0) {
+            soak_seconds = std::stod(arg.substr(7));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            base_seed = std::stoull(arg.substr(7));
+        } else {
+            std::cerr << "Unknown option " << arg << "\n"
+                      << "Usage: " << argv[0] << " [gtest options] [--soak=SECONDS] [--seed=N]\n";
+            return 2;
+        }
+    }
+    return RUN_ALL_TESTS();
+}
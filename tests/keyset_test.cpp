@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <keyset.h>
+#include <rlwe.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Secrets and blinding factors for `count` outputs of one payment
+void makeOutputs(size_t count, const ParameterSet& params, std::vector<std::vector<uint8_t>>& secrets,
+                 std::vector<SmallPolynomial>& factors) {
+    SeedDerivation wallet(std::vector<uint8_t>(32, 0x42), KeysetId{});
+    for (size_t k = 0; k < count; k++) {
+        secrets.push_back(wallet.secret(k));
+        factors.push_back(wallet.blindingFactor(k, params));
+    }
+}
+
+} // namespace
+
+TEST(KeysetTest, BatchMatchesPerOutputBlindingAndUnblinding) {
+    // NTT ring, NTT ring small enough for the direct kernel, and a ring
+    // without the NTT
+    const std::vector<std::pair<size_t, uint64_t>> rings = {{256, 7681}, {32, 7681}, {256, 7919}};
+    for (const auto& ring : rings) {
+        RLWESignature rlwe(ring.first, ring.second);
+        rlwe.generateKeys();
+        const ParameterSet& params = ParameterSet::get(ring.first, ring.second);
+
+        // Not a multiple of eight, so the last transform group is partial
+        std::vector<std::vector<uint8_t>> secrets;
+        std::vector<SmallPolynomial> factors;
+        makeOutputs(37, params, secrets, factors);
+
+        PolynomialBatch blinded = rlwe.computeBlindedMessageBatch(secrets, factors);
+        ASSERT_EQ(blinded.size(), 37u);
+        std::vector<Polynomial> blind_signatures;
+        for (size_t k = 0; k < secrets.size(); k++) {
+            EXPECT_EQ(blinded.coeffs(k), rlwe.computeBlindedMessage(secrets[k], factors[k]).getCoeffs())
+                << "n=" << ring.first << " q=" << ring.second << " output " << k;
+            blind_signatures.push_back(rlwe.blindSign(blinded[k]));
+        }
+
+        PolynomialBatch signatures = rlwe.computeSignatureBatch(blind_signatures, factors);
+        ASSERT_EQ(signatures.size(), 37u);
+        for (size_t k = 0; k < secrets.size(); k++) {
+            Polynomial expected = rlwe.computeSignature(blind_signatures[k], factors[k], rlwe.getPublicKey().second);
+            EXPECT_EQ(signatures.coeffs(k), expected.getCoeffs())
+                << "n=" << ring.first << " q=" << ring.second << " output " << k;
+        }
+    }
+}
+
+TEST(KeysetTest, BatchRejectsMissingKeysAndMismatchedInputs) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    std::vector<std::vector<uint8_t>> secrets;
+    std::vector<SmallPolynomial> factors;
+    makeOutputs(3, params, secrets, factors);
+    EXPECT_THROW(rlwe.computeBlindedMessageBatch(secrets, factors), std::runtime_error);
+
+    rlwe.generateKeys();
+    EXPECT_EQ(rlwe.computeBlindedMessageBatch({}, {}).size(), 0u);
+    factors.pop_back();
+    EXPECT_THROW(rlwe.computeBlindedMessageBatch(secrets, factors), std::invalid_argument);
+    factors.push_back(SmallPolynomial(128, 7681));
+    EXPECT_THROW(rlwe.computeBlindedMessageBatch(secrets, factors), std::invalid_argument);
+    EXPECT_THROW(rlwe.computeSignatureBatch({Polynomial(256, 7681)}, {}), std::invalid_argument);
+    EXPECT_THROW(rlwe.computeSignatureBatch({Polynomial(128, 7681)}, {SmallPolynomial(256, 7681)}),
+                 std::invalid_argument);
+}
+
+TEST(KeysetTest, CachePreparesEachKeysetOnce) {
+    RLWESignature first(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature second(ParameterPreset::RLWE_256_Q7681);
+    first.generateKeys();
+    second.generateKeys();
+
+    KeysetCache cache;
+    EXPECT_EQ(cache.find(first.keysetId()), nullptr);
+    auto prepared = cache.add(first.getPublicKey().first, first.getPublicKey().second);
+    EXPECT_EQ(prepared->id(), first.keysetId());
+    EXPECT_EQ(cache.add(first.getPublicKey().first, first.getPublicKey().second), prepared);
+    EXPECT_EQ(cache.find(first.keysetId()), prepared);
+    EXPECT_EQ(cache.size(), 1u);
+
+    cache.add(second.getPublicKey().first, second.getPublicKey().second);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_NE(cache.find(second.keysetId()), prepared);
+    EXPECT_EQ(cache.find(second.keysetId())->getB().getCoeffs(), second.getPublicKey().second.getCoeffs());
+}
+
+TEST(KeysetTest, PolynomialBatchRowsAreContiguous) {
+    PolynomialBatch batch(3, 16, 7681);
+    EXPECT_EQ(batch.row(1), batch.data() + 16);
+    EXPECT_EQ(batch.row(2), batch.row(1) + 16);
+    batch.row(2)[5] = 42;
+    Polynomial p = batch[2];
+    EXPECT_EQ(p.degree(), 16u);
+    EXPECT_EQ(p.getModulus(), 7681u);
+    EXPECT_EQ(p[5], 42u);
+    EXPECT_EQ(batch.toPolynomials()[2].getCoeffs(), batch.coeffs(2));
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <mint_api.h>
+#include <rlwe.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void expectSameEntries(const EntryBatch& a, const EntryBatch& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t k = 0; k < a.size(); k++) {
+        EXPECT_EQ(a.amounts[k], b.amounts[k]);
+        EXPECT_EQ(a.keysets[k], b.keysets[k]);
+        EXPECT_EQ(a.secret(k), b.secret(k));
+        EXPECT_EQ(a.polynomials[k].getCoeffs(), b.polynomials[k].getCoeffs());
+    }
+}
+
+// Ring of the hand-written bodies below: "0Qg" is the polynomial 1 + 2x + 3x^2 + 4x^3
+constexpr size_t N = 4;
+constexpr uint64_t Q = 7;
+
+} // namespace
+
+TEST(MintApiTest, RoundTripsSwapRequest) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    const size_t n = rlwe.getPublicKey().second.degree();
+    const uint64_t q = rlwe.getPublicKey().second.getModulus();
+
+    MintRequest request(n, q);
+    const std::vector<std::string> secrets = {"plain", "quote \" and \\ slash", "line\nbreak\x01", "caf\xc3\xa9", ""};
+    for (size_t k = 0; k < secrets.size(); k++) {
+        const std::vector<uint8_t> bytes(secrets[k].begin(), secrets[k].end());
+        const size_t i = request.inputs.add(uint64_t(1) << k, rlwe.keysetId(), secrets[k]);
+        Polynomial c = rlwe.computeBlindedMessage(bytes).first;
+        std::copy(c.getCoeffs().begin(), c.getCoeffs().end(), request.inputs.polynomials.row(i));
+    }
+    for (size_t k = 0; k < 7; k++) {
+        const size_t i = request.outputs.add(~uint64_t(0) - k, rlwe.keysetId());
+        Polynomial b = rlwe.computeBlindedMessage(std::vector<uint8_t>(32, static_cast<uint8_t>(k))).first;
+        std::copy(b.getCoeffs().begin(), b.getCoeffs().end(), request.outputs.polynomials.row(i));
+    }
+
+    std::string json;
+    writeMintRequest(request, json);
+    EXPECT_EQ(json.find("\"quote\""), std::string::npos);
+
+    MintRequest parsed(n, q);
+    readMintRequest(json, parsed);
+    EXPECT_EQ(parsed.quote, "");
+    expectSameEntries(parsed.inputs, request.inputs);
+    expectSameEntries(parsed.outputs, request.outputs);
+
+    // Reading again reuses the buffers
+    const uint64_t* rows = parsed.outputs.polynomials.data();
+    readMintRequest(json, parsed);
+    EXPECT_EQ(parsed.outputs.polynomials.data(), rows);
+    expectSameEntries(parsed.inputs, request.inputs);
+}
+
+TEST(MintApiTest, RoundTripsMintRequestAndSignatures) {
+    MintRequest request(N, Q);
+    request.quote = "quote-\xe2\x82\xac";
+    const KeysetId keyset{0, 1, 2, 3, 4, 5, 6, 0xff};
+    for (uint64_t k = 0; k < 3; k++) {
+        const size_t i = request.outputs.add(k, keyset);
+        for (size_t j = 0; j < N; j++) {
+            request.outputs.polynomials.row(i)[j] = (k + j) % Q;
+        }
+    }
+    std::string json = "prefix";
+    writeMintRequest(request, json);
+    EXPECT_EQ(json.find("\"inputs\""), std::string::npos);
+
+    MintRequest parsed(N, Q);
+    readMintRequest(std::string_view(json).substr(6), parsed);
+    EXPECT_EQ(parsed.quote, request.quote);
+    EXPECT_EQ(parsed.inputs.size(), 0u);
+    expectSameEntries(parsed.outputs, request.outputs);
+
+    std::string response;
+    writeSignatures(request.outputs, response);
+    EXPECT_EQ(response.rfind("{\"signatures\":[{\"amount\":0,\"id\":\"00010203040506ff\",\"C_\":\"", 0), 0u);
+    EntryBatch signatures(N, Q);
+    readSignatures(response, signatures);
+    expectSameEntries(signatures, request.outputs);
+}
+
+TEST(MintApiTest, ReadsHandWrittenBodies) {
+    const std::string json = R"( {
+        "extra": {"nested": [1, -2.5e+3, true, false, null, "s\"", {}], "e": []},
+        "outputs": [],
+        "inputs": [ { "C" : "0Qg", "secret": "é😀\/\t", "witness": "{\"a\":1}",
+                      "id": "0A0b0C0d0E0f1011", "amount": 0 } ],
+        "quote": "q\\"
+    } )";
+    MintRequest request(N, Q);
+    readMintRequest(json, request);
+    EXPECT_EQ(request.quote, "q\\");
+    EXPECT_EQ(request.outputs.size(), 0u);
+    ASSERT_EQ(request.inputs.size(), 1u);
+    EXPECT_EQ(request.inputs.amounts[0], 0u);
+    EXPECT_EQ(request.inputs.keysets[0], (KeysetId{0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11}));
+    EXPECT_EQ(request.inputs.secret(0), "\xc3\xa9\xf0\x9f\x98\x80/\t");
+    EXPECT_EQ(request.inputs.polynomials[0].getCoeffs(), (std::vector<uint64_t>{1, 2, 3, 4}));
+}
+
+TEST(MintApiTest, RejectsMalformedBodies) {
+    const std::string entry = R"({"amount":1,"id":"0001020304050607","B_":"0Qg"})";
+    const std::string valid = "{\"outputs\":[" + entry + "]}";
+    MintRequest request(N, Q);
+    readMintRequest(valid, request);
+    for (size_t cut = 0; cut < valid.size(); cut++) {
+        EXPECT_THROW(readMintRequest(valid.substr(0, cut), request), std::invalid_argument) << cut;
+    }
+
+    const std::vector<std::string> bad = {
+        valid + "x",
+        "{}",
+        "[]",
+        R"({"outputs":[{"amount":1,"id":"0001020304050607"}]})",
+        R"({"outputs":[{"amount":1,"amount":1,"id":"0001020304050607","B_":"0Qg"}]})",
+        R"({"outputs":[],"outputs":[]})",
+        R"({"outputs":[{"amount":1,"id":"00010203040506","B_":"0Qg"}]})",
+        R"({"outputs":[{"amount":1,"id":"000102030405060g","B_":"0Qg"}]})",
+        R"({"outputs":[{"amount":1,"id":"0001020304050607","B_":"0Qga"}]})",
+        R"({"outputs":[{"amount":1,"id":"0001020304050607","B_":"0Qh"}]})",
+        // Coefficient 7 is not below q
+        R"({"outputs":[{"amount":1,"id":"0001020304050607","B_":"_wc"}]})",
+        R"({"outputs":[{"amount":01,"id":"0001020304050607","B_":"0Qg"}]})",
+        R"({"outputs":[{"amount":-1,"id":"0001020304050607","B_":"0Qg"}]})",
+        R"({"outputs":[{"amount":1.0,"id":"0001020304050607","B_":"0Qg"}]})",
+        R"({"outputs":[{"amount":18446744073709551616,"id":"0001020304050607","B_":"0Qg"}]})",
+        R"({"quote":"\ude00","outputs":[]})",
+        R"({"quote":"\ud83dx","outputs":[]})",
+        R"({"quote":"\x","outputs":[]})",
+        "{\"quote\":\"a\nb\",\"outputs\":[]}",
+        R"({"outputs":[],})",
+        R"({"outputs":[],"x":01})",
+        R"({"outputs":[],"x":nul})",
+        "{\"outputs\":[],\"x\":" + std::string(40, '[') + std::string(40, ']') + "}",
+    };
+    for (const std::string& json : bad) {
+        EXPECT_THROW(readMintRequest(json, request), std::invalid_argument) << json;
+    }
+
+    // Inputs need a secret and use "C"
+    EXPECT_THROW(readMintRequest(R"({"inputs":[)" + entry + "]}", request), std::invalid_argument);
+    EntryBatch signatures(N, Q);
+    EXPECT_THROW(readSignatures(valid, signatures), std::invalid_argument);
+}
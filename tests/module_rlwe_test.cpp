@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <module_rlwe.h>
+#include <vector>
+
+TEST(ModuleRLWETest, BlindSignatureFlowForEachRank) {
+    for (size_t k : {1, 2, 3}) {
+        ModuleRLWESignature mlwe(k, ParameterPreset::RLWE_256_Q12289);
+        EXPECT_EQ(mlwe.rank(), k);
+        mlwe.generateKeys();
+        auto [A, b] = mlwe.getPublicKey();
+        ASSERT_EQ(A.size(), k);
+        ASSERT_EQ(A[0].size(), k);
+        ASSERT_EQ(b.size(), k);
+        EXPECT_EQ(b[0].degree(), 256u);
+
+        std::vector<uint8_t> secret = {0xca, 0xfe, static_cast<uint8_t>(k)};
+        auto [blinded, factor] = mlwe.computeBlindedMessage(secret);
+        Polynomial signature = mlwe.computeSignature(mlwe.blindSign(blinded), factor, b);
+        EXPECT_TRUE(mlwe.verify(secret, signature)) << "k=" << k;
+
+        secret[0] ^= 1;
+        EXPECT_FALSE(mlwe.verify(secret, signature)) << "k=" << k;
+    }
+}
+
+TEST(ModuleRLWETest, HashComponentsAreDomainSeparated) {
+    ModuleRLWESignature mlwe(3, ParameterPreset::RLWE_256_Q7681);
+    auto Y = mlwe.hashToPolynomials({1, 2, 3});
+    ASSERT_EQ(Y.size(), 3u);
+    EXPECT_NE(Y[0].getCoeffs(), Y[1].getCoeffs());
+    EXPECT_NE(Y[1].getCoeffs(), Y[2].getCoeffs());
+    EXPECT_EQ(Y[2].getCoeffs(), mlwe.hashToPolynomials({1, 2, 3})[2].getCoeffs());
+}
+
+TEST(ModuleRLWETest, RejectsMalformedInput) {
+    EXPECT_THROW(ModuleRLWESignature(0, ParameterPreset::RLWE_256_Q7681), std::invalid_argument);
+    EXPECT_THROW(ModuleRLWESignature(2, 100, 7681), std::invalid_argument);
+
+    ModuleRLWESignature mlwe(2, ParameterPreset::RLWE_256_Q7681);
+    mlwe.generateKeys();
+    auto [blinded, factor] = mlwe.computeBlindedMessage({0x01});
+    blinded.pop_back();
+    EXPECT_THROW(mlwe.blindSign(blinded), std::invalid_argument);
+    EXPECT_THROW(mlwe.blindSign({Polynomial(128, 7681), Polynomial(128, 7681)}), std::invalid_argument);
+    EXPECT_FALSE(mlwe.verify({0x01}, Polynomial(128, 7681)));
+}
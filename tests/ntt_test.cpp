@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <ntt.h>
+#include <params.h>
+#include <polynomial.h>
+#include <random>
+#include <vector>
+
+// Straightforward negacyclic convolution used as the expected result
+static std::vector<uint64_t> naiveMultiply(const std::vector<uint64_t>& a,
+                                           const std::vector<uint64_t>& b, uint64_t q) {
+    const size_t n = a.size();
+    std::vector<uint64_t> result(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            uint64_t prod = (a[i] * b[j]) % q;
+            size_t k = i + j;
+            if (k < n) {
+                result[k] = (result[k] + prod) % q;
+            } else {
+                result[k - n] = (result[k - n] + q - prod) % q;
+            }
+        }
+    }
+    return result;
+}
+
+static std::vector<uint64_t> randomCoeffs(size_t n, uint64_t q, std::mt19937_64& rng) {
+    std::vector<uint64_t> coeffs(n);
+    for (auto& c : coeffs) {
+        c = rng() % q;
+    }
+    return coeffs;
+}
+
+TEST(NTTTest, RoundTripIsIdentity) {
+    std::mt19937_64 rng(1);
+    for (const ParameterSet* params : ParameterSet::presets()) {
+        auto coeffs = randomCoeffs(params->n, params->q, rng);
+        auto transformed = coeffs;
+        NTT::forward(transformed.data(), *params);
+        EXPECT_NE(transformed, coeffs) << params->name;
+        NTT::inverse(transformed.data(), *params);
+        EXPECT_EQ(transformed, coeffs) << params->name;
+    }
+}
+
+TEST(NTTTest, MultiplyMatchesNaiveConvolution) {
+    std::mt19937_64 rng(2);
+    const std::vector<std::pair<size_t, uint64_t>> rings = {
+        {2, 17}, {4, 17}, {8, 7681}, {32, 7681}, {256, 7681}, {512, 12289}
+    };
+    for (const auto& [n, q] : rings) {
+        const ParameterSet& params = ParameterSet::get(n, q);
+        ASSERT_TRUE(NTT::isSupported(params)) << "n=" << n << ", q=" << q;
+        auto a = randomCoeffs(n, q, rng);
+        auto b = randomCoeffs(n, q, rng);
+        EXPECT_EQ(NTT::multiply(a, b, params), naiveMultiply(a, b, q)) << "n=" << n << ", q=" << q;
+    }
+}
+
+TEST(NTTTest, NegacyclicWrapAround) {
+    // x^(n-1) * x = x^n = -1 in Z_q[x]/(x^n + 1)
+    const ParameterSet& params = ParameterSet::get(8, 7681);
+    std::vector<uint64_t> a(8, 0), b(8, 0);
+    a[7] = 1;
+    b[1] = 1;
+    auto product = NTT::multiply(a, b, params);
+    EXPECT_EQ(product[0], 7680u);
+    for (size_t i = 1; i < 8; i++) {
+        EXPECT_EQ(product[i], 0u);
+    }
+}
+
+TEST(NTTTest, UnsupportedParametersFallBackToSchoolbook) {
+    // 7681 - 1 is not divisible by 2 * 1024, so no primitive 2048th root exists
+    const ParameterSet& params = ParameterSet::get(1024, 7681);
+    EXPECT_FALSE(NTT::isSupported(params));
+
+    // q = 15 is not prime
+    std::mt19937_64 rng(3);
+    auto a = randomCoeffs(4, 15, rng);
+    auto b = randomCoeffs(4, 15, rng);
+    EXPECT_FALSE(NTT::isSupported(ParameterSet::get(4, 15)));
+    Polynomial product = Polynomial(a, 15) * Polynomial(b, 15);
+    EXPECT_EQ(product.getCoeffs(), naiveMultiply(a, b, 15));
+}
+
+TEST(NTTTest, PolynomialMultiplicationUsesReducedInputs) {
+    // Unreduced coefficients must give the same product as reduced ones
+    Polynomial f({1 + 17, 2, 3 + 34, 4}, 17);
+    Polynomial g({5, 6 + 17, 7, 8}, 17);
+    Polynomial expected = Polynomial({1, 2, 3, 4}, 17) * Polynomial({5, 6, 7, 8}, 17);
+    EXPECT_EQ((f * g).getCoeffs(), expected.getCoeffs());
+    EXPECT_EQ(expected.getCoeffs(), naiveMultiply({1, 2, 3, 4}, {5, 6, 7, 8}, 17));
+}
+
+TEST(NTTTest, BatchTransformMatchesSingle) {
+    std::mt19937_64 rng(5);
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    // Batches below, at and across the interleaving width
+    for (size_t count : {size_t(1), size_t(8), size_t(11)}) {
+        std::vector<std::vector<uint64_t>> polys, expected;
+        std::vector<uint64_t*> rows;
+        for (size_t k = 0; k < count; k++) {
+            polys.push_back(randomCoeffs(params.n, params.q, rng));
+        }
+        for (auto& p : polys) {
+            rows.push_back(p.data());
+            expected.push_back(p);
+            NTT::forward(expected.back().data(), params);
+        }
+
+        NTT::forwardBatch(rows.data(), rows.size(), params);
+        EXPECT_EQ(polys, expected) << "forward, count=" << count;
+
+        for (auto& p : expected) NTT::inverse(p.data(), params);
+        NTT::inverseBatch(rows.data(), rows.size(), params);
+        EXPECT_EQ(polys, expected) << "inverse, count=" << count;
+    }
+}
+
+TEST(NTTTest, DotMatchesSumOfProducts) {
+    std::mt19937_64 rng(6);
+    // q close to 2^31 leaves room for only a few lazy products per reduction
+    for (uint64_t q : {uint64_t(12289), uint64_t(2013265921)}) {
+        const ParameterSet& params = ParameterSet::get(64, q);
+        ASSERT_TRUE(NTT::isSupported(params));
+        for (size_t k : {size_t(1), size_t(3), size_t(9)}) {
+            std::vector<std::vector<uint64_t>> a, b;
+            std::vector<uint64_t> expected(64, 0);
+            for (size_t i = 0; i < k; i++) {
+                a.push_back(randomCoeffs(64, q, rng));
+                b.push_back(randomCoeffs(64, q, rng));
+                auto product = naiveMultiply(a.back(), b.back(), q);
+                for (size_t j = 0; j < 64; j++) expected[j] = (expected[j] + product[j]) % q;
+            }
+            EXPECT_EQ(NTT::dot(a, b, params), expected) << "q=" << q << ", k=" << k;
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <params.h>
+#include <rlwe.h>
+#include <module_rlwe.h>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ParamsTest, PresetsAreResolvedWithoutRuntimeTables) {
+    const size_t builds_before = ParameterSet::runtimeBuildCount();
+
+    for (const ParameterSet* preset : ParameterSet::presets()) {
+        const ParameterSet& found = ParameterSet::get(preset->n, preset->q);
+        EXPECT_EQ(&found, preset) << preset->name;
+        EXPECT_TRUE(found.is_preset);
+        EXPECT_TRUE(found.ntt_friendly);
+    }
+
+    RLWESignature rlwe(ParameterPreset::RLWE_512_Q12289);
+    rlwe.generateKeys();
+    EXPECT_EQ(ParameterSet::runtimeBuildCount(), builds_before);
+}
+
+TEST(ParamsTest, PresetValues) {
+    const ParameterSet& p = ParameterSet::fromPreset(ParameterPreset::RLWE_1024_Q12289);
+    EXPECT_EQ(p.n, 1024u);
+    EXPECT_EQ(p.q, 12289u);
+    EXPECT_EQ((p.n * p.n_inv) % p.q, 1u);
+
+    // psi_rev[1] is psi^(n/2), a square root of -1
+    uint64_t psi_half = p.psi_rev[1];
+    EXPECT_EQ((psi_half * psi_half) % p.q, p.q - 1);
+
+    // psi and psi^-1 are inverses of each other
+    for (size_t i = 0; i < p.n; i++) {
+        EXPECT_EQ((p.psi_rev[i] * p.psi_inv_rev[i]) % p.q, 1u) << "index " << i;
+    }
+}
+
+TEST(ParamsTest, RuntimeTablesMatchPresetTables) {
+    // The runtime generator must produce the same tables as the compiler
+    const ParameterSet& preset = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    const ParameterSet& runtime = ParameterSet::get(128, 7681);
+    ASSERT_FALSE(runtime.is_preset);
+    ASSERT_TRUE(runtime.ntt_friendly);
+    EXPECT_EQ(runtime.barrett, preset.barrett);
+    for (size_t i = 0; i < ParameterSet::CDT_SIZE; i++) {
+        EXPECT_EQ(runtime.cdt[i], preset.cdt[i]);
+    }
+}
+
+TEST(ParamsTest, GaussianTableMatchesRoundedNormal) {
+    const ParameterSet& p = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    const double scale = std::ldexp(1.0, 63);
+    const double sigma = p.sigma;
+    auto phi = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+
+    for (size_t k = 0; k < 12; k++) {
+        double expected = phi((k + 0.5) / sigma) - phi(-(k + 0.5) / sigma);
+        EXPECT_NEAR(p.cdt[k] / scale, expected, 1e-9) << "k=" << k;
+    }
+    for (size_t k = 1; k < p.cdt_size; k++) {
+        EXPECT_GE(p.cdt[k], p.cdt[k - 1]);
+    }
+    EXPECT_LE(p.cdt[p.cdt_size - 1], uint64_t(1) << 63);
+}
+
+TEST(ParamsTest, PresetSignatureFlow) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    auto [a, b] = rlwe.getPublicKey();
+    EXPECT_EQ(a.degree(), 256u);
+    EXPECT_EQ(a.getModulus(), 7681u);
+
+    std::vector<uint8_t> secret = {0xde, 0xad, 0xbe, 0xef};
+    auto [blindedMessage, blindingFactor] = rlwe.computeBlindedMessage(secret);
+    Polynomial signature = rlwe.computeSignature(rlwe.blindSign(blindedMessage), blindingFactor, b);
+    EXPECT_TRUE(rlwe.verify(secret, signature));
+    EXPECT_FALSE(rlwe.verify({0xde, 0xad, 0xbe, 0xee}, signature));
+}
+
+TEST(ParamsTest, RuntimeSetsAreSharedAndInvalidRingsNotCached) {
+    const ParameterSet& first = ParameterSet::get(64, 7681);
+    std::vector<const ParameterSet*> found(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < found.size(); t++) {
+        threads.emplace_back([&found, t]() { found[t] = &ParameterSet::get(64, 7681); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const ParameterSet* set : found) {
+        EXPECT_EQ(set, &first);
+    }
+
+    const size_t builds_before = ParameterSet::runtimeBuildCount();
+    EXPECT_THROW(RLWESignature(100, 7681), std::invalid_argument);
+    EXPECT_THROW(ModuleRLWESignature(2, 96, 7681), std::invalid_argument);
+    EXPECT_THROW(ParameterSet::get(0, 7681), std::invalid_argument);
+    EXPECT_THROW(ParameterSet::get(64, 1), std::invalid_argument);
+    EXPECT_EQ(ParameterSet::runtimeBuildCount(), builds_before);
+}
+
+namespace {
+
+// x^n = -1 product, for checking the NTT path
+std::vector<uint64_t> negacyclicProduct(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b, uint64_t q) {
+    const size_t n = a.size();
+    std::vector<uint64_t> c(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            const uint64_t t = a[i] * b[j] % q;
+            const size_t k = (i + j) % n;
+            c[k] = i + j < n ? (c[k] + t) % q : (c[k] + q - t) % q;
+        }
+    }
+    return c;
+}
+
+bool isPrime(uint64_t q) {
+    for (uint64_t d = 2; d * d <= q; d++) {
+        if (q % d == 0) return false;
+    }
+    return q >= 2;
+}
+
+// Exits with 0 if every product matches, after filling the runtime table
+[[noreturn]] void fillTableAndMultiply() {
+    auto check = [](size_t n, uint64_t q) {
+        std::vector<uint64_t> a(n), b(n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = (3 * i + 1) % q;
+            b[i] = (5 * i + 2) % q;
+        }
+        if ((Polynomial(a, q) * Polynomial(b, q)).getCoeffs() != negacyclicProduct(a, b, q)) {
+            std::exit(1);
+        }
+    };
+    // More NTT-friendly rings than the table holds, then a ring of each
+    // kind once it is full
+    size_t rings = 0;
+    for (uint64_t q = 17; rings < ParameterSet::MAX_RUNTIME_SETS + 8; q += 16) {
+        if (isPrime(q)) {
+            check(8, q);
+            rings++;
+        }
+    }
+    check(3, 7681);
+    check(16, 7681);
+    check(16, 7687);
+    std::exit(ParameterSet::nttTables(16, 7681) != nullptr && ParameterSet::nttTables(3, 7681) == nullptr ? 0 : 2);
+}
+
+} // namespace
+
+TEST(ParamsTest, MultiplicationOutlivesFullRuntimeTable) {
+    // In a child process, as it fills the process-wide table
+    EXPECT_EXIT(fillTableAndMultiply(), ::testing::ExitedWithCode(0), "");
+}
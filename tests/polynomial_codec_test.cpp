@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <polynomial_codec.h>
+#include <rlwe.h>
+#include <derivation.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+TEST(PolynomialCodecTest, RoundTripsPackedPolynomials) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    std::vector<Polynomial> polys = {rlwe.getPublicKey().first, rlwe.getPublicKey().second,
+                                     Polynomial(std::vector<uint64_t>{0, 1, 12288, 7}, 12289),
+                                     Polynomial(std::vector<uint64_t>{(uint64_t(1) << 61) - 2, 3}, (uint64_t(1) << 61) - 1)};
+
+    std::vector<uint8_t> bytes = encodePolynomials(polys);
+    EXPECT_EQ(packedSize(256, 7681), 416u);
+    EXPECT_EQ(bytes.size(), 4 + 2 * (12 + 416) + (12 + 7) + (12 + 16));
+
+    std::vector<Polynomial> decoded = decodePolynomials(bytes.data(), bytes.size());
+    ASSERT_EQ(decoded.size(), polys.size());
+    for (size_t k = 0; k < polys.size(); k++) {
+        EXPECT_EQ(decoded[k].getModulus(), polys[k].getModulus());
+        EXPECT_EQ(decoded[k].getCoeffs(), polys[k].getCoeffs());
+    }
+}
+
+TEST(PolynomialCodecTest, RejectsMalformedInput) {
+    std::vector<uint8_t> bytes = encodePolynomials({Polynomial(std::vector<uint64_t>{1, 2, 3, 4}, 7)});
+    EXPECT_THROW(decodePolynomials(bytes.data(), bytes.size() - 1), std::invalid_argument);
+    bytes.push_back(0);
+    EXPECT_THROW(decodePolynomials(bytes.data(), bytes.size()), std::invalid_argument);
+    bytes.pop_back();
+
+    // 3-bit fields can hold 7, which is not below q = 7
+    bytes.back() = 0xff;
+    EXPECT_THROW(decodePolynomials(bytes.data(), bytes.size()), std::invalid_argument);
+    EXPECT_THROW(decodePolynomials(bytes.data(), 2), std::invalid_argument);
+}
+
+TEST(PolynomialCodecTest, RiceCodesGaussianPolynomials) {
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    SeedDerivation wallet(std::vector<uint8_t>(32, 7), KeysetId{});
+    for (uint64_t counter = 0; counter < 16; counter++) {
+        SmallPolynomial r = wallet.blindingFactor(counter, params);
+        std::vector<uint8_t> bytes = encodeSmallPolynomial(r);
+
+        // About 4 bits per coefficient against 64 in a Polynomial
+        EXPECT_LT(bytes.size(), 17u + 256 * 5 / 8);
+
+        SmallPolynomial decoded = decodeSmallPolynomial(bytes.data(), bytes.size());
+        EXPECT_EQ(decoded.getModulus(), 7681u);
+        ASSERT_EQ(decoded.degree(), 256u);
+        EXPECT_TRUE(std::equal(r.data(), r.data() + 256, decoded.data()));
+    }
+
+    // Extreme and empty values, and trailing bytes when the caller asks
+    SmallPolynomial wide(std::vector<int64_t>{127, -127, 0, 1, -1, 64, 0, 0, -100}, 7681);
+    std::vector<uint8_t> bytes = encodeSmallPolynomial(wide);
+    const size_t encoded = bytes.size();
+    bytes.push_back(0xaa);
+    size_t consumed = 0;
+    SmallPolynomial decoded = decodeSmallPolynomial(bytes.data(), bytes.size(), &consumed);
+    EXPECT_EQ(consumed, encoded);
+    EXPECT_TRUE(std::equal(wide.data(), wide.data() + 9, decoded.data()));
+    EXPECT_EQ(decodeSmallPolynomial(bytes.data(), encoded).degree(), 9u);
+
+    SmallPolynomial zero(64, 7681);
+    bytes = encodeSmallPolynomial(zero);
+    EXPECT_EQ(bytes.size(), 17u + 8);
+    EXPECT_EQ(decodeSmallPolynomial(bytes.data(), bytes.size()).toPolynomial().getCoeffs(),
+              std::vector<uint64_t>(64, 0));
+}
+
+TEST(PolynomialCodecTest, RejectsMalformedRiceCodes) {
+    SmallPolynomial p(std::vector<int64_t>{3, -2, 0, 5}, 7681);
+    std::vector<uint8_t> bytes = encodeSmallPolynomial(p);
+    EXPECT_THROW(decodeSmallPolynomial(bytes.data(), bytes.size() - 1), std::invalid_argument);
+    EXPECT_THROW(decodeSmallPolynomial(bytes.data(), 10), std::invalid_argument);
+
+    // A payload of zero bits never terminates its first unary run
+    std::fill(bytes.begin() + 17, bytes.end(), 0);
+    EXPECT_THROW(decodeSmallPolynomial(bytes.data(), bytes.size()), std::invalid_argument);
+
+    bytes = encodeSmallPolynomial(p);
+    bytes[12] = 9;
+    EXPECT_THROW(decodeSmallPolynomial(bytes.data(), bytes.size()), std::invalid_argument);
+}
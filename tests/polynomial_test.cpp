@@ -1,5 +1,59 @@
 #include <gtest/gtest.h>
 #include <polynomial.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Count every heap allocation made by this test binary, so the tests below
+// can assert that tiny-ring arithmetic never reaches the allocator
+static std::atomic<size_t> allocation_count{0};
+
+// GCC flags free() on memory from the replaced operator new once the two
+// are inlined into the same caller, although they match here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Formatting enabled log messages allocates by design, so allocation
+// counts are taken with logging off
+struct QuietLogging {
+    bool saved = Logger::enable_logging;
+    QuietLogging() { Logger::enable_logging = false; }
+    ~QuietLogging() { Logger::enable_logging = saved; }
+};
 
 class PolynomialTest : public ::testing::Test {
 protected:
@@ -54,3 +108,160 @@ TEST_F(PolynomialTest, Addition) {
 }
 
 // Rest of the test file...
+
+TEST(PolynomialKernelTest, MulMonomialMatchesOneHotProduct) {
+    const size_t n = 16;
+    const uint64_t q = 7681;
+    std::vector<uint64_t> coeffs(n);
+    for (size_t i = 0; i < n; i++) coeffs[i] = (i * 977 + 5) % q;
+    coeffs[3] = 0;
+    Polynomial p(coeffs, q);
+
+    // x^k for k in [0, 2n) covers both signs; other k must wrap with period 2n
+    for (int64_t k = -2 * static_cast<int64_t>(n); k < 4 * static_cast<int64_t>(n); k++) {
+        const int64_t r = ((k % (2 * static_cast<int64_t>(n))) + 2 * n) % (2 * n);
+        std::vector<uint64_t> one_hot(n, 0);
+        one_hot[r % n] = r < static_cast<int64_t>(n) ? 1 : q - 1;
+        Polynomial monomial(one_hot, q);
+        EXPECT_EQ(p.mulMonomial(k).getCoeffs(), (p * monomial).getCoeffs()) << "k=" << k;
+    }
+}
+
+TEST(PolynomialKernelTest, RotateNegacyclicIsInvertible) {
+    const size_t n = 8;
+    const uint64_t q = 17;
+    std::vector<uint64_t> in = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<uint64_t> out(n), back(n);
+    Polynomial::rotateNegacyclic(out.data(), in.data(), n, 3, q);
+    EXPECT_EQ(out, (std::vector<uint64_t>{q - 6, q - 7, q - 8, 1, 2, 3, 4, 5}));
+    Polynomial::rotateNegacyclic(back.data(), out.data(), n, -3, q);
+    EXPECT_EQ(back, in);
+}
+
+TEST(PolynomialKernelTest, SparseProductMatchesConvolution) {
+    const size_t n = 64;
+    const uint64_t q = 12289;
+    std::vector<uint64_t> dense(n), ternary(n, 0), sparse(n, 0);
+    for (size_t i = 0; i < n; i++) dense[i] = (i * i * 31 + 7) % q;
+    ternary[0] = 1;
+    ternary[5] = q - 1;
+    ternary[63] = 1;
+    sparse[2] = 1000;
+    sparse[40] = q - 17;
+    sparse[41] = q / 2 + 1;   // Just above q/2: negative weight
+
+    Polynomial d(dense, q);
+    for (const auto& s : {ternary, sparse}) {
+        // Negacyclic convolution written out
+        std::vector<uint64_t> expected(n, 0);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                uint64_t prod = s[i] * dense[j] % q;
+                size_t k = (i + j) % n;
+                expected[k] = (i + j < n) ? (expected[k] + prod) % q : (expected[k] + q - prod) % q;
+            }
+        }
+
+        Polynomial sp(s, q);
+        EXPECT_EQ(sp.weight(), 3u);
+        EXPECT_EQ(sp.multiplySparse(d).getCoeffs(), expected);
+        EXPECT_EQ((sp * d).getCoeffs(), expected);
+        EXPECT_EQ((d * sp).getCoeffs(), expected);
+    }
+}
+
+TEST(PolynomialStorageTest, TinyRingArithmeticDoesNotAllocate) {
+    QuietLogging quiet;
+    // 7681 supports the NTT for both sizes; 7687 forces the schoolbook path
+    for (size_t n : {8, 32, 64}) {
+        for (uint64_t q : {7681, 7687}) {
+            std::vector<uint64_t> ca(n), cb(n);
+            for (size_t i = 0; i < n; i++) {
+                ca[i] = (i * 1237 + 11) % q;
+                cb[i] = (i * 7919 + 3) % q;
+            }
+            Polynomial a(ca, q);
+            Polynomial b(cb, q);
+            Polynomial sparse(n, q);
+            sparse[1] = 1;
+            sparse[n - 1] = q - 1;
+
+            auto work = [&]() {
+                Polynomial c = a * b + a - b;
+                c = -c * 3;
+                c = c + sparse * a + a.mulMonomial(5) + a.polySignal();
+                Polynomial copy(c);
+                c = std::move(copy);
+                return c;
+            };
+            // The first product builds and caches the ring's tables
+            work();
+
+            const size_t before = allocation_count.load();
+            Polynomial c = work();
+            const size_t after = allocation_count.load();
+
+            EXPECT_EQ(after, before) << "n=" << n << " q=" << q;
+            EXPECT_EQ(c.degree(), n);
+        }
+    }
+}
+
+TEST(PolynomialStorageTest, CopiesAndMovesAcrossInlineLimit) {
+    const uint64_t q = 7681;
+    for (size_t n : {CoeffBuffer::INLINE_CAPACITY, CoeffBuffer::INLINE_CAPACITY * 2}) {
+        std::vector<uint64_t> coeffs(n);
+        for (size_t i = 0; i < n; i++) coeffs[i] = i + 1;
+        Polynomial p(coeffs, q);
+
+        Polynomial copy(p);
+        copy[0] = 100;
+        EXPECT_EQ(p[0], 1u) << "copy must not share storage";
+
+        Polynomial moved(std::move(copy));
+        EXPECT_EQ(moved[0], 100u);
+        EXPECT_EQ(moved.getCoeffs().size(), n);
+
+        Polynomial assigned(n / 2, q);
+        assigned = p;
+        EXPECT_EQ(assigned.getCoeffs(), coeffs);
+        assigned = moved;
+        EXPECT_EQ(assigned[0], 100u);
+        EXPECT_EQ(p.getCoeffs(), coeffs);
+    }
+}
+
+TEST(PolynomialStorageTest, LargeRingCopiesShareUntilWritten) {
+    QuietLogging quiet;
+    const size_t n = 256;
+    const uint64_t q = 7681;
+    std::vector<uint64_t> coeffs(n);
+    for (size_t i = 0; i < n; i++) coeffs[i] = (i * 31) % q;
+    Polynomial p(coeffs, q);
+    EXPECT_FALSE(p.sharesStorage());
+
+    const size_t before = allocation_count.load();
+    Polynomial copy(p);
+    Polynomial assigned(n, q);
+    assigned = copy;
+    EXPECT_EQ(allocation_count.load(), before + 1) << "only the zero polynomial should allocate";
+    EXPECT_TRUE(p.sharesStorage());
+    EXPECT_EQ(copy.getCoeffs().data(), p.getCoeffs().data());
+    EXPECT_EQ(assigned.getCoeffs().data(), p.getCoeffs().data());
+
+    // Writing through any copy detaches only that copy
+    copy[3] = 1;
+    EXPECT_NE(copy.getCoeffs().data(), p.getCoeffs().data());
+    EXPECT_EQ(p.getCoeffs(), coeffs);
+    EXPECT_EQ(assigned.getCoeffs(), coeffs);
+    EXPECT_EQ(copy[3], 1u);
+
+    // Results computed from shared operands leave the operands untouched
+    Polynomial sum = assigned + p;
+    EXPECT_TRUE(p.sharesStorage());
+    EXPECT_EQ(sum[1], (2 * coeffs[1]) % q);
+
+    assigned = Polynomial(n, q);
+    EXPECT_FALSE(p.sharesStorage());
+    EXPECT_EQ(p.getCoeffs(), coeffs);
+}
@@ -0,0 +1,86 @@
+#include "reference.h"
+#include <sha256.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+static uint64_t mod(int64_t x, uint64_t m) {
+    int64_t r = x % static_cast<int64_t>(m);
+    return r < 0 ? r + m : r;
+}
+
+Polynomial Reference::multiply(const Polynomial& a, const Polynomial& b) {
+    const size_t ring_dim = a.degree();
+    const uint64_t modulus = a.getModulus();
+    if (ring_dim != b.degree() || modulus != b.getModulus()) {
+        throw std::invalid_argument("Polynomials must be in the same ring");
+    }
+
+    std::vector<uint64_t> temp(2 * ring_dim, 0);
+    for (size_t i = 0; i < ring_dim; i++) {
+        for (size_t j = 0; j < ring_dim; j++) {
+            uint64_t prod = (static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[j])) % modulus;
+            temp[i + j] = (temp[i + j] + prod) % modulus;
+        }
+    }
+
+    std::vector<uint64_t> result(ring_dim);
+    for (size_t i = 0; i < ring_dim; i++) {
+        result[i] = temp[i];
+        size_t higher_degree = i + ring_dim;
+        while (higher_degree < temp.size()) {
+            result[i] = mod(static_cast<int64_t>(result[i]) - static_cast<int64_t>(temp[higher_degree]), modulus);
+            higher_degree += ring_dim;
+        }
+    }
+    return Polynomial(result, modulus);
+}
+
+Polynomial Reference::polySignal(const Polynomial& p) {
+    const uint64_t modulus = p.getModulus();
+    const uint64_t half_mod = modulus / 2;
+    std::vector<uint64_t> result(p.degree());
+
+    for (size_t i = 0; i < p.degree(); i++) {
+        uint64_t coeff = p[i];
+        uint64_t dist_to_zero = std::min(coeff, modulus - coeff);
+        uint64_t dist_to_half = std::min(
+            (coeff >= half_mod) ? coeff - half_mod : half_mod - coeff,
+            (coeff >= half_mod) ? modulus - coeff + half_mod : modulus - half_mod + coeff
+        );
+        result[i] = (dist_to_zero <= dist_to_half) ? 0 : half_mod;
+    }
+    return Polynomial(result, modulus);
+}
+
+Polynomial Reference::hashToPolynomial(const std::vector<uint8_t>& message, size_t n, uint64_t q) {
+    std::vector<uint64_t> coeffs(n, 0);
+    size_t coeff_idx = 0;
+    uint32_t counter = 0;
+
+    while (coeff_idx < n) {
+        std::vector<uint8_t> block(sizeof(counter) + message.size());
+        std::memcpy(block.data(), &counter, sizeof(counter));
+        std::copy(message.begin(), message.end(), block.begin() + sizeof(counter));
+
+        std::vector<uint8_t> hash = SHA256::hash(block);
+        for (size_t byte_idx = 0; coeff_idx < n && byte_idx < hash.size(); byte_idx++) {
+            for (int bit = 7; bit >= 0 && coeff_idx < n; bit--) {
+                bool bit_value = (hash[byte_idx] >> bit) & 1;
+                coeffs[coeff_idx++] = bit_value ? (q / 2) : 0;
+            }
+        }
+        counter++;
+    }
+    return Polynomial(coeffs, q);
+}
+
+int64_t Reference::sampleGaussian(uint64_t r1, uint64_t r2, double stddev) {
+    double u1 = static_cast<double>(r1) / std::numeric_limits<uint64_t>::max();
+    double u2 = static_cast<double>(r2) / std::numeric_limits<uint64_t>::max();
+    double radius = std::sqrt(-2 * std::log(u1));
+    double theta = 2 * M_PI * u2;
+    return static_cast<int64_t>(std::round(radius * std::cos(theta) * stddev));
+}
@@ -0,0 +1,27 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <polynomial.h>
+#include <cstdint>
+#include <vector>
+
+// Frozen copies of the original scalar implementations. Optimized kernels
+// in the library are checked against these by the differential harness;
+// do not change their behaviour.
+class Reference {
+public:
+    // Schoolbook multiplication modulo (x^n + 1) and q
+    static Polynomial multiply(const Polynomial& a, const Polynomial& b);
+
+    // Round each coefficient to 0 or q/2, whichever is closer
+    static Polynomial polySignal(const Polynomial& p);
+
+    // Counter-based SHA256 expansion of a message to a {0, q/2} polynomial
+    static Polynomial hashToPolynomial(const std::vector<uint8_t>& message, size_t n, uint64_t q);
+
+    // Box-Muller Gaussian sample rounded to the nearest integer, drawn from
+    // two uniform words
+    static int64_t sampleGaussian(uint64_t r1, uint64_t r2, double stddev);
+};
+
+#endif // REFERENCE_H
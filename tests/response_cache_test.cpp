@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <response_cache.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Manually advanced clock for expiry tests
+struct FakeClock {
+    ResponseCache::Clock::time_point t{};
+
+    ResponseCache::TimeSource source() {
+        return [this]() { return t; };
+    }
+};
+
+std::vector<uint8_t> response(size_t size, uint8_t fill) {
+    return std::vector<uint8_t>(size, fill);
+}
+
+RequestDigest body(uint8_t tag) {
+    RequestDigest digest{};
+    digest[0] = tag;
+    return digest;
+}
+
+// A missed claim is released when the lookup goes out of scope
+bool cached(ResponseCache& cache, const std::string& request_id) {
+    return cache.begin(request_id, body(0)).status == CacheStatus::Hit;
+}
+
+bool put(ResponseCache& cache, const std::string& request_id, std::vector<uint8_t> stored) {
+    CacheLookup found = cache.begin(request_id, body(0));
+    return found.claim.store(std::move(stored));
+}
+
+} // namespace
+
+TEST(ResponseCacheTest, ReturnsStoredResponseUntilExpiry) {
+    FakeClock clock;
+    ResponseCache cache(1 << 20, std::chrono::milliseconds(1000), clock.source());
+    CacheLookup first = cache.begin("swap-1", body(0));
+    EXPECT_EQ(first.status, CacheStatus::Miss);
+
+    EXPECT_TRUE(first.claim.store(response(100, 7)));
+    clock.t += std::chrono::milliseconds(999);
+    CacheLookup found = cache.begin("swap-1", body(0));
+    ASSERT_EQ(found.status, CacheStatus::Hit);
+    EXPECT_EQ(found.response, response(100, 7));
+
+    clock.t += std::chrono::milliseconds(1);
+    EXPECT_FALSE(cached(cache, "swap-1"));
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.bytes(), 0u);
+    EXPECT_EQ(cache.hits(), 1u);
+    EXPECT_EQ(cache.misses(), 2u);
+}
+
+TEST(ResponseCacheTest, RefusesReusedIdWithDifferentBody) {
+    ResponseCache cache(1 << 20, std::chrono::milliseconds(1000));
+    CacheLookup first = cache.begin("swap-1", body(1));
+    ASSERT_EQ(first.status, CacheStatus::Miss);
+    // Still in flight: a different body is refused without waiting
+    EXPECT_EQ(cache.begin("swap-1", body(2)).status, CacheStatus::Conflict);
+
+    first.claim.store(response(10, 1));
+    EXPECT_EQ(cache.begin("swap-1", body(2)).status, CacheStatus::Conflict);
+    EXPECT_EQ(cache.begin("swap-1", body(1)).status, CacheStatus::Hit);
+    EXPECT_EQ(cache.conflicts(), 2u);
+}
+
+TEST(ResponseCacheTest, RetryWaitsForFirstAttempt) {
+    ResponseCache cache(1 << 20, std::chrono::milliseconds(60000));
+    CacheLookup first = cache.begin("swap-1", body(1));
+    ASSERT_EQ(first.status, CacheStatus::Miss);
+
+    CacheLookup retried{CacheStatus::Miss, {}, {}};
+    std::thread retry([&]() { retried = cache.begin("swap-1", body(1)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    first.claim.store(response(10, 3));
+    retry.join();
+    EXPECT_EQ(retried.status, CacheStatus::Hit);
+    EXPECT_EQ(retried.response, response(10, 3));
+
+    // A released claim passes to the waiting retry
+    CacheLookup second = cache.begin("swap-2", body(1));
+    ASSERT_EQ(second.status, CacheStatus::Miss);
+    std::thread waiter([&]() { retried = cache.begin("swap-2", body(1)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    second.claim.release();
+    waiter.join();
+    EXPECT_EQ(retried.status, CacheStatus::Miss);
+    EXPECT_TRUE(retried.claim);
+}
+
+TEST(ResponseCacheTest, DroppedClaimReleasesId) {
+    ResponseCache cache(1 << 20, std::chrono::milliseconds(60000));
+    try {
+        CacheLookup first = cache.begin("swap-1", body(1));
+        ASSERT_EQ(first.status, CacheStatus::Miss);
+        throw std::runtime_error("request failed");
+    } catch (const std::runtime_error&) {
+    }
+    CacheLookup retried = cache.begin("swap-1", body(1));
+    EXPECT_EQ(retried.status, CacheStatus::Miss);
+
+    // A moved claim is released once, by its new holder
+    CacheClaim moved = std::move(retried.claim);
+    EXPECT_FALSE(retried.claim);
+    EXPECT_TRUE(moved);
+    moved = CacheClaim();
+    EXPECT_EQ(cache.begin("swap-1", body(1)).status, CacheStatus::Miss);
+}
+
+TEST(ResponseCacheTest, RetryGivesUpOnStuckAttempt) {
+    ResponseCache cache(1 << 20, std::chrono::milliseconds(50));
+    CacheLookup first = cache.begin("swap-1", body(1));
+    ASSERT_EQ(first.status, CacheStatus::Miss);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(cache.begin("swap-1", body(1)).status, CacheStatus::Conflict);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    EXPECT_EQ(cache.conflicts(), 1u);
+}
+
+TEST(ResponseCacheTest, OversizedResponseReachesWaitingRetry) {
+    ResponseCache cache(1024, std::chrono::milliseconds(60000));
+    CacheLookup first = cache.begin("swap-1", body(0));
+    ASSERT_EQ(first.status, CacheStatus::Miss);
+
+    CacheLookup retried{CacheStatus::Miss, {}, {}};
+    std::thread retry([&]() { retried = cache.begin("swap-1", body(0)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(first.claim.store(response(4096, 5)));
+    retry.join();
+    EXPECT_EQ(retried.status, CacheStatus::Hit);
+    EXPECT_EQ(retried.response, response(4096, 5));
+
+    // Not cached for retries that come later
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_FALSE(cached(cache, "swap-1"));
+    EXPECT_THROW(first.claim.store(response(1, 1)), std::runtime_error);
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsedWithinBudget) {
+    FakeClock clock;
+    const size_t entry = 1000 + 2 + ResponseCache::ENTRY_OVERHEAD;
+    ResponseCache cache(3 * entry, std::chrono::milliseconds(1000), clock.source());
+    put(cache, "r1", response(1000, 1));
+    put(cache, "r2", response(1000, 2));
+    put(cache, "r3", response(1000, 3));
+    EXPECT_EQ(cache.bytes(), 3 * entry);
+
+    // r1 becomes the most recently used, so r2 is evicted for r4
+    ASSERT_TRUE(cached(cache, "r1"));
+    put(cache, "r4", response(1000, 4));
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_EQ(cache.evictions(), 1u);
+    EXPECT_FALSE(cached(cache, "r2"));
+    EXPECT_TRUE(cached(cache, "r1"));
+    EXPECT_TRUE(cached(cache, "r3"));
+    EXPECT_TRUE(cached(cache, "r4"));
+
+    // Expired entries make room without counting as evictions
+    clock.t += std::chrono::milliseconds(1000);
+    put(cache, "r5", response(1000, 5));
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.evictions(), 1u);
+
+    // A replacement after expiry is charged anew; oversized responses are
+    // not kept
+    ASSERT_TRUE(cached(cache, "r5"));
+    clock.t += std::chrono::milliseconds(1000);
+    EXPECT_TRUE(put(cache, "r5", response(10, 6)));
+    EXPECT_EQ(cache.bytes(), 2 + 10 + ResponseCache::ENTRY_OVERHEAD);
+    EXPECT_FALSE(put(cache, "r6", response(4 * entry, 0)));
+    EXPECT_FALSE(cached(cache, "r6"));
+    EXPECT_EQ(cache.begin("r5", body(0)).response, response(10, 6));
+}
+
+TEST(ResponseCacheTest, RejectsEmptyBudgetOrLifetime) {
+    EXPECT_THROW(ResponseCache(0, std::chrono::milliseconds(1)), std::invalid_argument);
+    EXPECT_THROW(ResponseCache(1024, std::chrono::milliseconds(0)), std::invalid_argument);
+}
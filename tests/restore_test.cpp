@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <restore.h>
+#include <rlwe.h>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> walletSeed() {
+    return std::vector<uint8_t>(32, 0x5a);
+}
+
+// Mint that remembers the blind signature of every message it signed
+struct SigningMint {
+    explicit SigningMint(RLWESignature& signer) : rlwe(signer) {}
+
+    void sign(const Polynomial& blinded) {
+        signed_messages.emplace(blinded.getCoeffs(), rlwe.blindSign(blinded));
+    }
+
+    SignatureLookup lookup() {
+        return [this](const std::vector<Polynomial>& blinded) {
+            std::vector<std::optional<Polynomial>> responses;
+            for (const auto& message : blinded) {
+                auto it = signed_messages.find(message.getCoeffs());
+                responses.push_back(it == signed_messages.end() ? std::nullopt
+                                                                : std::optional<Polynomial>(it->second));
+            }
+            batch_sizes.push_back(blinded.size());
+            return responses;
+        };
+    }
+
+    RLWESignature& rlwe;
+    std::map<std::vector<uint64_t>, Polynomial> signed_messages;
+    std::vector<size_t> batch_sizes;
+};
+
+} // namespace
+
+TEST(RestoreTest, CandidatesMatchProtocolBlinding) {
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    SeedDerivation wallet(walletSeed(), rlwe.keysetId());
+    WalletRestorer restorer(wallet, rlwe.getPublicKey().first, rlwe.getPublicKey().second);
+
+    // Odd count so the last group of eight is partial
+    std::vector<Polynomial> candidates = restorer.blindedMessages(3, 13);
+    ASSERT_EQ(candidates.size(), 13u);
+    for (uint64_t k = 0; k < candidates.size(); k++) {
+        Polynomial expected = rlwe.computeBlindedMessage(wallet.secret(3 + k), wallet.blindingFactor(3 + k, params));
+        EXPECT_EQ(candidates[k].getCoeffs(), expected.getCoeffs()) << "counter=" << 3 + k;
+    }
+}
+
+TEST(RestoreTest, RestoresSignedTokensAcrossGaps) {
+    for (uint64_t q : {uint64_t(7681), uint64_t(7919)}) {  // NTT and fallback products
+        RLWESignature rlwe(256, q);
+        rlwe.generateKeys();
+        const ParameterSet& params = ParameterSet::get(256, q);
+        SeedDerivation wallet(walletSeed(), rlwe.keysetId());
+
+        // Counter 300 lies more than the gap limit past 180 and is lost
+        const std::set<uint64_t> issued = {0, 1, 2, 3, 40, 95, 180, 300};
+        SigningMint mint(rlwe);
+        for (uint64_t counter : issued) {
+            mint.sign(rlwe.computeBlindedMessage(wallet.secret(counter), wallet.blindingFactor(counter, params)));
+        }
+
+        WalletRestorer restorer(wallet, rlwe.getPublicKey().first, rlwe.getPublicKey().second, 32, 100);
+        RestoreResult result = restorer.restore(mint.lookup());
+
+        std::vector<uint64_t> counters;
+        for (const auto& token : result.tokens) {
+            counters.push_back(token.counter);
+            EXPECT_EQ(token.secret, wallet.secret(token.counter));
+            EXPECT_TRUE(rlwe.verify(token.secret, token.signature)) << "q=" << q << " counter=" << token.counter;
+        }
+        EXPECT_EQ(counters, (std::vector<uint64_t>{0, 1, 2, 3, 40, 95, 180}));
+        EXPECT_EQ(result.next_counter, 181u);
+        EXPECT_EQ(result.scanned, 281u);
+        EXPECT_EQ(result.lookups, mint.batch_sizes.size());
+        EXPECT_EQ(mint.batch_sizes.back(), 281u % 32);
+    }
+}
+
+TEST(RestoreTest, EmptyWalletScansOneWindowFromStart) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    SeedDerivation wallet(walletSeed(), rlwe.keysetId());
+    WalletRestorer restorer(wallet, rlwe.getPublicKey().first, rlwe.getPublicKey().second, 64, 20);
+    SigningMint mint(rlwe);
+
+    RestoreResult result = restorer.restore(mint.lookup(), 1000);
+    EXPECT_TRUE(result.tokens.empty());
+    EXPECT_EQ(result.next_counter, 1000u);
+    EXPECT_EQ(result.scanned, 20u);
+    EXPECT_EQ(result.lookups, 1u);
+}
+
+TEST(RestoreTest, RejectsBadConfigurationAndResponses) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    SeedDerivation wallet(walletSeed(), rlwe.keysetId());
+    const auto key = rlwe.getPublicKey();
+
+    EXPECT_THROW(WalletRestorer(wallet, key.first, key.second, 0, 10), std::invalid_argument);
+    EXPECT_THROW(WalletRestorer(wallet, key.first, key.second, 10, 0), std::invalid_argument);
+    EXPECT_THROW(WalletRestorer(wallet, key.first, Polynomial(128, 7681)), std::invalid_argument);
+
+    WalletRestorer restorer(wallet, key.first, key.second, 16, 16);
+    SignatureLookup short_lookup = [](const std::vector<Polynomial>& blinded) {
+        return std::vector<std::optional<Polynomial>>(blinded.size() - 1);
+    };
+    EXPECT_THROW(restorer.restore(short_lookup), std::runtime_error);
+
+    SignatureLookup wrong_ring = [](const std::vector<Polynomial>& blinded) {
+        std::vector<std::optional<Polynomial>> responses(blinded.size());
+        responses[0] = Polynomial(8, 7681);
+        return responses;
+    };
+    EXPECT_THROW(restorer.restore(wrong_ring), std::runtime_error);
+}
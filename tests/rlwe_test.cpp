@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include "rlwe.h"
 #include "logging.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <random>
 
 class RLWETest : public ::testing::Test {
 protected:
@@ -285,3 +289,140 @@ TEST_F(RLWETest, VerifyFailsOnZeroSignature) {
     Logger::log("Zero signature verification result: " + std::string(verified ? "INCORRECTLY SUCCEEDED" : "CORRECTLY FAILED"));
     EXPECT_FALSE(verified) << "Zero signature incorrectly verified";
 }
+
+TEST(RLWEBatchTest, BatchSignAndVerifyMatchSingle) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    const Polynomial b = rlwe.getPublicKey().second;
+
+    // 11 messages: one full batch of eight and a partial one
+    std::vector<std::vector<uint8_t>> secrets;
+    std::vector<Polynomial> blinded, factors;
+    for (uint8_t k = 0; k < 11; k++) {
+        secrets.push_back({0x42, k});
+        auto [message, factor] = rlwe.computeBlindedMessage(secrets.back());
+        blinded.push_back(message);
+        factors.push_back(factor);
+    }
+
+    std::vector<Polynomial> blindSignatures = rlwe.blindSignBatch(blinded);
+    ASSERT_EQ(blindSignatures.size(), blinded.size());
+    std::vector<Polynomial> signatures;
+    for (size_t k = 0; k < blinded.size(); k++) {
+        signatures.push_back(rlwe.computeSignature(blindSignatures[k], factors[k], b));
+    }
+
+    std::vector<bool> results = rlwe.verifyBatch(secrets, signatures);
+    for (size_t k = 0; k < secrets.size(); k++) {
+        EXPECT_TRUE(results[k]) << "signature " << k;
+        EXPECT_EQ(results[k], rlwe.verify(secrets[k], signatures[k]));
+    }
+
+    // Signatures swapped between messages must all be rejected
+    std::rotate(signatures.begin(), signatures.begin() + 1, signatures.end());
+    for (bool result : rlwe.verifyBatch(secrets, signatures)) {
+        EXPECT_FALSE(result);
+    }
+    EXPECT_THROW(rlwe.verifyBatch(secrets, {}), std::invalid_argument);
+}
+
+TEST(RLWEBatchTest, InPlaceBatchVerifyMatchesSingle) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    const Polynomial b = rlwe.getPublicKey().second;
+
+    std::vector<std::vector<uint8_t>> secrets;
+    PolynomialBatch signatures(11, 256, 7681);
+    for (uint8_t k = 0; k < 11; k++) {
+        secrets.push_back(std::vector<uint8_t>(k, k));
+        auto [message, factor] = rlwe.computeBlindedMessage(secrets.back());
+        Polynomial signature = rlwe.computeSignature(rlwe.blindSign(message), factor, b);
+        // Every third signature belongs to another secret
+        if (k % 3 == 2) {
+            signature = rlwe.computeSignature(rlwe.blindSign(rlwe.computeBlindedMessage({0xff}).first), factor, b);
+        }
+        std::copy(signature.getCoeffs().begin(), signature.getCoeffs().end(), signatures.row(k));
+    }
+
+    std::vector<const uint8_t*> pointers;
+    std::vector<size_t> sizes;
+    for (const auto& secret : secrets) {
+        pointers.push_back(secret.data());
+        sizes.push_back(secret.size());
+    }
+    bool results[11];
+    rlwe.verifyBatch(pointers.data(), sizes.data(), signatures, results);
+    for (size_t k = 0; k < secrets.size(); k++) {
+        EXPECT_EQ(results[k], k % 3 != 2) << "signature " << k;
+        EXPECT_EQ(results[k], rlwe.verify(secrets[k], signatures[k]));
+    }
+
+    // Signatures of another ring are rejected, not thrown on
+    PolynomialBatch other(11, 512, 7681);
+    rlwe.verifyBatch(pointers.data(), sizes.data(), other, results);
+    for (bool result : results) {
+        EXPECT_FALSE(result);
+    }
+}
+
+TEST(RLWEKeyTest, PublicKeyIsSharedNotCopied) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+
+    auto first = rlwe.getPublicKey();
+    auto second = rlwe.getPublicKey();
+    EXPECT_EQ(first.first.getCoeffs().data(), second.first.getCoeffs().data());
+    EXPECT_EQ(first.second.getCoeffs().data(), second.second.getCoeffs().data());
+
+    // A caller modifying its copy does not change the key
+    const std::vector<uint64_t> original = second.second.getCoeffs();
+    first.second[0] = (first.second[0] + 1) % 7681;
+    EXPECT_EQ(rlwe.getPublicKey().second.getCoeffs(), original);
+    EXPECT_NE(first.second.getCoeffs(), original);
+}
+
+TEST(RLWEKeyTest, KeysRoundTripThroughKeyFile) {
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("rlwe_key_" + std::to_string(std::random_device{}()) + ".key")).string();
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    EXPECT_THROW(mint.saveKeys(path), std::runtime_error);
+    mint.generateKeys();
+    mint.saveKeys(path);
+
+    // Bit-packed public key plus a Golomb-Rice coded secret, against 6 KiB
+    // for the 64-bit key in memory
+    EXPECT_LT(std::filesystem::file_size(path), 1100u);
+    // The secret key is readable by the owner only, and no temporary file
+    // is left behind
+    const auto perms = std::filesystem::status(path).permissions();
+    EXPECT_EQ(perms & (std::filesystem::perms::group_all | std::filesystem::perms::others_all),
+              std::filesystem::perms::none);
+    size_t siblings = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(path).parent_path())) {
+        siblings += entry.path().string().rfind(path, 0) == 0;
+    }
+    EXPECT_EQ(siblings, 1u);
+
+    RLWESignature restored(ParameterPreset::RLWE_256_Q7681);
+    restored.loadKeys(path);
+    EXPECT_EQ(restored.keysetId(), mint.keysetId());
+    EXPECT_EQ(restored.getPublicKey().second.getCoeffs(), mint.getPublicKey().second.getCoeffs());
+
+    // Signatures from the loaded secret verify against the original
+    const std::vector<uint8_t> secret = {1, 2, 3};
+    auto [blinded, r] = mint.computeBlindedMessage(secret);
+    Polynomial signature = mint.computeSignature(restored.blindSign(blinded), r, mint.getPublicKey().second);
+    EXPECT_TRUE(mint.verify(secret, signature));
+
+    // Loading without knowing the ring in advance
+    std::unique_ptr<RLWESignature> found = RLWESignature::fromKeyFile(path);
+    EXPECT_EQ(found->keysetId(), mint.keysetId());
+    EXPECT_TRUE(found->verify(secret, signature));
+
+    RLWESignature other(512, 12289);
+    EXPECT_THROW(other.loadKeys(path), std::runtime_error);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_THROW(restored.loadKeys(path), std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(restored.loadKeys(path), std::runtime_error);
+}
@@ -69,3 +69,11 @@ TEST(SHA256Test, ConsistentHashes) {
     auto hash2 = SHA256::hash(msg);
     EXPECT_EQ(hash1, hash2);
 }
+
+TEST(SHA256Test, RawBufferMatchesVectorHash) {
+    std::string msg = "hello world";
+    std::vector<uint8_t> data(msg.begin(), msg.end());
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256::hash(data.data(), data.size(), digest);
+    EXPECT_EQ(std::vector<uint8_t>(digest, digest + SHA256_DIGEST_LENGTH), SHA256::hash(data));
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include <signature_index.h>
+#include <restore.h>
+#include <rlwe.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+class SignatureIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() /
+                ("rlwe_index_" + std::to_string(std::random_device{}()) + ".log")).string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    std::string path;
+};
+
+std::vector<Polynomial> blindedMessages(RLWESignature& rlwe, size_t count, uint8_t tag) {
+    std::vector<Polynomial> messages;
+    for (size_t k = 0; k < count; k++) {
+        messages.push_back(rlwe.computeBlindedMessage({tag, static_cast<uint8_t>(k)}).first);
+    }
+    return messages;
+}
+
+} // namespace
+
+TEST_F(SignatureIndexTest, RecordsIssuedSignaturesAcrossReopen) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    std::vector<Polynomial> messages = blindedMessages(mint, 8, 1);
+    std::vector<Polynomial> signatures;
+    {
+        SignatureIndex index(path);
+        mint.setSignatureIndex(&index);
+        for (size_t k = 0; k < 5; k++) {
+            signatures.push_back(mint.blindSign(messages[k]));
+        }
+        std::vector<Polynomial> batch = mint.blindSignBatch({messages.begin() + 5, messages.end()});
+        signatures.insert(signatures.end(), batch.begin(), batch.end());
+        mint.setSignatureIndex(nullptr);
+        mint.blindSign(blindedMessages(mint, 1, 2)[0]);
+
+        EXPECT_EQ(index.size(), 8u);
+        // 13-bit coefficients instead of 64-bit ones
+        EXPECT_LT(index.storedBytes(), 8 * 256 * sizeof(uint64_t) / 4);
+    }
+
+    SignatureIndex reopened(path);
+    ASSERT_EQ(reopened.size(), 8u);
+    messages.push_back(blindedMessages(mint, 1, 3)[0]);
+    std::vector<std::optional<Polynomial>> found = reopened.lookup(messages);
+    ASSERT_EQ(found.size(), 9u);
+    for (size_t k = 0; k < 8; k++) {
+        ASSERT_TRUE(found[k].has_value()) << k;
+        EXPECT_EQ(found[k]->getCoeffs(), signatures[k].getCoeffs()) << k;
+    }
+    EXPECT_FALSE(found[8].has_value());
+
+    std::vector<std::optional<IssuedSignature>> issued = reopened.lookup({digestBlindedMessage(messages[0])});
+    ASSERT_TRUE(issued[0].has_value());
+    EXPECT_EQ(issued[0]->keyset, mint.keysetId());
+}
+
+TEST_F(SignatureIndexTest, DropsTornRecordAtTail) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    std::vector<Polynomial> messages = blindedMessages(mint, 4, 1);
+    {
+        SignatureIndex index(path);
+        mint.setSignatureIndex(&index);
+        for (const auto& message : messages) {
+            mint.blindSign(message);
+        }
+    }
+
+    // Cut the last record short, as a crash during the append would
+    const auto full_size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, full_size - 10);
+    {
+        SignatureIndex index(path);
+        EXPECT_EQ(index.size(), 3u);
+        EXPECT_FALSE(index.lookup({messages[3]})[0].has_value());
+
+        mint.setSignatureIndex(&index);
+        mint.blindSign(messages[3]);
+        mint.setSignatureIndex(nullptr);
+    }
+
+    SignatureIndex index(path);
+    EXPECT_EQ(index.size(), 4u);
+    for (const auto& found : index.lookup(messages)) {
+        EXPECT_TRUE(found.has_value());
+    }
+}
+
+TEST_F(SignatureIndexTest, RefusesCorruptRecordBeforeTail) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    {
+        SignatureIndex index(path);
+        mint.setSignatureIndex(&index);
+        for (const auto& message : blindedMessages(mint, 4, 1)) {
+            mint.blindSign(message);
+        }
+        mint.setSignatureIndex(nullptr);
+    }
+
+    // Flip a coefficient byte in the second record
+    const auto full_size = std::filesystem::file_size(path);
+    const std::streamoff record_size = static_cast<std::streamoff>((full_size - 8) / 4);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(8 + record_size + 100);
+        const char byte = static_cast<char>(file.get());
+        file.seekp(8 + record_size + 100);
+        file.put(static_cast<char>(~byte));
+    }
+    EXPECT_THROW(SignatureIndex index(path), std::runtime_error);
+    EXPECT_EQ(std::filesystem::file_size(path), full_size);
+}
+
+TEST_F(SignatureIndexTest, LookupsReadRecordsFromTheFile) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    std::vector<Polynomial> messages = blindedMessages(mint, 4, 1);
+    SignatureIndex index(path);
+    mint.setSignatureIndex(&index);
+    for (const auto& message : messages) {
+        mint.blindSign(message);
+    }
+    index.flush();
+    EXPECT_EQ(std::filesystem::file_size(path), 8 + index.storedBytes());
+
+    // Damage the third record behind the open index: only that lookup fails
+    const std::streamoff record_size = static_cast<std::streamoff>(index.storedBytes() / 4);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(8 + 2 * record_size + 100);
+        const char byte = static_cast<char>(file.get());
+        file.seekp(8 + 2 * record_size + 100);
+        file.put(static_cast<char>(~byte));
+    }
+    EXPECT_TRUE(index.lookup(std::vector<Polynomial>{messages[1]})[0].has_value());
+    EXPECT_THROW(index.lookup(std::vector<Polynomial>{messages[2]}), std::runtime_error);
+    mint.setSignatureIndex(nullptr);
+}
+
+TEST_F(SignatureIndexTest, RejectsFilesThatAreNotIndexes) {
+    std::ofstream(path) << "not a signature index";
+    EXPECT_THROW(SignatureIndex index(path), std::runtime_error);
+}
+
+TEST_F(SignatureIndexTest, PacksWideModuli) {
+    // 61-bit coefficients take the two-word path of the bit packer
+    const uint64_t q = (uint64_t(1) << 61) - 1;
+    Polynomial blinded(std::vector<uint64_t>{1, 2, 3, 4}, q);
+    Polynomial signature(std::vector<uint64_t>{q - 1, 0, uint64_t(1) << 60, 12345}, q);
+    {
+        SignatureIndex index(path);
+        index.record(blinded, signature, KeysetId{1, 2, 3, 4, 5, 6, 7, 8});
+    }
+    SignatureIndex index(path);
+    std::optional<Polynomial> found = index.lookup(std::vector<Polynomial>{blinded})[0];
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->getModulus(), q);
+    EXPECT_EQ(found->getCoeffs(), signature.getCoeffs());
+}
+
+TEST_F(SignatureIndexTest, AnswersRestoreWhileSigning) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    SignatureIndex index(path);
+    mint.setSignatureIndex(&index);
+
+    SeedDerivation wallet(std::vector<uint8_t>(32, 7), mint.keysetId());
+    for (uint64_t counter = 0; counter < 10; counter++) {
+        mint.blindSign(mint.computeBlindedMessage(wallet.secret(counter), wallet.blindingFactor(counter, params)));
+    }
+
+    // Another mint keeps signing into the same index during the restore
+    RLWESignature other(ParameterPreset::RLWE_256_Q7681);
+    other.generateKeys();
+    std::vector<Polynomial> other_messages = blindedMessages(other, 64, 9);
+    other.setSignatureIndex(&index);
+    std::thread signer([&other, &other_messages]() {
+        for (const auto& message : other_messages) {
+            other.blindSign(message);
+        }
+    });
+
+    WalletRestorer restorer(wallet, mint.getPublicKey().first, mint.getPublicKey().second, 16, 20);
+    RestoreResult result = restorer.restore([&index](const std::vector<Polynomial>& blinded) {
+        return index.lookup(blinded);
+    });
+    signer.join();
+
+    ASSERT_EQ(result.tokens.size(), 10u);
+    for (const auto& token : result.tokens) {
+        EXPECT_TRUE(mint.verify(token.secret, token.signature)) << token.counter;
+    }
+    EXPECT_EQ(index.size(), 74u);
+}
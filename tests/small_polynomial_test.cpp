@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <small_polynomial.h>
+#include <sampler.h>
+#include <rlwe.h>
+#include <random>
+#include <vector>
+
+static Polynomial randomPolynomial(size_t n, uint64_t q, std::mt19937_64& rng) {
+    std::vector<uint64_t> coeffs(n);
+    for (auto& c : coeffs) c = rng() % q;
+    return Polynomial(coeffs, q);
+}
+
+static SmallPolynomial randomSmall(size_t n, uint64_t q, int64_t bound, std::mt19937_64& rng) {
+    std::vector<int64_t> values(n);
+    for (auto& v : values) v = static_cast<int64_t>(rng() % (2 * bound + 1)) - bound;
+    return SmallPolynomial(values, q);
+}
+
+TEST(SmallPolynomialTest, ConvertsCenteredCoefficients) {
+    SmallPolynomial p({-127, -1, 0, 1, 127, -15, 15, 3}, 7681);
+    Polynomial full = p.toPolynomial();
+    EXPECT_EQ(full.getCoeffs(), std::vector<uint64_t>({7681 - 127, 7680, 0, 1, 127, 7681 - 15, 15, 3}));
+    SmallPolynomial back = SmallPolynomial::fromPolynomial(full);
+    for (size_t i = 0; i < 8; i++) {
+        EXPECT_EQ(back[i], p[i]);
+    }
+
+    EXPECT_THROW(SmallPolynomial(std::vector<int64_t>{128}, 7681), std::invalid_argument);
+    EXPECT_THROW(SmallPolynomial(std::vector<int64_t>{-128}, 7681), std::invalid_argument);
+    EXPECT_THROW(SmallPolynomial(std::vector<int64_t>{9}, 17), std::invalid_argument);
+    EXPECT_EQ(SmallPolynomial(std::vector<int64_t>{-8}, 17).toPolynomial()[0], 9u);
+    EXPECT_THROW(SmallPolynomial::fromPolynomial(Polynomial({0, 3840}, 7681)), std::invalid_argument);
+}
+
+TEST(SmallPolynomialTest, ProductsMatchFullArithmetic) {
+    std::mt19937_64 rng(7);
+    // 7687 is not NTT-friendly; 65537 is too large for the 32-bit direct
+    // kernel at n = 512 and takes the NTT path
+    const std::vector<std::pair<size_t, uint64_t>> rings = {
+        {8, 7681}, {64, 7681}, {128, 12289}, {256, 7681}, {512, 12289}, {32, 7687}, {512, 65537},
+    };
+    for (const auto& [n, q] : rings) {
+        for (int64_t bound : {1, 15, 127}) {
+            SmallPolynomial small = randomSmall(n, q, bound, rng);
+            Polynomial full = randomPolynomial(n, q, rng);
+            Polynomial expected = small.toPolynomial() * full;
+            EXPECT_EQ((small * full).getCoeffs(), expected.getCoeffs()) << "n=" << n << " q=" << q;
+            EXPECT_EQ((full * small).getCoeffs(), expected.getCoeffs()) << "n=" << n << " q=" << q;
+            EXPECT_EQ((full + small).getCoeffs(), (full + small.toPolynomial()).getCoeffs());
+        }
+    }
+
+    // Unreduced full operands are reduced first
+    SmallPolynomial small({1, -2, 3, -4}, 17);
+    Polynomial unreduced({20, 35, 1, 16}, 17);
+    Polynomial reduced({3, 1, 1, 16}, 17);
+    EXPECT_EQ((small * unreduced).getCoeffs(), (small * reduced).getCoeffs());
+    EXPECT_THROW(small * Polynomial(8, 17), std::invalid_argument);
+}
+
+TEST(SmallPolynomialTest, CenteredSamplerMatchesTableSampler) {
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    std::mt19937_64 rng(11);
+    std::vector<uint64_t> words(params.n);
+    for (auto& w : words) w = rng();
+
+    SmallPolynomial small = SmallPolynomial::sampleGaussian(words.data(), params);
+    std::vector<uint64_t> expected(params.n);
+    GaussianSampler::sample(expected.data(), words.data(), params.n, params);
+    EXPECT_EQ(small.toPolynomial().getCoeffs(), expected);
+    for (size_t i = 0; i < params.n; i++) {
+        EXPECT_LE(std::abs(static_cast<int>(small[i])), static_cast<int>(params.cdt_size));
+    }
+}
+
+TEST(SmallPolynomialTest, RejectsDeviationsThatSaturate) {
+    EXPECT_THROW(RLWESignature(256, 7681, 20.0), std::invalid_argument);
+    EXPECT_THROW(RLWESignature(256, 7681, 12.5), std::invalid_argument);
+    RLWESignature wide(256, 7681, 12.0);
+    EXPECT_NO_THROW(wide.generateKeys());
+
+    // Tables for other deviations stay within a signed byte
+    const ParameterSet& preset = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    EXPECT_LE(GaussianSampler::withDeviation(preset, 12.0)->cdt_size, 127u);
+    EXPECT_EQ(GaussianSampler::withDeviation(preset, 2.5)->sigma, 2.5);
+    EXPECT_THROW(GaussianSampler::withDeviation(preset, 0.0), std::invalid_argument);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <text_codec.h>
+#include <polynomial_codec.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string toBase64url(const std::vector<uint8_t>& bytes) {
+    std::string text(base64urlEncodedSize(bytes.size()), '\0');
+    base64urlEncode(bytes.data(), bytes.size(), &text[0]);
+    return text;
+}
+
+std::vector<uint8_t> fromBase64url(const std::string& text) {
+    std::vector<uint8_t> bytes(base64urlDecodedSize(text.size()));
+    base64urlDecode(text.data(), text.size(), bytes.data());
+    return bytes;
+}
+
+std::vector<uint8_t> randomBytes(std::mt19937& rng, size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(TextCodecTest, Base64urlMatchesRfc4648) {
+    const std::vector<std::pair<std::string, std::string>> vectors = {
+        {"", ""}, {"f", "Zg"}, {"fo", "Zm8"}, {"foo", "Zm9v"},
+        {"foob", "Zm9vYg"}, {"fooba", "Zm9vYmE"}, {"foobar", "Zm9vYmFy"}};
+    for (const auto& [plain, encoded] : vectors) {
+        std::vector<uint8_t> bytes(plain.begin(), plain.end());
+        EXPECT_EQ(toBase64url(bytes), encoded);
+        EXPECT_EQ(fromBase64url(encoded), bytes);
+    }
+    // The two characters that differ from standard base64
+    EXPECT_EQ(toBase64url({0xfb, 0xff, 0xbf}), "-_-_");
+
+    // Every length around the block size round-trips
+    std::mt19937 rng(3);
+    for (size_t size = 0; size < 800; size += 7) {
+        std::vector<uint8_t> bytes = randomBytes(rng, size);
+        EXPECT_EQ(fromBase64url(toBase64url(bytes)), bytes);
+    }
+}
+
+TEST(TextCodecTest, Base64urlRejectsInvalidText) {
+    EXPECT_THROW(base64urlDecodedSize(5), std::invalid_argument);
+    for (const std::string text : {"Zm9v=", "Zm9=", "Zm+v", "Zm/v", "Zm v", "Zm\x80v"}) {
+        std::vector<uint8_t> out(8);
+        EXPECT_THROW(base64urlDecode(text.data(), text.size(), out.data()), std::invalid_argument) << text;
+    }
+    // "Zh" sets bits past the one decoded byte
+    uint8_t out[1];
+    EXPECT_THROW(base64urlDecode("Zh", 2, out), std::invalid_argument);
+
+    // An invalid character deep inside a long input
+    std::string text(1000, 'A');
+    text[777] = '.';
+    std::vector<uint8_t> bytes(base64urlDecodedSize(text.size()));
+    EXPECT_THROW(base64urlDecode(text.data(), text.size(), bytes.data()), std::invalid_argument);
+}
+
+TEST(TextCodecTest, HexRoundTripsAndValidates) {
+    std::vector<uint8_t> bytes = {0x00, 0x01, 0x9a, 0xff, 0x5c};
+    std::string text(hexEncodedSize(bytes.size()), '\0');
+    hexEncode(bytes.data(), bytes.size(), &text[0]);
+    EXPECT_EQ(text, "00019aff5c");
+
+    std::vector<uint8_t> decoded(bytes.size());
+    hexDecode("00019AFF5c", 10, decoded.data());
+    EXPECT_EQ(decoded, bytes);
+
+    EXPECT_THROW(hexDecode("001", 3, decoded.data()), std::invalid_argument);
+    EXPECT_THROW(hexDecode("0g", 2, decoded.data()), std::invalid_argument);
+    EXPECT_THROW(hexDecode("0:", 2, decoded.data()), std::invalid_argument);
+
+    std::mt19937 rng(5);
+    bytes = randomBytes(rng, 700);
+    text.assign(hexEncodedSize(bytes.size()), '\0');
+    hexEncode(bytes.data(), bytes.size(), &text[0]);
+    decoded.assign(bytes.size(), 0);
+    hexDecode(text.data(), text.size(), decoded.data());
+    EXPECT_EQ(decoded, bytes);
+}
+
+TEST(TextCodecTest, StreamingMatchesOneShot) {
+    std::mt19937 rng(11);
+    const std::vector<uint8_t> bytes = randomBytes(rng, 5000);
+    const std::string expected = toBase64url(bytes);
+
+    // Feed both directions in random chunks, including empty ones
+    std::string text;
+    Base64urlEncoder encoder;
+    for (size_t pos = 0; pos < bytes.size();) {
+        const size_t chunk = std::min<size_t>(rng() % 40, bytes.size() - pos);
+        std::vector<char> out(base64urlEncodedSize(chunk + 2));
+        text.append(out.data(), encoder.update(bytes.data() + pos, chunk, out.data()));
+        pos += chunk;
+    }
+    char tail[3];
+    text.append(tail, encoder.finish(tail));
+    EXPECT_EQ(text, expected);
+
+    std::vector<uint8_t> decoded;
+    Base64urlDecoder decoder;
+    for (size_t pos = 0; pos < text.size();) {
+        const size_t chunk = std::min<size_t>(rng() % 40, text.size() - pos);
+        std::vector<uint8_t> out(3 * ((chunk + 3) / 4));
+        const size_t written = decoder.update(text.data() + pos, chunk, out.data());
+        decoded.insert(decoded.end(), out.begin(), out.begin() + written);
+        pos += chunk;
+    }
+    uint8_t last[3];
+    const size_t written = decoder.finish(last);
+    decoded.insert(decoded.end(), last, last + written);
+    EXPECT_EQ(decoded, bytes);
+}
+
+TEST(TextCodecTest, PolynomialsRoundTripAsText) {
+    std::mt19937_64 rng(13);
+    Polynomial p(1024, 12289);
+    for (size_t i = 0; i < p.degree(); i++) {
+        p[i] = rng() % 12289;
+    }
+
+    std::string text = "prefix";
+    appendPolynomialBase64url(p, text);
+    // 14 bits per coefficient
+    EXPECT_EQ(text.size(), 6 + base64urlEncodedSize(1792));
+    Polynomial decoded(1024, 12289);
+    decodePolynomialBase64url(text.data() + 6, text.size() - 6, decoded);
+    EXPECT_EQ(decoded.getCoeffs(), p.getCoeffs());
+
+    std::string hex;
+    appendPolynomialHex(p, hex);
+    EXPECT_EQ(hex.size(), 2 * 1792u);
+    Polynomial from_hex(1024, 12289);
+    decodePolynomialHex(hex.data(), hex.size(), from_hex);
+    EXPECT_EQ(from_hex.getCoeffs(), p.getCoeffs());
+
+    Polynomial smaller(512, 12289);
+    EXPECT_THROW(decodePolynomialBase64url(text.data() + 6, text.size() - 6, smaller), std::invalid_argument);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <token.h>
+#include <rlwe.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct TestProof {
+    KeysetId keyset;
+    uint64_t amount;
+    std::vector<uint8_t> secret;
+    Polynomial signature;
+};
+
+std::vector<uint8_t> writeToken(const std::vector<TestProof>& proofs, const std::string& mint = "https://mint.test",
+                                const std::string& unit = "sat") {
+    std::vector<TokenProof> views;
+    for (const auto& proof : proofs) {
+        views.push_back({proof.keyset, proof.amount, proof.secret.data(), proof.secret.size(), &proof.signature});
+    }
+    std::vector<uint8_t> token = ::writeToken(mint, unit, views);
+    EXPECT_EQ(token.size(), TokenWriter::tokenSize(mint, unit, views));
+    return token;
+}
+
+} // namespace
+
+TEST(TokenTest, RoundTripsProofsAcrossKeysets) {
+    RLWESignature small(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature large(ParameterPreset::RLWE_1024_Q12289);
+    small.generateKeys();
+    large.generateKeys();
+
+    std::vector<TestProof> proofs;
+    for (uint8_t k = 0; k < 40; k++) {
+        RLWESignature& mint = k < 25 ? small : large;
+        std::vector<uint8_t> secret(32, k);
+        proofs.push_back({mint.keysetId(), uint64_t(1) << k, secret,
+                          mint.computeBlindedMessage(secret).first});
+    }
+
+    std::vector<uint8_t> token = writeToken(proofs);
+    TokenReader reader(token.data(), token.size());
+    EXPECT_EQ(reader.mint(), "https://mint.test");
+    EXPECT_EQ(reader.unit(), "sat");
+    EXPECT_EQ(reader.memo(), "");
+
+    ProofView proof;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t k = 0;
+        while (reader.next(proof)) {
+            ASSERT_LT(k, proofs.size());
+            EXPECT_EQ(proof.keyset, proofs[k].keyset);
+            EXPECT_EQ(proof.amount, proofs[k].amount);
+            EXPECT_EQ(proof.secretBytes(), proofs[k].secret);
+            // Views point into the token rather than at copies
+            EXPECT_GE(proof.signature.data, token.data());
+            EXPECT_LT(proof.signature.data, token.data() + token.size());
+            EXPECT_EQ(proof.signature.toPolynomial().getCoeffs(), proofs[k].signature.getCoeffs());
+            k++;
+        }
+        EXPECT_EQ(k, proofs.size());
+        EXPECT_FALSE(reader.next(proof));
+        reader.rewind();
+    }
+}
+
+TEST(TokenTest, ReadsDefiniteLengthsAndSkipsUnknownKeys) {
+    // {"x": [1, 2], "u": "sat", "m": "m", "d": "hi",
+    //  "t": [{"n": 2, "q": 7, "i": h'0102030405060708', "w": {}, "p": [{"c": h'd1', "z": 0, "s": h'aa', "a": 5}]}]}
+    const std::vector<uint8_t> token = {
+        0xa5, 0x61, 'x', 0x82, 0x01, 0x02, 0x61, 'u', 0x63, 's', 'a', 't', 0x61, 'm', 0x61, 'm',
+        0x61, 'd', 0x62, 'h', 'i', 0x61, 't', 0x81, 0xa5, 0x61, 'n', 0x02, 0x61, 'q', 0x07,
+        0x61, 'i', 0x48, 1, 2, 3, 4, 5, 6, 7, 8, 0x61, 'w', 0xa0, 0x61, 'p', 0x81,
+        0xa4, 0x61, 'c', 0x41, 0xd1, 0x61, 'z', 0x00, 0x61, 's', 0x41, 0xaa, 0x61, 'a', 0x05};
+    TokenReader reader(token.data(), token.size());
+    EXPECT_EQ(reader.memo(), "hi");
+
+    ProofView proof;
+    ASSERT_TRUE(reader.next(proof));
+    EXPECT_EQ(proof.amount, 5u);
+    EXPECT_EQ(proof.secretBytes(), std::vector<uint8_t>{0xaa});
+    EXPECT_EQ(proof.keyset, (KeysetId{1, 2, 3, 4, 5, 6, 7, 8}));
+    // 0xd1 = 0b11'010'001: 3-bit coefficients 1 and 2, least significant first
+    EXPECT_EQ(proof.signature.toPolynomial().getCoeffs(), (std::vector<uint64_t>{1, 2}));
+    EXPECT_FALSE(reader.next(proof));
+}
+
+TEST(TokenTest, RejectsMalformedTokens) {
+    std::vector<uint8_t> token = writeToken({{KeysetId{}, 8, {1, 2, 3}, Polynomial(std::vector<uint64_t>{1, 2, 3, 4}, 7)}});
+    for (size_t cut = 0; cut < token.size(); cut++) {
+        EXPECT_THROW(TokenReader(token.data(), cut), std::invalid_argument) << cut;
+    }
+    token.push_back(0);
+    EXPECT_THROW(TokenReader(token.data(), token.size()), std::invalid_argument);
+    token.pop_back();
+
+    // A negative integer where the amount should be
+    std::vector<uint8_t> bad = token;
+    for (size_t i = 0; i + 2 < bad.size(); i++) {
+        if (bad[i] == 0x61 && bad[i + 1] == 'a') {
+            bad[i + 2] = 0x20;
+        }
+    }
+    EXPECT_THROW(TokenReader(bad.data(), bad.size()), std::invalid_argument);
+
+    // Well-formed CBOR whose signature does not fit the keyset's ring
+    bad = token;
+    for (size_t i = 0; i + 2 < bad.size(); i++) {
+        if (bad[i] == 0x61 && bad[i + 1] == 'n') {
+            bad[i + 2] = 0x09;
+        }
+    }
+    TokenReader reader(bad.data(), bad.size());
+    ProofView proof;
+    EXPECT_THROW(reader.next(proof), std::invalid_argument);
+
+    // Deep nesting under an unknown key
+    std::vector<uint8_t> deep = {0xa1, 0x61, 'x'};
+    deep.insert(deep.end(), 40, 0x81);
+    deep.push_back(0x00);
+    EXPECT_THROW(TokenReader(deep.data(), deep.size()), std::invalid_argument);
+}
+
+TEST(TokenTest, WriterChecksCapacityAndRing) {
+    Polynomial signature(std::vector<uint64_t>{1, 2, 3, 4}, 7);
+    std::vector<uint8_t> buffer(TokenWriter::headerSize("m", "u") + TokenWriter::keysetSize(4, 7) +
+                                TokenWriter::proofSize(1, 2, 4, 7) - 1);
+    TokenWriter writer(buffer.data(), buffer.size(), "m", "u");
+    const uint8_t secret[2] = {9, 9};
+    EXPECT_THROW(writer.addProof(1, secret, 2, signature), std::invalid_argument);
+    writer.beginKeyset(KeysetId{}, 4, 7);
+    EXPECT_THROW(writer.addProof(1, secret, 2, Polynomial(4, 11)), std::invalid_argument);
+    writer.addProof(1, secret, 2, signature);
+    EXPECT_THROW(writer.finish(), std::runtime_error);
+}
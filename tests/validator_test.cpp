@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <validator.h>
+#include <module_rlwe.h>
+#include <rlwe.h>
+#include <random>
+#include <vector>
+
+TEST(ValidatorTest, ClassifiesMalformedPolynomials) {
+    const ParameterSet& params = ParameterSet::fromPreset(ParameterPreset::RLWE_256_Q7681);
+    PolynomialValidator validator(params);
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> uniform(256);
+    for (auto& c : uniform) c = rng() % params.q;
+
+    EXPECT_EQ(validator.check(Polynomial(uniform, params.q)), ValidationResult::OK);
+    EXPECT_EQ(validator.check(Polynomial(128, params.q)), ValidationResult::WrongDimension);
+    EXPECT_EQ(validator.check(Polynomial(uniform, 12289)), ValidationResult::WrongModulus);
+
+    auto unreduced = uniform;
+    unreduced[200] = params.q;
+    EXPECT_EQ(validator.check(Polynomial(unreduced, params.q)), ValidationResult::CoefficientOutOfRange);
+
+    EXPECT_EQ(validator.check(Polynomial(256, params.q)), ValidationResult::ImplausibleDistribution);
+    EXPECT_EQ(validator.check(Polynomial(std::vector<uint64_t>(256, params.q - 1), params.q)),
+              ValidationResult::ImplausibleDistribution);
+    EXPECT_EQ(PolynomialValidator(params, false).check(Polynomial(256, params.q)), ValidationResult::OK);
+}
+
+TEST(ValidatorTest, RejectsConstantPolynomialsInSmallRings) {
+    // At n = 8 the moment bounds alone let an all-zero or constant input through
+    const ParameterSet& params = ParameterSet::get(8, 7681);
+    PolynomialValidator validator(params);
+    EXPECT_EQ(validator.check(Polynomial(8, params.q)), ValidationResult::ImplausibleDistribution);
+    EXPECT_EQ(validator.check(Polynomial(std::vector<uint64_t>(8, 3840), params.q)),
+              ValidationResult::ImplausibleDistribution);
+    EXPECT_EQ(validator.check(Polynomial(std::vector<uint64_t>{3840, 3840, 3840, 3840, 3840, 3840, 3840, 3841},
+                                         params.q)),
+              ValidationResult::OK);
+
+    // Where an honest input is constant often enough, only the moments apply
+    const ParameterSet& tiny = ParameterSet::get(8, 17);
+    EXPECT_EQ(PolynomialValidator(tiny).check(Polynomial(std::vector<uint64_t>(8, 8), tiny.q)),
+              ValidationResult::OK);
+}
+
+TEST(ValidatorTest, HonestBlindedMessagesPass) {
+    for (const ParameterSet* params : ParameterSet::presets()) {
+        RLWESignature rlwe(params->n, params->q);
+        rlwe.generateKeys();
+        PolynomialValidator validator(*params);
+        for (int i = 0; i < 50; i++) {
+            std::vector<uint8_t> secret = {static_cast<uint8_t>(i), 0x5a};
+            auto blinded = rlwe.computeBlindedMessage(secret).first;
+            ASSERT_EQ(validator.check(blinded), ValidationResult::OK) << params->name;
+        }
+    }
+}
+
+TEST(ValidatorTest, BlindSignRejectsJunkBeforeSigning) {
+    RLWESignature rlwe(ParameterPreset::RLWE_256_Q7681);
+    rlwe.generateKeys();
+    EXPECT_EQ(rlwe.getValidator().rejections(), 0u);
+
+    EXPECT_THROW(rlwe.blindSign(Polynomial(256, 7681)), std::invalid_argument);
+    EXPECT_THROW(rlwe.blindSign(Polynomial(8, 7681)), std::invalid_argument);
+    EXPECT_THROW(rlwe.blindSignBatch({Polynomial(256, 7681)}), std::invalid_argument);
+    EXPECT_EQ(rlwe.getValidator().rejections(), 3u);
+
+    auto blinded = rlwe.computeBlindedMessage({0x01}).first;
+    EXPECT_NO_THROW(rlwe.blindSign(blinded));
+    EXPECT_EQ(rlwe.getValidator().rejections(), 3u);
+
+    // Signatures from outside the ring are rejected, not indexed past the end
+    EXPECT_FALSE(rlwe.verify({0x01}, Polynomial(512, 7681)));
+
+    ModuleRLWESignature mlwe(2, ParameterPreset::RLWE_256_Q7681);
+    mlwe.generateKeys();
+    auto module_blinded = mlwe.computeBlindedMessage({0x01}).first;
+    module_blinded[1] = Polynomial(256, 7681);
+    EXPECT_THROW(mlwe.blindSign(module_blinded), std::invalid_argument);
+    EXPECT_EQ(mlwe.getValidator().rejections(), 1u);
+}
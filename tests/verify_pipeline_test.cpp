@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <verify_pipeline.h>
+#include <rlwe.h>
+#include <token.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct TestProof {
+    RLWESignature* mint;
+    uint64_t amount;
+    std::vector<uint8_t> secret;
+    Polynomial signature;
+};
+
+TestProof signProof(RLWESignature& mint, uint64_t amount, std::vector<uint8_t> secret) {
+    auto [message, factor] = mint.computeBlindedMessage(secret);
+    Polynomial signature = mint.computeSignature(mint.blindSign(message), factor, mint.getPublicKey().second);
+    return {&mint, amount, std::move(secret), signature};
+}
+
+std::vector<uint8_t> writeToken(const std::vector<TestProof>& proofs) {
+    std::vector<TokenProof> views;
+    for (const auto& proof : proofs) {
+        views.push_back({proof.mint->keysetId(), proof.amount, proof.secret.data(), proof.secret.size(),
+                         &proof.signature});
+    }
+    return ::writeToken("https://mint.test", "sat", views);
+}
+
+// Runs the pipeline over tokens and returns the outcomes by (token, index)
+std::map<std::pair<size_t, uint64_t>, VerifiedProof> runAll(const VerifyPipeline& pipeline,
+                                                            const std::vector<std::vector<uint8_t>>& tokens,
+                                                            PipelineStats* stats = nullptr) {
+    std::vector<const uint8_t*> data;
+    std::vector<size_t> sizes;
+    for (const auto& token : tokens) {
+        data.push_back(token.data());
+        sizes.push_back(token.size());
+    }
+    std::map<std::pair<size_t, uint64_t>, VerifiedProof> results;
+    PipelineStats s = pipeline.run(data.data(), sizes.data(), tokens.size(), [&](const VerifiedProof* proofs, size_t count) {
+        for (size_t k = 0; k < count; k++) {
+            EXPECT_TRUE(results.emplace(std::make_pair(proofs[k].token, proofs[k].index), proofs[k]).second);
+        }
+    });
+    if (stats != nullptr) {
+        *stats = s;
+    }
+    return results;
+}
+
+} // namespace
+
+TEST(VerifyPipelineTest, MatchesSingleVerification) {
+    RLWESignature first(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature second(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature unknown(ParameterPreset::RLWE_256_Q7681);
+    first.generateKeys();
+    second.generateKeys();
+    unknown.generateKeys();
+
+    std::vector<TestProof> proofs;
+    for (uint8_t k = 0; k < 30; k++) {
+        RLWESignature& mint = k < 12 ? first : k < 25 ? second : unknown;
+        proofs.push_back(signProof(mint, k + 1, std::vector<uint8_t>(16, k)));
+    }
+    // Signatures over other secrets
+    proofs[3].signature = signProof(first, 1, {0xff}).signature;
+    proofs[20].signature = signProof(second, 1, {0xfe}).signature;
+    const std::set<std::vector<uint8_t>> spent = {proofs[5].secret, proofs[14].secret, proofs[27].secret};
+
+    std::vector<ProofStatus> expected;
+    for (TestProof& proof : proofs) {
+        if (proof.mint == &unknown) {
+            expected.push_back(ProofStatus::UnknownKeyset);
+        } else if (!proof.mint->verify(proof.secret, proof.signature)) {
+            expected.push_back(ProofStatus::Invalid);
+        } else {
+            expected.push_back(spent.count(proof.secret) ? ProofStatus::Spent : ProofStatus::Valid);
+        }
+    }
+    EXPECT_EQ(expected[3], ProofStatus::Invalid);
+    EXPECT_EQ(expected[20], ProofStatus::Invalid);
+
+    PipelineOptions options;
+    options.batch = 4;
+    options.queue_depth = 2;
+    options.workers = {1, 2, 3, 2, 2};
+    VerifyPipeline pipeline(
+        [&](const KeysetId& id) -> const RLWESignature* {
+            if (id == first.keysetId()) {
+                return &first;
+            }
+            return id == second.keysetId() ? &second : nullptr;
+        },
+        [&](const uint8_t* secret, size_t size) { return spent.count(std::vector<uint8_t>(secret, secret + size)) > 0; },
+        options);
+
+    const std::vector<std::vector<uint8_t>> tokens = {writeToken(proofs)};
+    PipelineStats stats;
+    const auto results = runAll(pipeline, tokens, &stats);
+    ASSERT_EQ(results.size(), proofs.size());
+    for (size_t k = 0; k < proofs.size(); k++) {
+        const VerifiedProof& result = results.at({0, k});
+        EXPECT_EQ(result.status, expected[k]) << "proof " << k;
+        EXPECT_EQ(result.keyset, proofs[k].mint->keysetId());
+        EXPECT_EQ(result.amount, proofs[k].amount);
+        EXPECT_EQ(std::vector<uint8_t>(result.secret, result.secret + result.secret_size), proofs[k].secret);
+    }
+
+    // Keyset runs of 12, 13 and 5 proofs in batches of at most 4
+    EXPECT_EQ(stats.proofs, proofs.size());
+    for (const StageStats& stage : stats.stages) {
+        EXPECT_EQ(stage.proofs, proofs.size());
+        EXPECT_EQ(stage.batches, 3u + 4u + 2u);
+    }
+    EXPECT_EQ(stats.stages[static_cast<size_t>(VerifyStage::Multiply)].workers, 3u);
+    EXPECT_GT(stats.elapsed.count(), 0);
+    EXPECT_LT(static_cast<size_t>(stats.bottleneck()), VERIFY_STAGE_COUNT);
+}
+
+TEST(VerifyPipelineTest, RunsTokensInParallelAndIsReusable) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature other(ParameterPreset::RLWE_512_Q12289);
+    mint.generateKeys();
+    other.generateKeys();
+
+    std::vector<std::vector<uint8_t>> tokens;
+    std::vector<std::vector<bool>> verified;
+    for (uint8_t t = 0; t < 6; t++) {
+        std::vector<TestProof> proofs;
+        verified.emplace_back();
+        for (uint8_t k = 0; k < 5 + t; k++) {
+            proofs.push_back(signProof(mint, 1, {t, k}));
+            verified.back().push_back(mint.verify(proofs.back().secret, proofs.back().signature));
+        }
+        tokens.push_back(writeToken(proofs));
+    }
+    // A keyset whose token ring differs from the key's is rejected
+    std::vector<TestProof> foreign = {signProof(other, 1, {0x01})};
+    tokens.push_back(writeToken(foreign));
+
+    PipelineOptions options;
+    options.workers = {3, 1, 1, 1, 1};
+    VerifyPipeline pipeline(
+        [&](const KeysetId& id) -> const RLWESignature* {
+            return id == mint.keysetId() || id == other.keysetId() ? &mint : nullptr;
+        },
+        {}, options);
+    for (int pass = 0; pass < 2; pass++) {
+        const auto results = runAll(pipeline, tokens);
+        EXPECT_EQ(results.size(), 5u + 6u + 7u + 8u + 9u + 10u + 1u);
+        for (size_t t = 0; t < verified.size(); t++) {
+            for (size_t k = 0; k < verified[t].size(); k++) {
+                EXPECT_EQ(results.at({t, k}).status, verified[t][k] ? ProofStatus::Valid : ProofStatus::Invalid);
+            }
+        }
+        EXPECT_EQ(results.at({6, 0}).status, ProofStatus::Invalid);
+    }
+}
+
+TEST(VerifyPipelineTest, RejectsRingChangeUnderOneKeyset) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    RLWESignature wide(ParameterPreset::RLWE_1024_Q12289);
+    mint.generateKeys();
+    wide.generateKeys();
+
+    // Groups of one keyset ID in two rings, either way round; before the
+    // fix the wider signatures were unpacked into rows sized for n = 256
+    std::vector<TestProof> proofs;
+    for (uint8_t k = 0; k < 9; k++) {
+        proofs.push_back(signProof(k % 6 < 3 ? mint : wide, 1, {k}));
+    }
+    std::vector<TokenProof> views;
+    for (const TestProof& proof : proofs) {
+        views.push_back({mint.keysetId(), proof.amount, proof.secret.data(), proof.secret.size(), &proof.signature});
+    }
+    const std::vector<uint8_t> token = ::writeToken("https://mint.test", "sat", views);
+
+    VerifyPipeline pipeline([&](const KeysetId&) -> const RLWESignature* { return &mint; }, {});
+    const auto results = runAll(pipeline, {token});
+    ASSERT_EQ(results.size(), proofs.size());
+    for (size_t k = 0; k < proofs.size(); k++) {
+        const bool verifies = proofs[k].mint == &mint && mint.verify(proofs[k].secret, proofs[k].signature);
+        EXPECT_EQ(results.at({0, k}).status, verifies ? ProofStatus::Valid : ProofStatus::Invalid) << "proof " << k;
+    }
+}
+
+TEST(VerifyPipelineTest, SurfacesErrors) {
+    RLWESignature mint(ParameterPreset::RLWE_256_Q7681);
+    mint.generateKeys();
+    std::vector<TestProof> proofs;
+    for (uint8_t k = 0; k < 40; k++) {
+        proofs.push_back(signProof(mint, 1, {k}));
+    }
+    std::vector<uint8_t> token = writeToken(proofs);
+    std::vector<uint8_t> truncated(token.begin(), token.end() - 10);
+    auto keys = [&](const KeysetId&) -> const RLWESignature* { return &mint; };
+
+    PipelineOptions options;
+    options.batch = 2;
+    options.queue_depth = 1;
+    VerifyPipeline pipeline(keys, {}, options);
+    EXPECT_THROW(runAll(pipeline, {token, truncated}), std::invalid_argument);
+
+    size_t calls = 0;
+    const uint8_t* data = token.data();
+    const size_t size = token.size();
+    EXPECT_THROW(pipeline.run(&data, &size, 1,
+                              [&](const VerifiedProof*, size_t) {
+                                  if (++calls == 3) {
+                                      throw std::runtime_error("sink failed");
+                                  }
+                              }),
+                 std::runtime_error);
+    EXPECT_EQ(calls, 3u);
+
+    // Still usable after a failed run
+    EXPECT_EQ(runAll(pipeline, {token}).size(), proofs.size());
+
+    options.workers[static_cast<size_t>(VerifyStage::Hash)] = 0;
+    EXPECT_THROW(VerifyPipeline(keys, {}, options), std::invalid_argument);
+    options = PipelineOptions();
+    options.batch = 0;
+    EXPECT_THROW(VerifyPipeline(keys, {}, options), std::invalid_argument);
+}
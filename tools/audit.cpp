@@ -0,0 +1,632 @@
+#include <rlwe.h>
+#include <polynomial_batch.h>
+#include <polynomial_codec.h>
+#include <sha256.h>
+#include <token.h>
+#include <verify_pipeline.h>
+#include <logging.h>
+#include <omp.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// rlwe-audit: re-verifies every outstanding proof against the mint's keys.
+//
+// Proof files are tokens (token.h), mapped rather than read so that files
+// larger than memory stream through the page cache: proofs are taken a
+// window at a time and the pages behind each window are released. Runs of
+// proofs of one keyset in a window are cut into batches, and the batches
+// are verified in parallel with OpenMP. Each batch hashes every secret into
+// one buffer and multiplies it by the secret key with batched NTTs. Valid
+// proofs are then looked up in the spent set, a file of sorted SHA-256
+// digests of spent secrets that is searched in place. The report gives
+// per keyset the proofs, their outstanding amount, and the proofs that
+// failed verification or were already spent.
+//
+// With --stages the proofs go through a VerifyPipeline instead, with the
+// given number of workers per stage, and the report adds the time each
+// stage spent working, waiting for input and waiting for the next stage.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<std::string> keys;    // Key files, or directories of *.key files
+    std::string spent;                // Spent set, if any
+    std::vector<std::string> proofs;  // Token files
+    size_t threads = 0;               // 0: one per core
+    size_t batch = 64;                // Proofs per verification batch
+    size_t window = 65536;            // Proofs read ahead of verification
+    bool list = false;                // Print every failed proof
+    // Workers per pipeline stage; all zero: batches in parallel with OpenMP
+    std::array<size_t, VERIFY_STAGE_COUNT> stages{};
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " --keys PATH[,PATH..] [options] TOKEN_FILE...\n"
+              << "  --keys PATH[,..]  Key files written by saveKeys(), or directories of *.key files\n"
+              << "  --spent FILE      Spent set: ascending 32-byte SHA-256 digests of spent secrets\n"
+              << "  --threads N       Worker threads (default: all cores)\n"
+              << "  --batch N         Proofs per verification batch (default 64)\n"
+              << "  --window N        Proofs read ahead of verification (default 65536)\n"
+              << "  --list            Print every invalid or spent proof\n"
+              << "  --stages P:H:M:C:S\n"
+              << "                    Verify in a pipeline with this many workers for parsing, hashing,\n"
+              << "                    multiplication, comparison and spent checks, and report stage times\n";
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        parts.push_back(item);
+    }
+    return parts;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--keys") {
+            for (const std::string& path : split(next(), ',')) {
+                opts.keys.push_back(path);
+            }
+        } else if (arg == "--spent") {
+            opts.spent = next();
+        } else if (arg == "--threads") {
+            opts.threads = std::stoull(next());
+        } else if (arg == "--batch") {
+            opts.batch = std::stoull(next());
+        } else if (arg == "--window") {
+            opts.window = std::stoull(next());
+        } else if (arg == "--list") {
+            opts.list = true;
+        } else if (arg == "--stages") {
+            const std::vector<std::string> counts = split(next(), ':');
+            if (counts.size() != VERIFY_STAGE_COUNT) {
+                throw std::invalid_argument("--stages takes five worker counts");
+            }
+            for (size_t i = 0; i < VERIFY_STAGE_COUNT; i++) {
+                opts.stages[i] = std::stoull(counts[i]);
+                if (opts.stages[i] == 0) {
+                    throw std::invalid_argument("Every stage needs a worker");
+                }
+            }
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::invalid_argument("Unknown option " + arg);
+        } else {
+            opts.proofs.push_back(arg);
+        }
+    }
+    if (opts.keys.empty() || opts.proofs.empty()) {
+        throw std::invalid_argument("At least one key and one token file are needed");
+    }
+    if (opts.batch == 0 || opts.window < opts.batch) {
+        throw std::invalid_argument("--batch must be positive and no larger than --window");
+    }
+    return opts;
+}
+
+// A whole file mapped read-only. release() hands back the pages before an
+// offset, so one pass over a file larger than memory does not keep it
+// resident.
+class MappedFile {
+public:
+    MappedFile(const std::string& path, int advice) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot stat " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map " + path);
+            }
+            ::madvise(addr, length, advice);
+            bytes = static_cast<uint8_t*>(addr);
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (bytes != nullptr) {
+            ::munmap(bytes, length);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    void release(size_t offset) {
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t end = std::min(offset, length) / page * page;
+        if (end > released) {
+            ::madvise(bytes + released, end - released, MADV_DONTNEED);
+            released = end;
+        }
+    }
+
+private:
+    uint8_t* bytes = nullptr;
+    size_t length = 0;
+    size_t released = 0;
+};
+
+// Spent secrets as ascending SHA-256 digests, binary-searched in the mapping
+class SpentSet {
+public:
+    static constexpr size_t DIGEST = SHA256::hashSize();
+
+    explicit SpentSet(const std::string& path) : file(path, MADV_NORMAL) {
+        if (file.size() % DIGEST != 0) {
+            throw std::runtime_error("Spent set " + path + " is not a list of 32-byte digests");
+        }
+        for (size_t i = 1; i < size(); i++) {
+            if (std::memcmp(at(i - 1), at(i), DIGEST) >= 0) {
+                throw std::runtime_error("Spent set " + path + " is not strictly ascending");
+            }
+        }
+    }
+
+    size_t size() const {
+        return file.size() / DIGEST;
+    }
+
+    // Whether the digest of secret is in the set
+    bool containsSecret(const uint8_t* secret, size_t size) const {
+        uint8_t digest[DIGEST];
+        SHA256::hash(secret, size, digest);
+        return contains(digest);
+    }
+
+    bool contains(const uint8_t* digest) const {
+        size_t lo = 0;
+        size_t hi = size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const int order = std::memcmp(at(mid), digest, DIGEST);
+            if (order == 0) {
+                return true;
+            }
+            if (order < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return false;
+    }
+
+private:
+    MappedFile file;
+
+    const uint8_t* at(size_t i) const {
+        return file.data() + i * DIGEST;
+    }
+};
+
+using Keys = std::map<KeysetId, std::unique_ptr<RLWESignature>>;
+
+Keys loadKeys(const std::vector<std::string>& paths) {
+    std::vector<std::string> files;
+    for (const std::string& path : paths) {
+        if (!std::filesystem::is_directory(path)) {
+            files.push_back(path);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".key") {
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+
+    Keys keys;
+    for (const std::string& file : files) {
+        std::unique_ptr<RLWESignature> key = RLWESignature::fromKeyFile(file);
+        const KeysetId id = key->keysetId();
+        keys.emplace(id, std::move(key));
+    }
+    if (keys.empty()) {
+        throw std::runtime_error("No key files found");
+    }
+    return keys;
+}
+
+struct KeysetTotals {
+    uint64_t proofs = 0;
+    uint64_t valid = 0;
+    uint64_t outstanding = 0;  // Amount of the valid, unspent proofs
+    uint64_t invalid = 0;
+    uint64_t spent = 0;
+    bool has_key = true;
+};
+
+// Proofs of one keyset, [begin, begin + count) of the window
+struct Batch {
+    size_t begin;
+    size_t count;
+};
+
+class Auditor {
+public:
+    Auditor(const Options& opts, const Keys& keys, const SpentSet* spent)
+        : opts(opts), keys(keys), spent(spent) {
+        window.reserve(opts.window);
+        status.resize(opts.window);
+    }
+
+    // Verifies every proof of one token file; throws std::invalid_argument
+    // if the file is not a well-formed token
+    void audit(const std::string& path) {
+        MappedFile file(path, MADV_SEQUENTIAL);
+        // Checks the structure in one sequential pass before any proof is
+        // verified, so a damaged file is rejected as a whole
+        TokenReader reader(file.data(), file.size());
+        ProofView proof;
+        file_index = 0;
+        while (true) {
+            window.clear();
+            while (window.size() < opts.window && reader.next(proof)) {
+                window.push_back(proof);
+            }
+            if (window.empty()) {
+                break;
+            }
+            verifyWindow();
+            tally(path);
+            const ProofView& last = window.back();
+            file.release(static_cast<size_t>(last.signature.data - file.data()) +
+                         packedSize(last.signature.n, last.signature.q));
+        }
+    }
+
+    // Verifies every file in one VerifyPipeline run, with the workers of
+    // opts.stages; the files stay mapped until the run ends. Throws
+    // std::invalid_argument if a file is not a well-formed token.
+    void auditPipelined(const std::vector<std::string>& paths) {
+        std::vector<std::unique_ptr<MappedFile>> files;
+        std::vector<const uint8_t*> data;
+        std::vector<size_t> sizes;
+        for (const std::string& path : paths) {
+            files.push_back(std::make_unique<MappedFile>(path, MADV_SEQUENTIAL));
+            data.push_back(files.back()->data());
+            sizes.push_back(files.back()->size());
+        }
+
+        PipelineOptions options;
+        options.batch = opts.batch;
+        options.workers = opts.stages;
+        VerifyPipeline::SpentCheck check;
+        if (spent != nullptr) {
+            check = [this](const uint8_t* secret, size_t size) { return spent->containsSecret(secret, size); };
+        }
+        VerifyPipeline pipeline(
+            [this](const KeysetId& id) -> const RLWESignature* {
+                auto it = keys.find(id);
+                return it == keys.end() ? nullptr : it->second.get();
+            },
+            check, options);
+        stage_stats = pipeline.run(data.data(), sizes.data(), files.size(),
+                                   [&](const VerifiedProof* proofs, size_t count) {
+                                       for (size_t k = 0; k < count; k++) {
+                                           this->count(paths[proofs[k].token], proofs[k]);
+                                       }
+                                   });
+    }
+
+    // Of the last auditPipelined() call
+    const PipelineStats& stageStats() const {
+        return stage_stats;
+    }
+
+    const std::map<KeysetId, KeysetTotals>& totals() const {
+        return by_keyset;
+    }
+
+    uint64_t proofs() const {
+        return proof_count;
+    }
+
+    uint64_t findings() const {
+        return finding_count;
+    }
+
+private:
+    const Options& opts;
+    const Keys& keys;
+    const SpentSet* spent;
+    std::vector<ProofView> window;
+    std::vector<ProofStatus> status;
+    std::vector<Batch> batches;
+    std::map<KeysetId, KeysetTotals> by_keyset;
+    uint64_t proof_count = 0;
+    uint64_t finding_count = 0;
+    uint64_t file_index = 0;  // Of the next proof in the current file
+    PipelineStats stage_stats;
+
+    void verifyWindow() {
+        // Proofs of a keyset are contiguous in a token, so batches are runs.
+        // A token may reuse a keyset ID with another ring, so a run also
+        // ends where the ring changes and every batch has a single ring.
+        batches.clear();
+        for (size_t k = 0; k < window.size(); k++) {
+            if (k == 0 || window[k].keyset != window[k - 1].keyset ||
+                window[k].signature.n != window[k - 1].signature.n ||
+                window[k].signature.q != window[k - 1].signature.q || batches.back().count == opts.batch) {
+                batches.push_back({k, 0});
+            }
+            batches.back().count++;
+        }
+
+        std::exception_ptr error;
+        #pragma omp parallel
+        {
+            std::vector<const uint8_t*> secrets;
+            std::vector<size_t> sizes;
+            std::unique_ptr<bool[]> unpacked(new bool[opts.batch]);
+            std::unique_ptr<bool[]> verified(new bool[opts.batch]);
+            std::unique_ptr<PolynomialBatch> signatures;
+
+            #pragma omp for schedule(dynamic)
+            for (size_t b = 0; b < batches.size(); b++) {
+                const Batch& batch = batches[b];
+                const ProofView& first = window[batch.begin];
+                auto key = keys.find(first.keyset);
+                if (key == keys.end()) {
+                    std::fill_n(status.begin() + static_cast<ptrdiff_t>(batch.begin), batch.count, ProofStatus::UnknownKeyset);
+                    continue;
+                }
+                // Signatures outside the key's ring cannot verify under it and
+                // are not unpacked
+                const size_t n = key->second->degree();
+                const uint64_t q = key->second->getModulus();
+                if (first.signature.n != n || first.signature.q != q) {
+                    std::fill_n(status.begin() + static_cast<ptrdiff_t>(batch.begin), batch.count, ProofStatus::Invalid);
+                    continue;
+                }
+                if (!signatures || signatures->degree() != n || signatures->getModulus() != q) {
+                    signatures = std::make_unique<PolynomialBatch>(0, n, q);
+                }
+                signatures->resize(batch.count);
+                secrets.clear();
+                sizes.clear();
+                for (size_t k = 0; k < batch.count; k++) {
+                    const ProofView& p = window[batch.begin + k];
+                    secrets.push_back(p.secret);
+                    sizes.push_back(p.secret_size);
+                    try {
+                        unpackCoefficients(p.signature.data, n, q, signatures->row(k));
+                        unpacked[k] = true;
+                    } catch (const std::invalid_argument&) {
+                        unpacked[k] = false;  // A coefficient not below q
+                    }
+                }
+                try {
+                    key->second->verifyBatch(secrets.data(), sizes.data(), *signatures, verified.get());
+                } catch (...) {
+                    #pragma omp critical
+                    error = std::current_exception();
+                    continue;
+                }
+
+                for (size_t k = 0; k < batch.count; k++) {
+                    ProofStatus& s = status[batch.begin + k];
+                    if (!unpacked[k] || !verified[k]) {
+                        s = ProofStatus::Invalid;
+                    } else if (spent != nullptr && spent->containsSecret(secrets[k], sizes[k])) {
+                        s = ProofStatus::Spent;
+                    } else {
+                        s = ProofStatus::Valid;
+                    }
+                }
+            }
+        }
+        // Exceptions cannot leave a parallel region, so the last one is
+        // carried out of it
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void tally(const std::string& path) {
+        for (size_t k = 0; k < window.size(); k++) {
+            VerifiedProof proof;
+            proof.index = file_index++;
+            proof.keyset = window[k].keyset;
+            proof.amount = window[k].amount;
+            proof.secret = window[k].secret;
+            proof.secret_size = window[k].secret_size;
+            proof.status = status[k];
+            count(path, proof);
+        }
+    }
+
+    void count(const std::string& path, const VerifiedProof& proof) {
+        KeysetTotals& totals = by_keyset[proof.keyset];
+        totals.proofs++;
+        switch (proof.status) {
+        case ProofStatus::Valid:
+            totals.valid++;
+            if (__builtin_add_overflow(totals.outstanding, proof.amount, &totals.outstanding)) {
+                throw std::runtime_error("Outstanding amount of keyset " + keysetIdToHex(proof.keyset) +
+                                         " overflows 64 bits");
+            }
+            break;
+        case ProofStatus::Invalid:
+            totals.invalid++;
+            break;
+        case ProofStatus::Spent:
+            totals.spent++;
+            break;
+        case ProofStatus::UnknownKeyset:
+            totals.has_key = false;
+            break;
+        }
+        if (proof.status != ProofStatus::Valid) {
+            finding_count++;
+            if (opts.list) {
+                listProof(path, proof);
+            }
+        }
+        proof_count++;
+    }
+
+    static void listProof(const std::string& path, const VerifiedProof& proof) {
+        static const char* const NAMES[] = {"valid", "invalid", "spent", "no key"};
+        std::ostringstream secret;
+        for (size_t i = 0; i < proof.secret_size; i++) {
+            secret << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(proof.secret[i]);
+        }
+        std::cout << path << " #" << proof.index << ": " << NAMES[static_cast<int>(proof.status)] << ", keyset "
+                  << keysetIdToHex(proof.keyset) << ", amount " << proof.amount << ", secret " << secret.str()
+                  << "\n";
+    }
+};
+
+void report(std::ostream& out, const Auditor& auditor, double elapsed_s, size_t threads) {
+    out << std::left << std::setw(18) << "keyset" << std::right << std::setw(12) << "proofs" << std::setw(12)
+        << "valid" << std::setw(22) << "outstanding" << std::setw(10) << "invalid" << std::setw(10) << "spent"
+        << "\n";
+    KeysetTotals sum;
+    for (const auto& [id, totals] : auditor.totals()) {
+        out << std::left << std::setw(18) << keysetIdToHex(id) << std::right << std::setw(12) << totals.proofs;
+        if (totals.has_key) {
+            out << std::setw(12) << totals.valid << std::setw(22) << totals.outstanding << std::setw(10)
+                << totals.invalid << std::setw(10) << totals.spent << "\n";
+        } else {
+            out << "  no key loaded\n";
+        }
+        sum.proofs += totals.proofs;
+        sum.valid += totals.valid;
+        sum.invalid += totals.invalid;
+        sum.spent += totals.spent;
+    }
+    out << std::left << std::setw(18) << "total" << std::right << std::setw(12) << sum.proofs << std::setw(12)
+        << sum.valid << std::setw(22) << "" << std::setw(10) << sum.invalid << std::setw(10) << sum.spent << "\n";
+    out << "Audited " << auditor.proofs() << " proofs in " << std::fixed << std::setprecision(2) << elapsed_s
+        << " s (" << std::setprecision(0) << (elapsed_s > 0 ? auditor.proofs() / elapsed_s : 0.0)
+        << " proofs/s, " << threads << " threads), " << auditor.findings() << " findings\n";
+}
+
+// Where a pipelined run spent its time. A stage's capacity is the rate
+// its workers would sustain if they never waited; the lowest one bounds
+// the run.
+void reportStages(std::ostream& out, const PipelineStats& stats) {
+    auto ms = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1e6; };
+    out << "\n" << std::left << std::setw(14) << "stage" << std::right << std::setw(9) << "workers" << std::setw(10)
+        << "batches" << std::setw(12) << "busy ms" << std::setw(12) << "starved ms" << std::setw(12) << "blocked ms"
+        << std::setw(14) << "capacity/s" << "\n";
+    for (size_t i = 0; i < VERIFY_STAGE_COUNT; i++) {
+        const StageStats& stage = stats.stages[i];
+        const double busy_s = ms(stage.busy) / 1e3 / static_cast<double>(stage.workers);
+        out << std::left << std::setw(14) << verifyStageName(static_cast<VerifyStage>(i)) << std::right
+            << std::setw(9) << stage.workers << std::setw(10) << stage.batches << std::setprecision(1)
+            << std::setw(12) << ms(stage.busy) << std::setw(12) << ms(stage.starved) << std::setw(12)
+            << ms(stage.blocked) << std::setprecision(0) << std::setw(14)
+            << (busy_s > 0 ? static_cast<double>(stage.proofs) / busy_s : 0.0) << "\n";
+    }
+    out << "Bottleneck: " << verifyStageName(stats.bottleneck()) << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        opts = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    Logger::enable_logging = false;
+    if (opts.threads > 0) {
+        omp_set_num_threads(static_cast<int>(opts.threads));
+    }
+
+    try {
+        const Keys keys = loadKeys(opts.keys);
+        std::unique_ptr<SpentSet> spent;
+        if (!opts.spent.empty()) {
+            spent = std::make_unique<SpentSet>(opts.spent);
+        }
+        std::cerr << "Loaded " << keys.size() << " keysets" << (spent ? " and " : "")
+                  << (spent ? std::to_string(spent->size()) + " spent secrets" : std::string()) << std::endl;
+
+        Auditor auditor(opts, keys, spent.get());
+        const bool pipelined = opts.stages[0] > 0;
+        const auto start = Clock::now();
+        if (pipelined) {
+            auditor.auditPipelined(opts.proofs);
+        } else {
+            for (const std::string& path : opts.proofs) {
+                auditor.audit(path);
+            }
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        size_t threads = static_cast<size_t>(omp_get_max_threads());
+        if (pipelined) {
+            threads = 0;
+            for (size_t workers : opts.stages) {
+                threads += workers;
+            }
+        }
+        report(std::cout, auditor, elapsed, threads);
+        if (pipelined) {
+            reportStages(std::cout, auditor.stageStats());
+        }
+        return auditor.findings() == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 2;
+    }
+}
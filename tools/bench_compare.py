@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Store benchmark results as named baselines and compare new runs against them.
+
+Results are the JSON files written by rlwe_bench (``--out``). Google Benchmark
+JSON output (``--benchmark_out``) is accepted as well; its per-repetition
+iteration entries are grouped by name.
+
+Usage:
+    bench_compare.py save NAME RESULTS.json [--dir DIR] [--force]
+    bench_compare.py compare NAME RESULTS.json [--dir DIR] [--threshold PCT] [--sigma K]
+    bench_compare.py list [--dir DIR]
+
+A benchmark is reported as a regression when its median time grew by more than
+--threshold percent AND the growth exceeds --sigma times the combined noise
+estimate of both runs (MAD scaled to a standard deviation). ``compare`` exits
+with status 1 if any benchmark regressed and 0 otherwise.
+"""
+
+import argparse
+import json
+import math
+import os
+import shutil
+import statistics
+import sys
+
+DEFAULT_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir, "bench", "baselines")
+
+# Scale factor turning a median absolute deviation into a consistent
+# estimator of the standard deviation for normally distributed samples
+MAD_TO_SIGMA = 1.4826
+
+
+def load_samples(path):
+    """Return a dict mapping benchmark name to its list of per-repetition times (ns)."""
+    with open(path) as f:
+        data = json.load(f)
+
+    samples = {}
+    for bench in data.get("benchmarks", []):
+        if "samples" in bench:
+            samples[bench["name"]] = [float(x) for x in bench["samples"]]
+        elif bench.get("run_type", "iteration") == "iteration":
+            # Google Benchmark: one entry per repetition, times in time_unit
+            scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[bench.get("time_unit", "ns")]
+            name = bench.get("run_name", bench["name"])
+            samples.setdefault(name, []).append(float(bench["real_time"]) * scale)
+    if not samples:
+        raise ValueError("no benchmark samples found in " + path)
+    return samples
+
+
+def median_mad(values):
+    med = statistics.median(values)
+    mad = statistics.median(abs(v - med) for v in values)
+    return med, mad
+
+
+def baseline_path(directory, name):
+    if not name or os.sep in name or name.startswith("."):
+        raise ValueError("invalid baseline name: " + repr(name))
+    return os.path.join(directory, name + ".json")
+
+
+def cmd_save(args):
+    load_samples(args.results)  # refuse to store files we cannot read back
+    os.makedirs(args.dir, exist_ok=True)
+    dest = baseline_path(args.dir, args.name)
+    if os.path.exists(dest) and not args.force:
+        print("baseline '%s' already exists (use --force to overwrite)" % args.name, file=sys.stderr)
+        return 2
+    shutil.copyfile(args.results, dest)
+    print("saved baseline '%s' to %s" % (args.name, os.path.normpath(dest)))
+    return 0
+
+
+def cmd_list(args):
+    if not os.path.isdir(args.dir):
+        return 0
+    for entry in sorted(os.listdir(args.dir)):
+        if entry.endswith(".json"):
+            print(entry[:-len(".json")])
+    return 0
+
+
+def cmd_compare(args):
+    path = baseline_path(args.dir, args.name)
+    if not os.path.exists(path):
+        print("baseline '%s' not found in %s" % (args.name, os.path.normpath(args.dir)), file=sys.stderr)
+        return 2
+    base = load_samples(path)
+    new = load_samples(args.results)
+
+    regressions = 0
+    print("%-40s %14s %14s %9s  %s" % ("benchmark", "baseline(ns)", "current(ns)", "change", "verdict"))
+    for name in sorted(set(base) | set(new)):
+        if name not in new:
+            print("%-40s %14s %14s %9s  %s" % (name, "", "", "", "missing in current run"))
+            continue
+        if name not in base:
+            print("%-40s %14s %14s %9s  %s" % (name, "", "", "", "new benchmark"))
+            continue
+
+        base_med, base_mad = median_mad(base[name])
+        new_med, new_mad = median_mad(new[name])
+        delta = new_med - base_med
+        change = delta / base_med if base_med > 0 else 0.0
+        noise = MAD_TO_SIGMA * math.sqrt(base_mad ** 2 + new_mad ** 2)
+
+        significant = abs(delta) > args.sigma * noise
+        if change * 100.0 > args.threshold and significant:
+            verdict = "REGRESSION"
+            regressions += 1
+        elif -change * 100.0 > args.threshold and significant:
+            verdict = "improvement"
+        else:
+            verdict = "ok"
+        if min(len(base[name]), len(new[name])) < 3 and verdict != "ok":
+            verdict += " (fewer than 3 repetitions, noise estimate unreliable)"
+
+        print("%-40s %14.1f %14.1f %+8.1f%%  %s" % (name, base_med, new_med, change * 100.0, verdict))
+
+    if regressions:
+        print("\n%d significant regression(s) against baseline '%s'" % (regressions, args.name))
+        return 1
+    return 0
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def add_dir(p):
+        p.add_argument("--dir", default=DEFAULT_DIR,
+                       help="baseline directory (default: bench/baselines in the repository)")
+
+    p = sub.add_parser("save", help="store a results file as a named baseline")
+    p.add_argument("name")
+    p.add_argument("results")
+    p.add_argument("--force", action="store_true", help="overwrite an existing baseline")
+    add_dir(p)
+    p.set_defaults(func=cmd_save)
+
+    p = sub.add_parser("compare", help="compare a results file against a named baseline")
+    p.add_argument("name")
+    p.add_argument("results")
+    p.add_argument("--threshold", type=float, default=5.0,
+                   help="minimum median slowdown in percent to flag (default 5)")
+    p.add_argument("--sigma", type=float, default=3.0,
+                   help="required multiple of the combined noise estimate (default 3)")
+    add_dir(p)
+    p.set_defaults(func=cmd_compare)
+
+    p = sub.add_parser("list", help="list stored baselines")
+    add_dir(p)
+    p.set_defaults(func=cmd_list)
+
+    args = parser.parse_args(argv)
+    try:
+        return args.func(args)
+    except (OSError, ValueError, KeyError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,884 @@
+#include <rlwe.h>
+#include <params.h>
+#include <polynomial.h>
+#include <logging.h>
+#include <polynomial_codec.h>
+#include <response_cache.h>
+#include <sha256.h>
+#include <token.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// rlwe-loadgen: simulates a population of wallets talking to a mint.
+//
+// Requests (mint, swap, melt) arrive according to an open-loop arrival
+// process and are served by a pool of workers. Each request does its
+// client-side work (blinding outputs, picking input proofs), calls the
+// mint target, then unblinds and stores the returned signatures in the
+// wallet. The report gives throughput, latency percentiles and error
+// rates per request type.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class RequestType { Mint, Swap, Melt };
+
+const char* typeName(RequestType type) {
+    switch (type) {
+        case RequestType::Mint: return "mint";
+        case RequestType::Swap: return "swap";
+        case RequestType::Melt: return "melt";
+    }
+    return "?";
+}
+
+struct Options {
+    size_t n = 256;
+    uint64_t q = 7681;
+    size_t wallets = 100;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    double rate = 200.0;                 // Mean arrivals per second
+    double duration_s = 10.0;
+    std::string arrival = "poisson";     // poisson | bursty | uniform
+    size_t burst_size = 20;              // Requests per burst (bursty)
+    double mix[3] = {1.0, 3.0, 1.0};     // mint:swap:melt weights
+    std::string amounts = "lognormal:3:1.5";
+    size_t min_proofs = 1;               // Input proofs per swap/melt
+    size_t max_proofs = 8;
+    size_t denomination_bits = 12;       // Denominations 1, 2, ..., 2^(bits-1)
+    double invalid_rate = 0.0;           // Fraction of requests carrying a forged proof
+    double retry_rate = 0.0;             // Fraction of requests resent as after a timeout
+    double cache_ttl_s = 60.0;           // Lifetime of cached responses
+    size_t cache_mb = 64;                // Response cache budget, 0 disables it
+    uint64_t seed = 1;
+    std::string export_dir;              // Where to write keys, proofs and spent set, if set
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [options]\n"
+              << "  --params N:Q          Ring parameters (default 256:7681)\n"
+              << "  --wallets N           Simulated wallets (default 100)\n"
+              << "  --threads N           Mint worker threads (default: hardware threads)\n"
+              << "  --rate R              Mean arrival rate in requests/s (default 200)\n"
+              << "  --duration S          Length of the run in seconds (default 10)\n"
+              << "  --arrival KIND        poisson | bursty | uniform (default poisson)\n"
+              << "  --burst-size N        Requests per burst for bursty arrivals (default 20)\n"
+              << "  --mix M:S:L           Relative weights of mint:swap:melt (default 1:3:1)\n"
+              << "  --amounts DIST        fixed:V | uniform:LO:HI | lognormal:MU:SIGMA (default lognormal:3:1.5)\n"
+              << "  --proofs MIN:MAX      Input proofs per swap/melt (default 1:8)\n"
+              << "  --denominations BITS  Keys for amounts 1..2^(BITS-1) (default 12)\n"
+              << "  --invalid-rate P      Fraction of requests with a forged input proof (default 0)\n"
+              << "  --retry-rate P        Fraction of requests resent with the same request ID (default 0)\n"
+              << "  --cache-ttl S         Lifetime of cached responses in seconds (default 60)\n"
+              << "  --cache-mb MB         Response cache budget, 0 to disable (default 64)\n"
+              << "  --seed S              Seed for the load shape (default 1)\n"
+              << "  --export DIR          After the run, write the keys, wallet proofs and spent set\n"
+              << "                        to DIR in the form rlwe-audit reads\n";
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        parts.push_back(item);
+    }
+    return parts;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--params") {
+            auto parts = split(next(), ':');
+            if (parts.size() != 2) throw std::invalid_argument("--params expects N:Q");
+            opts.n = std::stoull(parts[0]);
+            opts.q = std::stoull(parts[1]);
+        } else if (arg == "--wallets") {
+            opts.wallets = std::stoull(next());
+        } else if (arg == "--threads") {
+            opts.threads = std::stoull(next());
+        } else if (arg == "--rate") {
+            opts.rate = std::stod(next());
+        } else if (arg == "--duration") {
+            opts.duration_s = std::stod(next());
+        } else if (arg == "--arrival") {
+            opts.arrival = next();
+            if (opts.arrival != "poisson" && opts.arrival != "bursty" && opts.arrival != "uniform") {
+                throw std::invalid_argument("Unknown arrival process " + opts.arrival);
+            }
+        } else if (arg == "--burst-size") {
+            opts.burst_size = std::stoull(next());
+        } else if (arg == "--mix") {
+            auto parts = split(next(), ':');
+            if (parts.size() != 3) throw std::invalid_argument("--mix expects M:S:L");
+            for (size_t k = 0; k < 3; k++) opts.mix[k] = std::stod(parts[k]);
+        } else if (arg == "--amounts") {
+            opts.amounts = next();
+        } else if (arg == "--proofs") {
+            auto parts = split(next(), ':');
+            if (parts.size() != 2) throw std::invalid_argument("--proofs expects MIN:MAX");
+            opts.min_proofs = std::stoull(parts[0]);
+            opts.max_proofs = std::stoull(parts[1]);
+        } else if (arg == "--denominations") {
+            opts.denomination_bits = std::stoull(next());
+        } else if (arg == "--invalid-rate") {
+            opts.invalid_rate = std::stod(next());
+        } else if (arg == "--retry-rate") {
+            opts.retry_rate = std::stod(next());
+        } else if (arg == "--cache-ttl") {
+            opts.cache_ttl_s = std::stod(next());
+        } else if (arg == "--cache-mb") {
+            opts.cache_mb = std::stoull(next());
+        } else if (arg == "--seed") {
+            opts.seed = std::stoull(next());
+        } else if (arg == "--export") {
+            opts.export_dir = next();
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (opts.threads == 0 || opts.wallets == 0 || opts.rate <= 0 || opts.burst_size == 0) {
+        throw std::invalid_argument("--threads, --wallets, --rate and --burst-size must be positive");
+    }
+    if (opts.min_proofs == 0 || opts.min_proofs > opts.max_proofs) {
+        throw std::invalid_argument("--proofs requires 1 <= MIN <= MAX");
+    }
+    if (opts.cache_mb > 0 && opts.cache_ttl_s <= 0) {
+        throw std::invalid_argument("--cache-ttl must be positive");
+    }
+    if (opts.denomination_bits == 0 || opts.denomination_bits > 32) {
+        throw std::invalid_argument("--denominations must be between 1 and 32");
+    }
+    return opts;
+}
+
+// Draws payment amounts from the configured distribution
+class AmountDistribution {
+public:
+    explicit AmountDistribution(const std::string& spec) {
+        auto parts = split(spec, ':');
+        kind = parts.empty() ? "" : parts[0];
+        if (kind == "fixed" && parts.size() == 2) {
+            p1 = std::stod(parts[1]);
+        } else if ((kind == "uniform" || kind == "lognormal") && parts.size() == 3) {
+            p1 = std::stod(parts[1]);
+            p2 = std::stod(parts[2]);
+        } else {
+            throw std::invalid_argument("Invalid amount distribution " + spec);
+        }
+    }
+
+    uint64_t sample(std::mt19937_64& rng) const {
+        double value = p1;
+        if (kind == "uniform") {
+            value = std::uniform_real_distribution<double>(p1, p2)(rng);
+        } else if (kind == "lognormal") {
+            value = std::lognormal_distribution<double>(p1, p2)(rng);
+        }
+        return std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(value)));
+    }
+
+private:
+    std::string kind;
+    double p1 = 0.0;
+    double p2 = 0.0;
+};
+
+// Cashu-style split of an amount into power-of-two denominations
+std::vector<uint64_t> splitAmount(uint64_t amount, size_t denomination_bits) {
+    std::vector<uint64_t> parts;
+    const uint64_t largest = uint64_t(1) << (denomination_bits - 1);
+    while (amount >= largest) {
+        parts.push_back(largest);
+        amount -= largest;
+    }
+    for (size_t bit = 0; bit + 1 < denomination_bits; bit++) {
+        if (amount & (uint64_t(1) << bit)) {
+            parts.push_back(uint64_t(1) << bit);
+        }
+    }
+    return parts;
+}
+
+struct Proof {
+    uint64_t amount;
+    std::vector<uint8_t> secret;
+    Polynomial signature;
+};
+
+struct BlindedOutput {
+    uint64_t amount;
+    Polynomial blinded;
+};
+
+enum class MintStatus { Ok, InvalidProof, DoubleSpend, Conflict, Error };
+
+struct MintResponse {
+    MintStatus status = MintStatus::Ok;
+    std::vector<Polynomial> signatures;
+};
+
+// Interface to the mint being driven. The in-process implementation calls
+// the library directly; other targets only need to implement these calls.
+// A wallet resending a request after a timeout reuses its request ID.
+class MintTarget {
+public:
+    virtual ~MintTarget() = default;
+    virtual MintResponse mint(const std::string& request_id, const std::vector<BlindedOutput>& outputs) = 0;
+    virtual MintResponse swap(const std::string& request_id, const std::vector<Proof>& inputs,
+                              const std::vector<BlindedOutput>& outputs) = 0;
+    virtual MintResponse melt(const std::string& request_id, const std::vector<Proof>& inputs,
+                              const std::vector<BlindedOutput>& change) = 0;
+};
+
+// A keyset with one RLWE key per denomination, the way Cashu mints key amounts
+class Keyset {
+public:
+    Keyset(size_t n, uint64_t q, size_t denomination_bits) {
+        for (size_t bit = 0; bit < denomination_bits; bit++) {
+            auto key = std::make_unique<RLWESignature>(n, q);
+            key->generateKeys();
+            keys.emplace(uint64_t(1) << bit, std::move(key));
+        }
+    }
+
+    RLWESignature& forAmount(uint64_t amount) const {
+        auto it = keys.find(amount);
+        if (it == keys.end()) {
+            throw std::invalid_argument("No key for amount " + std::to_string(amount));
+        }
+        return *it->second;
+    }
+
+    // One key file per denomination, named after its amount
+    void save(const std::string& dir) const {
+        for (const auto& [amount, key] : keys) {
+            key->saveKeys(dir + "/" + std::to_string(amount) + ".key");
+        }
+    }
+
+private:
+    std::map<uint64_t, std::unique_ptr<RLWESignature>> keys;
+};
+
+// Successful responses are cached by request ID together with a digest of
+// the request body, so a retry is answered before any proof is verified or
+// output signed, a retry racing the first attempt waits for it, and a reused
+// ID with a different body is refused
+class InProcessMint : public MintTarget {
+public:
+    InProcessMint(const Keyset& keyset, const Options& opts) : keyset(keyset) {
+        if (opts.cache_mb > 0) {
+            auto ttl = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::duration<double>(opts.cache_ttl_s));
+            cache = std::make_unique<ResponseCache>(opts.cache_mb << 20, std::max(ttl, std::chrono::milliseconds(1)));
+        }
+    }
+
+    MintResponse mint(const std::string& request_id, const std::vector<BlindedOutput>& outputs) override {
+        return idempotent(request_id, digestRequest('m', {}, outputs), [&]() {
+            return signOutputs(outputs);
+        });
+    }
+
+    MintResponse swap(const std::string& request_id, const std::vector<Proof>& inputs,
+                      const std::vector<BlindedOutput>& outputs) override {
+        return idempotent(request_id, digestRequest('s', inputs, outputs), [&]() {
+            MintResponse response;
+            response.status = spendInputs(inputs);
+            return response.status == MintStatus::Ok ? signOutputs(outputs) : response;
+        });
+    }
+
+    MintResponse melt(const std::string& request_id, const std::vector<Proof>& inputs,
+                      const std::vector<BlindedOutput>& change) override {
+        return swap(request_id, inputs, change);
+    }
+
+    const ResponseCache* responseCache() const {
+        return cache.get();
+    }
+
+    // Writes the spent set as ascending SHA-256 digests of the secrets and
+    // returns their number
+    size_t exportSpent(const std::string& path) {
+        std::vector<std::array<uint8_t, SHA256::hashSize()>> digests;
+        {
+            std::lock_guard<std::mutex> lock(spent_mutex);
+            digests.resize(spent.size());
+            size_t k = 0;
+            for (const auto& secret : spent) {
+                SHA256::hash(secret.data(), secret.size(), digests[k++].data());
+            }
+        }
+        std::sort(digests.begin(), digests.end());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        for (const auto& digest : digests) {
+            out.write(reinterpret_cast<const char*>(digest.data()), static_cast<std::streamsize>(digest.size()));
+        }
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Cannot write " + path);
+        }
+        return digests.size();
+    }
+
+private:
+    // Canonical request body: kind, then amount, secret and packed signature
+    // of each input, then amount and packed blinded message of each output
+    static RequestDigest digestRequest(char kind, const std::vector<Proof>& inputs,
+                                       const std::vector<BlindedOutput>& outputs) {
+        std::vector<uint8_t> body{static_cast<uint8_t>(kind)};
+        auto put = [&body](uint64_t value) {
+            for (int i = 0; i < 8; i++) body.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        };
+        auto putPolynomial = [&](const Polynomial& p) {
+            put(p.degree());
+            put(p.getModulus());
+            packCoefficients(p, body);
+        };
+        put(inputs.size());
+        for (const auto& proof : inputs) {
+            put(proof.amount);
+            put(proof.secret.size());
+            body.insert(body.end(), proof.secret.begin(), proof.secret.end());
+            putPolynomial(proof.signature);
+        }
+        put(outputs.size());
+        for (const auto& output : outputs) {
+            put(output.amount);
+            putPolynomial(output.blinded);
+        }
+        RequestDigest digest;
+        SHA256::hash(body.data(), body.size(), digest.data());
+        return digest;
+    }
+
+    template<typename Run>
+    MintResponse idempotent(const std::string& request_id, const RequestDigest& request, Run run) {
+        if (!cache) {
+            return run();
+        }
+        CacheLookup found = cache->begin(request_id, request);
+        if (found.status == CacheStatus::Hit) {
+            MintResponse response;
+            response.signatures = decodePolynomials(found.response.data(), found.response.size());
+            return response;
+        }
+        if (found.status == CacheStatus::Conflict) {
+            MintResponse response;
+            response.status = MintStatus::Conflict;
+            return response;
+        }
+
+        // A failed or throwing request releases the claim on the way out
+        MintResponse response = run();
+        if (response.status == MintStatus::Ok) {
+            found.claim.store(encodePolynomials(response.signatures));
+        }
+        return response;
+    }
+
+    MintStatus spendInputs(const std::vector<Proof>& inputs) {
+        for (const auto& proof : inputs) {
+            if (!keyset.forAmount(proof.amount).verify(proof.secret, proof.signature)) {
+                return MintStatus::InvalidProof;
+            }
+        }
+        std::lock_guard<std::mutex> lock(spent_mutex);
+        for (const auto& proof : inputs) {
+            if (spent.count(proof.secret)) {
+                return MintStatus::DoubleSpend;
+            }
+        }
+        for (const auto& proof : inputs) {
+            spent.insert(proof.secret);
+        }
+        return MintStatus::Ok;
+    }
+
+    MintResponse signOutputs(const std::vector<BlindedOutput>& outputs) {
+        MintResponse response;
+        response.signatures.reserve(outputs.size());
+        for (const auto& output : outputs) {
+            response.signatures.push_back(keyset.forAmount(output.amount).blindSign(output.blinded));
+        }
+        return response;
+    }
+
+    struct SecretHash {
+        size_t operator()(const std::vector<uint8_t>& v) const {
+            return std::hash<std::string>()(std::string(v.begin(), v.end()));
+        }
+    };
+
+    const Keyset& keyset;
+    std::mutex spent_mutex;
+    std::unordered_set<std::vector<uint8_t>, SecretHash> spent;
+    std::unique_ptr<ResponseCache> cache;
+};
+
+struct Wallet {
+    std::mutex mutex;
+    std::vector<Proof> proofs;
+    uint64_t next_secret = 0;
+    uint64_t next_request = 0;
+    size_t id = 0;
+};
+
+struct Request {
+    RequestType type;
+    Clock::time_point arrival;
+    uint64_t seed;
+};
+
+// Per-type counters and latency samples, kept per worker and merged at the end
+struct TypeStats {
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t proofs_in = 0;
+    uint64_t outputs = 0;
+    uint64_t downgraded = 0;          // swap/melt served as mint for lack of proofs
+    uint64_t retries = 0;
+    uint64_t retry_mismatches = 0;    // Retries answered differently from the first attempt
+    std::map<MintStatus, uint64_t> by_status;
+    std::vector<double> service_us;   // Mint call only
+    std::vector<double> sojourn_us;   // Arrival to completion, including queueing and client work
+    std::vector<double> retry_us;     // Mint call of a resent request
+
+    void merge(const TypeStats& other) {
+        completed += other.completed;
+        errors += other.errors;
+        proofs_in += other.proofs_in;
+        outputs += other.outputs;
+        downgraded += other.downgraded;
+        retries += other.retries;
+        retry_mismatches += other.retry_mismatches;
+        for (const auto& [status, count] : other.by_status) by_status[status] += count;
+        service_us.insert(service_us.end(), other.service_us.begin(), other.service_us.end());
+        sojourn_us.insert(sojourn_us.end(), other.sojourn_us.begin(), other.sojourn_us.end());
+        retry_us.insert(retry_us.end(), other.retry_us.begin(), other.retry_us.end());
+    }
+};
+
+class LoadGenerator {
+public:
+    LoadGenerator(const Options& opts, const Keyset& keyset, MintTarget& target)
+        : opts(opts), keyset(keyset), target(target), amounts(opts.amounts), wallets(opts.wallets) {
+        for (size_t i = 0; i < wallets.size(); i++) {
+            wallets[i].id = i;
+        }
+    }
+
+    // Give every wallet an initial balance so swaps and melts have inputs
+    void fund(size_t proofs_per_wallet) {
+        std::mt19937_64 rng(opts.seed ^ 0x5eed);
+        for (auto& wallet : wallets) {
+            while (wallet.proofs.size() < proofs_per_wallet) {
+                TypeStats ignored;
+                runMint(wallet, amounts.sample(rng), rng, ignored);
+            }
+        }
+    }
+
+    std::vector<Request> schedule(Clock::time_point start) const {
+        std::mt19937_64 rng(opts.seed);
+        std::discrete_distribution<int> mix(std::begin(opts.mix), std::end(opts.mix));
+        std::exponential_distribution<double> gap(opts.rate);
+        std::exponential_distribution<double> burst_gap(opts.rate / opts.burst_size);
+
+        std::vector<Request> requests;
+        double t = 0.0;
+        while (true) {
+            if (opts.arrival == "poisson") {
+                t += gap(rng);
+            } else if (opts.arrival == "uniform") {
+                t += 1.0 / opts.rate;
+            } else if (requests.size() % opts.burst_size == 0) {
+                // Bursty: bursts of back-to-back requests separated by
+                // exponential idle gaps, preserving the mean rate
+                t += burst_gap(rng);
+            }
+            if (t >= opts.duration_s) {
+                break;
+            }
+            auto offset = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t));
+            requests.push_back({static_cast<RequestType>(mix(rng)), start + offset, rng()});
+        }
+        return requests;
+    }
+
+    void run(const std::vector<Request>& requests) {
+        std::vector<TypeStats> worker_stats(opts.threads * 3);
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < opts.threads; w++) {
+            workers.emplace_back([this, w, &worker_stats]() {
+                Request request;
+                while (pop(request)) {
+                    serve(request, worker_stats[w * 3 + static_cast<int>(request.type)]);
+                }
+            });
+        }
+
+        // Open-loop dispatch: requests are released at their arrival time
+        // regardless of how many are still being served
+        for (const auto& request : requests) {
+            std::this_thread::sleep_until(request.arrival);
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                queue.push_back(request);
+                max_queue_depth = std::max(max_queue_depth, queue.size());
+            }
+            queue_cv.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            done = true;
+        }
+        queue_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (size_t w = 0; w < opts.threads; w++) {
+            for (int type = 0; type < 3; type++) {
+                stats[type].merge(worker_stats[w * 3 + type]);
+            }
+        }
+    }
+
+    void report(std::ostream& os, double elapsed_s) const {
+        TypeStats total;
+        for (const auto& s : stats) total.merge(s);
+
+        os << "Completed " << total.completed << " requests in " << std::fixed << std::setprecision(2)
+           << elapsed_s << " s: " << total.completed / elapsed_s << " req/s, "
+           << (total.proofs_in / elapsed_s) << " proofs verified/s, "
+           << (total.outputs / elapsed_s) << " outputs signed/s\n";
+        os << "Max dispatch queue depth: " << max_queue_depth << "\n\n";
+
+        os << std::left << std::setw(7) << "type" << std::right
+           << std::setw(9) << "count" << std::setw(9) << "err%"
+           << std::setw(11) << "p50(ms)" << std::setw(11) << "p90(ms)"
+           << std::setw(11) << "p99(ms)" << std::setw(11) << "p99.9(ms)"
+           << std::setw(11) << "max(ms)" << std::setw(13) << "sojourn p99" << "\n";
+        for (int type = 0; type < 3; type++) {
+            printRow(os, typeName(static_cast<RequestType>(type)), stats[type]);
+        }
+        printRow(os, "all", total);
+
+        os << "\nErrors: invalid proof " << count(total, MintStatus::InvalidProof)
+           << ", double spend " << count(total, MintStatus::DoubleSpend)
+           << ", request ID reused " << count(total, MintStatus::Conflict)
+           << ", other " << count(total, MintStatus::Error) << "\n";
+        if (total.downgraded > 0) {
+            os << "Swaps/melts served as mints for lack of wallet balance: " << total.downgraded << "\n";
+        }
+        if (total.retries > 0) {
+            os << "Retries: " << total.retries << ", answered differently " << total.retry_mismatches
+               << ", p50 " << std::setprecision(3) << percentile(total.retry_us, 0.50) / 1000
+               << " ms vs " << percentile(total.service_us, 0.50) / 1000 << " ms first attempt\n";
+        }
+    }
+
+    // Writes every proof the wallets hold as one token, grouped by keyset,
+    // and returns their number
+    size_t exportProofs(const std::string& path) const {
+        std::vector<const Proof*> proofs;
+        for (const auto& wallet : wallets) {
+            for (const auto& proof : wallet.proofs) {
+                proofs.push_back(&proof);
+            }
+        }
+        std::stable_sort(proofs.begin(), proofs.end(),
+                         [](const Proof* x, const Proof* y) { return x->amount < y->amount; });
+
+        std::vector<TokenProof> views;
+        views.reserve(proofs.size());
+        for (const Proof* proof : proofs) {
+            views.push_back({keyset.forAmount(proof->amount).keysetId(), proof->amount, proof->secret.data(),
+                             proof->secret.size(), &proof->signature});
+        }
+        const std::vector<uint8_t> token = writeToken("rlwe-loadgen", "sat", views);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(token.data()), static_cast<std::streamsize>(token.size()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Cannot write " + path);
+        }
+        return proofs.size();
+    }
+
+private:
+    bool pop(Request& request) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [this]() { return done || !queue.empty(); });
+        if (queue.empty()) {
+            return false;
+        }
+        request = queue.front();
+        queue.pop_front();
+        return true;
+    }
+
+    static uint64_t count(const TypeStats& s, MintStatus status) {
+        auto it = s.by_status.find(status);
+        return it == s.by_status.end() ? 0 : it->second;
+    }
+
+    static double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + idx, values.end());
+        return values[idx];
+    }
+
+    static void printRow(std::ostream& os, const char* name, const TypeStats& s) {
+        double err = s.completed ? 100.0 * s.errors / s.completed : 0.0;
+        os << std::left << std::setw(7) << name << std::right << std::fixed
+           << std::setw(9) << s.completed << std::setw(9) << std::setprecision(2) << err
+           << std::setprecision(3)
+           << std::setw(11) << percentile(s.service_us, 0.50) / 1000
+           << std::setw(11) << percentile(s.service_us, 0.90) / 1000
+           << std::setw(11) << percentile(s.service_us, 0.99) / 1000
+           << std::setw(11) << percentile(s.service_us, 0.999) / 1000
+           << std::setw(11) << percentile(s.service_us, 1.0) / 1000
+           << std::setw(13) << percentile(s.sojourn_us, 0.99) / 1000 << "\n";
+    }
+
+    std::vector<BlindedOutput> blindOutputs(Wallet& wallet, const std::vector<uint64_t>& parts,
+                                            std::vector<std::vector<uint8_t>>& secrets,
+                                            std::vector<Polynomial>& factors) {
+        std::vector<BlindedOutput> outputs;
+        for (uint64_t amount : parts) {
+            std::stringstream ss;
+            ss << "wallet-" << wallet.id << "-" << wallet.next_secret++;
+            std::string text = ss.str();
+            secrets.emplace_back(text.begin(), text.end());
+            auto [blinded, factor] = keyset.forAmount(amount).computeBlindedMessage(secrets.back());
+            outputs.push_back({amount, blinded});
+            factors.push_back(factor);
+        }
+        return outputs;
+    }
+
+    void storeSignatures(Wallet& wallet, const std::vector<BlindedOutput>& outputs,
+                         const std::vector<std::vector<uint8_t>>& secrets,
+                         const std::vector<Polynomial>& factors, const MintResponse& response) {
+        for (size_t i = 0; i < response.signatures.size(); i++) {
+            RLWESignature& key = keyset.forAmount(outputs[i].amount);
+            Polynomial signature = key.computeSignature(response.signatures[i], factors[i],
+                                                        key.getPublicKey().second);
+            wallet.proofs.push_back({outputs[i].amount, secrets[i], signature});
+        }
+    }
+
+    // Calls the mint and, for a --retry-rate fraction of requests, sends
+    // the same request again as a wallet would after losing the response
+    template<typename Call>
+    MintResponse callMint(Wallet& wallet, Call call, std::mt19937_64& rng, TypeStats& s) {
+        const std::string request_id = "wallet-" + std::to_string(wallet.id) + "-request-" +
+                                       std::to_string(wallet.next_request++);
+        auto t0 = Clock::now();
+        MintResponse response = call(request_id);
+        s.service_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+
+        if (opts.retry_rate > 0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < opts.retry_rate) {
+            auto t1 = Clock::now();
+            MintResponse retried = call(request_id);
+            s.retry_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t1).count());
+            s.retries++;
+            s.retry_mismatches += !sameResponse(response, retried);
+            response = std::move(retried);
+        }
+        return response;
+    }
+
+    static bool sameResponse(const MintResponse& a, const MintResponse& b) {
+        if (a.status != b.status || a.signatures.size() != b.signatures.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.signatures.size(); i++) {
+            if (a.signatures[i].getCoeffs() != b.signatures[i].getCoeffs()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MintResponse runMint(Wallet& wallet, uint64_t amount, std::mt19937_64& rng, TypeStats& s) {
+        std::vector<std::vector<uint8_t>> secrets;
+        std::vector<Polynomial> factors;
+        auto outputs = blindOutputs(wallet, splitAmount(amount, opts.denomination_bits), secrets, factors);
+
+        MintResponse response = callMint(wallet, [this, &outputs](const std::string& id) {
+            return target.mint(id, outputs);
+        }, rng, s);
+        s.outputs += outputs.size();
+
+        storeSignatures(wallet, outputs, secrets, factors, response);
+        return response;
+    }
+
+    void serve(const Request& request, TypeStats& s) {
+        std::mt19937_64 rng(request.seed);
+        Wallet& wallet = wallets[rng() % wallets.size()];
+        std::lock_guard<std::mutex> lock(wallet.mutex);
+
+        MintResponse response;
+        try {
+            const size_t wanted = opts.min_proofs + rng() % (opts.max_proofs - opts.min_proofs + 1);
+            if (request.type == RequestType::Mint || wallet.proofs.size() < wanted) {
+                s.downgraded += request.type != RequestType::Mint;
+                response = runMint(wallet, amounts.sample(rng), rng, s);
+            } else {
+                response = runSpend(wallet, request.type, wanted, rng, s);
+            }
+        } catch (const std::exception&) {
+            response.status = MintStatus::Error;
+        }
+
+        s.completed++;
+        s.by_status[response.status]++;
+        s.errors += response.status != MintStatus::Ok;
+        s.sojourn_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - request.arrival).count());
+    }
+
+    MintResponse runSpend(Wallet& wallet, RequestType type, size_t wanted, std::mt19937_64& rng, TypeStats& s) {
+        // Take random input proofs out of the wallet
+        std::shuffle(wallet.proofs.begin(), wallet.proofs.end(), rng);
+        std::vector<Proof> inputs(wallet.proofs.end() - wanted, wallet.proofs.end());
+        wallet.proofs.erase(wallet.proofs.end() - wanted, wallet.proofs.end());
+
+        uint64_t total = 0;
+        for (const auto& proof : inputs) total += proof.amount;
+
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(rng) < opts.invalid_rate) {
+            inputs[0].signature = Polynomial(opts.n, opts.q);  // forged
+        }
+
+        // A swap re-issues the full input amount; a melt pays a random part
+        // of it out and gets the remainder back as change
+        uint64_t keep = total;
+        if (type == RequestType::Melt) {
+            keep = total - std::min<uint64_t>(total, amounts.sample(rng));
+        }
+
+        std::vector<std::vector<uint8_t>> secrets;
+        std::vector<Polynomial> factors;
+        auto outputs = blindOutputs(wallet, splitAmount(keep, opts.denomination_bits), secrets, factors);
+
+        MintResponse response = callMint(wallet, [this, type, &inputs, &outputs](const std::string& id) {
+            return type == RequestType::Swap ? target.swap(id, inputs, outputs) : target.melt(id, inputs, outputs);
+        }, rng, s);
+        s.proofs_in += inputs.size();
+        s.outputs += outputs.size();
+
+        if (response.status == MintStatus::Ok) {
+            storeSignatures(wallet, outputs, secrets, factors, response);
+        } else if (response.status == MintStatus::InvalidProof) {
+            // Keep the genuine proofs; only the forged one is dropped
+            wallet.proofs.insert(wallet.proofs.end(), inputs.begin() + 1, inputs.end());
+        }
+        return response;
+    }
+
+    const Options& opts;
+    const Keyset& keyset;
+    MintTarget& target;
+    AmountDistribution amounts;
+    std::vector<Wallet> wallets;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Request> queue;
+    size_t max_queue_depth = 0;
+    bool done = false;
+
+    TypeStats stats[3];
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        opts = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    Logger::enable_logging = false;
+
+    try {
+        std::cerr << "Generating keyset (" << opts.denomination_bits << " keys, n=" << opts.n
+                  << ", q=" << opts.q << ")..." << std::endl;
+        Keyset keyset(opts.n, opts.q, opts.denomination_bits);
+        InProcessMint mint(keyset, opts);
+        LoadGenerator generator(opts, keyset, mint);
+
+        std::cerr << "Funding " << opts.wallets << " wallets..." << std::endl;
+        generator.fund(opts.max_proofs);
+
+        auto start = Clock::now();
+        auto requests = generator.schedule(start);
+        std::cerr << "Running " << requests.size() << " " << opts.arrival << " arrivals over "
+                  << opts.duration_s << " s with " << opts.threads << " workers..." << std::endl;
+        generator.run(requests);
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        generator.report(std::cout, elapsed);
+        if (const ResponseCache* cache = mint.responseCache()) {
+            std::cout << "Response cache: " << cache->hits() << " hits, " << cache->size() << " entries, "
+                      << cache->bytes() / 1024 << " KiB, " << cache->evictions() << " evictions, "
+                      << cache->conflicts() << " conflicts\n";
+        }
+        if (!opts.export_dir.empty()) {
+            std::filesystem::create_directories(opts.export_dir);
+            keyset.save(opts.export_dir);
+            const size_t proofs = generator.exportProofs(opts.export_dir + "/proofs.token");
+            const size_t spent = mint.exportSpent(opts.export_dir + "/spent.bin");
+            std::cerr << "Exported " << proofs << " wallet proofs and " << spent << " spent secrets to "
+                      << opts.export_dir << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <rlwe.h>
+#include <params.h>
+#include <polynomial.h>
+#include <logging.h>
+#include <omp.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// rlwe-montecarlo: estimates verification failure rates per parameter set.
+//
+// Every round runs the full protocol (blind, blind-sign, unblind, verify)
+// and additionally verifies the signature against a secret that differs in
+// one bit. Honest failures happen when the noise e1 - r*e pushes a
+// coefficient across the polySignal boundary; wrong-secret accepts should
+// never happen. Rounds are spread over all cores with OpenMP, each thread
+// owning its own keys, which are regenerated every --rounds-per-key rounds.
+
+namespace {
+
+struct ParamSpec {
+    size_t n;
+    uint64_t q;
+    double sigma;
+};
+
+struct Options {
+    std::vector<ParamSpec> params;
+    uint64_t rounds = 1000000;
+    uint64_t rounds_per_key = 100;
+    size_t secret_bytes = 16;
+    double target = 0.0;          // Acceptable honest failure rate, 0 to disable
+    double confidence = 0.95;
+    uint64_t seed = 1;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [options]\n"
+              << "  --params N:Q[:SIGMA][,..]  Parameter sets (default: all presets)\n"
+              << "  --rounds N                 Protocol rounds per parameter set (default 1000000)\n"
+              << "  --rounds-per-key N         Rounds before a thread regenerates its keys (default 100)\n"
+              << "  --threads N                Worker threads (default: all cores)\n"
+              << "  --confidence C             Confidence level of the intervals (default 0.95)\n"
+              << "  --target RATE              Flag parameter sets whose honest failure rate is\n"
+              << "                             not provably below RATE at the given confidence\n"
+              << "  --seed S                   Seed for the secrets being signed (default 1)\n";
+}
+
+std::vector<ParamSpec> parseParams(const std::string& spec) {
+    std::vector<ParamSpec> params;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        std::vector<std::string> parts;
+        std::stringstream is(item);
+        std::string part;
+        while (std::getline(is, part, ':')) parts.push_back(part);
+        if (parts.size() != 2 && parts.size() != 3) {
+            throw std::invalid_argument("Parameter set must be N:Q or N:Q:SIGMA, got '" + item + "'");
+        }
+        params.push_back({std::stoull(parts[0]), std::stoull(parts[1]),
+                          parts.size() == 3 ? std::stod(parts[2]) : ParameterSet::GAUSSIAN_STDDEV});
+    }
+    return params;
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        if (arg == "--params") {
+            opts.params = parseParams(next());
+        } else if (arg == "--rounds") {
+            opts.rounds = std::stoull(next());
+        } else if (arg == "--rounds-per-key") {
+            opts.rounds_per_key = std::stoull(next());
+        } else if (arg == "--threads") {
+            omp_set_num_threads(std::stoi(next()));
+        } else if (arg == "--confidence") {
+            opts.confidence = std::stod(next());
+        } else if (arg == "--target") {
+            opts.target = std::stod(next());
+        } else if (arg == "--seed") {
+            opts.seed = std::stoull(next());
+        } else if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Unknown option " + arg);
+        }
+    }
+    if (opts.params.empty()) {
+        for (const ParameterSet* preset : ParameterSet::presets()) {
+            opts.params.push_back({preset->n, preset->q, preset->sigma});
+        }
+    }
+    if (opts.rounds == 0 || opts.rounds_per_key == 0) {
+        throw std::invalid_argument("--rounds and --rounds-per-key must be positive");
+    }
+    if (!(opts.confidence > 0.0 && opts.confidence < 1.0)) {
+        throw std::invalid_argument("--confidence must be in (0, 1)");
+    }
+    return opts;
+}
+
+// Two-sided standard normal quantile for the given confidence level
+// (Acklam's rational approximation of the inverse normal CDF)
+double normalQuantile(double confidence) {
+    const double p = 1.0 - (1.0 - confidence) / 2.0;
+    const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                        1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                        6.680131188771972e+01, -1.328068155288572e+01};
+    const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                        -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                        3.754408661907416e+00};
+    if (p > 0.97575) {
+        double t = std::sqrt(-2 * std::log(1 - p));
+        return -(((((c[0] * t + c[1]) * t + c[2]) * t + c[3]) * t + c[4]) * t + c[5]) /
+               ((((d[0] * t + d[1]) * t + d[2]) * t + d[3]) * t + 1);
+    }
+    double t = p - 0.5;
+    double r = t * t;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * t /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// Wilson score interval for k successes out of n trials. Unlike the normal
+// approximation it stays meaningful when k is 0 or very small.
+std::pair<double, double> wilsonInterval(uint64_t k, uint64_t n, double z) {
+    const double nn = static_cast<double>(n);
+    const double p = k / nn;
+    const double denom = 1 + z * z / nn;
+    const double center = (p + z * z / (2 * nn)) / denom;
+    const double half = z * std::sqrt(p * (1 - p) / nn + z * z / (4 * nn * nn)) / denom;
+    return {k == 0 ? 0.0 : std::max(0.0, center - half), k == n ? 1.0 : std::min(1.0, center + half)};
+}
+
+struct Counts {
+    uint64_t rounds = 0;
+    uint64_t honest_failures = 0;
+    uint64_t wrong_accepts = 0;
+    uint64_t errors = 0;
+};
+
+Counts simulate(const ParamSpec& spec, const Options& opts) {
+    Counts total;
+    uint64_t honest_failures = 0, wrong_accepts = 0, errors = 0;
+    const int64_t blocks = static_cast<int64_t>((opts.rounds + opts.rounds_per_key - 1) / opts.rounds_per_key);
+
+    #pragma omp parallel reduction(+ : honest_failures, wrong_accepts, errors)
+    {
+        RLWESignature rlwe(spec.n, spec.q, spec.sigma);
+
+        // One block of rounds shares a key
+        #pragma omp for schedule(dynamic, 1)
+        for (int64_t block = 0; block < blocks; block++) {
+            std::mt19937_64 rng(opts.seed ^ (static_cast<uint64_t>(block) * 0x9e3779b97f4a7c15ULL));
+            const uint64_t first = static_cast<uint64_t>(block) * opts.rounds_per_key;
+            const uint64_t count = std::min(opts.rounds_per_key, opts.rounds - first);
+            try {
+                rlwe.generateKeys();
+                const Polynomial b = rlwe.getPublicKey().second;
+                std::vector<uint8_t> secret(opts.secret_bytes);
+                for (uint64_t round = 0; round < count; round++) {
+                    for (auto& byte : secret) byte = static_cast<uint8_t>(rng());
+
+                    auto [blinded, factor] = rlwe.computeBlindedMessage(secret);
+                    Polynomial signature = rlwe.computeSignature(rlwe.blindSign(blinded), factor, b);
+                    honest_failures += !rlwe.verify(secret, signature);
+
+                    secret[rng() % secret.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+                    wrong_accepts += rlwe.verify(secret, signature);
+                }
+            } catch (const std::exception&) {
+                errors += count;
+            }
+        }
+    }
+
+    total.rounds = opts.rounds;
+    total.honest_failures = honest_failures;
+    total.wrong_accepts = wrong_accepts;
+    total.errors = errors;
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    try {
+        opts = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 2;
+    }
+
+    Logger::enable_logging = false;
+    const double z = normalQuantile(opts.confidence);
+    const int ci_pct = static_cast<int>(std::lround(opts.confidence * 100));
+
+    std::cout << std::left << std::setw(22) << "params" << std::right
+              << std::setw(11) << "rounds" << std::setw(12) << "us/round"
+              << std::setw(10) << "fail" << std::setw(32) << ("fail rate [" + std::to_string(ci_pct) + "% CI]")
+              << std::setw(9) << "accept" << std::setw(32) << ("accept rate [" + std::to_string(ci_pct) + "% CI]")
+              << (opts.target > 0 ? "  target" : "") << "\n";
+
+    bool all_ok = true;
+    for (const auto& spec : opts.params) {
+        std::stringstream name;
+        name << spec.n << ":" << spec.q << ":" << spec.sigma;
+
+        Counts counts;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            counts = simulate(spec, opts);
+        } catch (const std::exception& e) {
+            std::cerr << "Error for " << name.str() << ": " << e.what() << "\n";
+            all_ok = false;
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // Per-round time is wall time times threads, i.e. single-core cost
+        double us_per_round = seconds * 1e6 * omp_get_max_threads() / counts.rounds;
+
+        const uint64_t valid = counts.rounds - counts.errors;
+        auto fail_ci = wilsonInterval(counts.honest_failures, valid, z);
+        auto accept_ci = wilsonInterval(counts.wrong_accepts, valid, z);
+
+        auto rate = [](uint64_t k, uint64_t n, std::pair<double, double> ci) {
+            std::stringstream ss;
+            ss << std::scientific << std::setprecision(1) << (n ? double(k) / n : 0.0)
+               << " [" << ci.first << "," << ci.second << "]";
+            return ss.str();
+        };
+
+        std::cout << std::left << std::setw(22) << name.str() << std::right
+                  << std::setw(11) << counts.rounds << std::setw(12) << std::fixed << std::setprecision(1)
+                  << us_per_round << std::setw(10) << counts.honest_failures
+                  << std::setw(32) << rate(counts.honest_failures, valid, fail_ci)
+                  << std::setw(9) << counts.wrong_accepts
+                  << std::setw(32) << rate(counts.wrong_accepts, valid, accept_ci);
+        if (opts.target > 0) {
+            bool meets = fail_ci.second <= opts.target && counts.wrong_accepts == 0;
+            all_ok = all_ok && meets;
+            std::cout << (meets ? "  meets" : "  MISSES");
+        }
+        std::cout << "\n";
+        if (counts.errors > 0) {
+            std::cerr << counts.errors << " rounds of " << name.str() << " failed with an exception\n";
+            all_ok = false;
+        }
+    }
+    return all_ok ? 0 : 1;
+}